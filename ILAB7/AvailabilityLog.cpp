@@ -0,0 +1,326 @@
+#include "AvailabilityLog.h"
+#include "Util.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Forces data written into @file onto the disk. Returns false on failure */
+static bool syncFile(FILE* file) {
+	if (fflush(file) != 0)
+		return false;
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+/* Cuts @file back to its first @size bytes and moves to its end. Returns false on failure */
+static bool truncateFile(FILE* file, const long long size) {
+	fflush(file);
+#ifdef _WIN32
+	if (_chsize_s(_fileno(file), size) != 0)
+		return false;
+#else
+	if (ftruncate(fileno(file), (off_t)size) != 0)
+		return false;
+#endif
+	return fseek(file, 0, SEEK_END) == 0;
+}
+
+/* Replaces file @path by file @temporary in a single step, so a crash leaves one of them
+   at @path. Returns false on failure */
+static bool replaceFile(const String& temporary, const String& path) {
+#ifdef _WIN32
+	// rename doesn't replace existing files on Windows, removing the old one first isn't atomic
+	return MoveFileExA(temporary.get(), path.get(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(temporary.get(), path.get()) == 0;
+#endif
+}
+
+/* Parses decimal sequence number at @text which must be followed directly by @end into @value.
+   Returns false if there are no digits or something else follows them */
+static bool parseSequence(const char* text, const char end, long long& value) {
+	if (*text < '0' || *text > '9')
+		return false;
+	char* rest;
+	errno = 0;
+	value = std::strtoll(text, &rest, 10);
+	return errno == 0 && *rest == end;
+}
+
+/* Forces the entries of @directory (e.g. a file renamed into it) onto the disk. Returns false on
+   failure. Windows has no directory handles to sync, renames are journaled by NTFS there */
+static bool syncDirectory(const String& directory) {
+#ifdef _WIN32
+	return true;
+#else
+	int handle = ::open(directory.getLength() != 0 ? directory.get() : ".", O_RDONLY);
+	if (handle < 0)
+		return false;
+	bool isSynced = fsync(handle) == 0;
+	close(handle);
+	return isSynced;
+#endif
+}
+
+/* Instantiates a log of availability of @books kept in @directory.
+   @books must not be reordered or resized while the log is open */
+AvailabilityLog::AvailabilityLog(ResizableArray<Book>& books, const String& directory, const int groupSize, const int snapshotInterval)
+	: books(books), directory(directory), rows(books.getSize()), keys(books.getSize()) {
+	log = nullptr;
+	pendingCount = 0;
+	this->groupSize = groupSize > 0 ? groupSize : 1;
+	this->snapshotInterval = snapshotInterval;
+	sinceSnapshot = 0;
+	sequence = 0;
+	commits = 0;
+	isFailed = false;
+	for (int i = 0; i < books.getSize(); ++i) {
+		const Book& book = books[i];
+		String prefix = book.getAuthor() + '\t' + book.getTitle() + '\t' + String(std::to_string(book.getPublicationYear()).c_str()) + '\t';
+		// Books sharing author, title and year are numbered in catalog order
+		int occurrence = 0;
+		String key;
+		do {
+			key = prefix + String(std::to_string(occurrence++).c_str());
+		} while (rows.contains(key));
+		rows[key] = i;
+		keys.add(key);
+	}
+}
+
+/* Destructor commits pending changes and closes the log */
+AvailabilityLog::~AvailabilityLog() {
+	if (log != nullptr) {
+		commit();
+		fclose(log);
+	}
+}
+
+/* Returns row of the book with @author, @title and @year (its @occurrence-th copy) or -1 */
+int AvailabilityLog::findRow(const String& author, const String& title, const int year, const int occurrence) const {
+	String key = author + '\t' + title + '\t' + String(std::to_string(year).c_str()) + '\t' + String(std::to_string(occurrence).c_str());
+	const int* row = rows.find(key);
+	return row != nullptr ? *row : -1;
+}
+
+/* Recovers availability from the snapshot and log in the directory and opens the log
+   for appending. Returns the amount of changes applied or -1 if the log can't be opened
+   or a line before the end of the snapshot or log is malformed (both are left untouched) */
+int AvailabilityLog::open() {
+	int applied = 0, ignored = 0;
+	bool isTorn = false;
+	if (!replay(AVAILABILITY_SNAPSHOT_FILE, true, 0, ignored, isTorn) || isTorn)
+		return -1;
+	long long snapshotSequence = sequence;
+	if (!replay(AVAILABILITY_LOG_FILE, false, snapshotSequence, applied, isTorn))
+		return -1;
+
+	String path = Util::joinPath(directory, AVAILABILITY_LOG_FILE);
+	log = fopen(path.get(), "ab");
+	if (log == nullptr)
+		return -1;
+	sinceSnapshot = (int)(sequence - snapshotSequence);
+	// A torn tail can't stay in front of new records, the snapshot starts a clean log
+	if (isTorn && !snapshot())
+		return -1;
+	return applied;
+}
+
+/* Reads file @name applying its lines. Sets @isTorn if the last line has no line break (it was
+   torn by a crash and is ignored). Returns false if a line before it is malformed */
+bool AvailabilityLog::replay(const char* name, const bool isSnapshot, const long long after, int& applied, bool& isTorn) {
+	String path = Util::joinPath(directory, name);
+	std::ifstream fin(path.get(), std::ios::binary);
+	if (!fin.is_open())
+		return true;
+	std::string line;
+	long long previous = 0;
+	while (std::getline(fin, line)) {
+		if (fin.eof()) {
+			isTorn = true;
+			return true;
+		}
+		long long lineSequence = 0;
+		bool isValid = true;
+		if (isSnapshot && !line.empty() && line[0] == '#') {
+			if (parseSequence(line.c_str() + 1, '\0', lineSequence)) {
+				sequence = lineSequence;
+				continue;
+			}
+			isValid = false;
+		}
+		else if (!isSnapshot) {
+			// Sequences only grow, a record going back can't be told from a damaged one
+			isValid = parseSequence(line.c_str(), '\t', lineSequence) && lineSequence > previous;
+			previous = lineSequence;
+			if (isValid && lineSequence <= after)
+				continue; // Already covered by the snapshot
+		}
+		if (!isValid || !apply(line, isSnapshot, lineSequence)) {
+			std::cerr << "Malformed line in availability " << (isSnapshot ? "snapshot " : "log ") << path << ": " << line << std::endl;
+			return false;
+		}
+		++applied;
+	}
+	return true;
+}
+
+/* Applies a single encoded change (or snapshot line if @isSnapshot) to the catalog.
+   Returns false if @line is malformed */
+bool AvailabilityLog::apply(const std::string& line, const bool isSnapshot, long long& lineSequence) {
+	size_t start = 0;
+	if (!isSnapshot) {
+		start = line.find('\t');
+		if (start == std::string::npos)
+			return false;
+		++start;
+	}
+	size_t end = line.find('\t', start);
+	if (end == std::string::npos || end == start)
+		return false;
+	char op = isSnapshot ? '=' : line[start];
+	if (op != '+' && op != '-' && op != '=')
+		return false;
+	unsigned int amount = (unsigned int)std::strtoul(line.c_str() + start + (isSnapshot ? 0 : 1), nullptr, 10);
+	const int* row = rows.find(String(line.c_str() + end + 1));
+	if (!isSnapshot)
+		sequence = lineSequence;
+	if (row == nullptr)
+		return true; // The book is no longer in the catalog
+	Book& book = books[*row];
+	if (op == '=')
+		book = amount;
+	else if (op == '+')
+		book.setCurrentAmount(book.getCurrentAmount() + amount);
+	else book.setCurrentAmount(book.getCurrentAmount() - amount);
+	return true;
+}
+
+/* Adds @amount available copies to the book at @row */
+void AvailabilityLog::increment(const int row, const unsigned int amount) {
+	Book& book = books[row];
+	if (amount == 1)
+		++book;
+	else book.setCurrentAmount(book.getCurrentAmount() + amount);
+	append(row, '+', amount);
+}
+
+/* Takes @amount copies of the book at @row. Returns false (changing nothing) if there are fewer available */
+bool AvailabilityLog::decrement(const int row, const unsigned int amount) {
+	Book& book = books[row];
+	if ((unsigned int)book.getCurrentAmount() < amount)
+		return false;
+	if (amount == 1)
+		--book;
+	else book.setCurrentAmount(book.getCurrentAmount() - amount);
+	append(row, '-', amount);
+	return true;
+}
+
+/* Sets available copies of the book at @row to @amount */
+void AvailabilityLog::set(const int row, const unsigned int amount) {
+	books[row] = amount;
+	append(row, '=', amount);
+}
+
+/* Appends change of @row by @op ('+', '-' or '=') and @amount to pending changes,
+   commits and snapshots when their intervals are reached */
+void AvailabilityLog::append(const int row, const char op, const unsigned int amount) {
+	pending += std::to_string(++sequence);
+	pending += '\t';
+	pending += op;
+	pending += std::to_string(amount);
+	pending += '\t';
+	pending += keys[row].get();
+	pending += '\n';
+	++sinceSnapshot;
+	if (++pendingCount >= groupSize)
+		commit();
+	if (snapshotInterval > 0 && sinceSnapshot >= snapshotInterval)
+		snapshot();
+}
+
+/* Writes pending changes into the log and syncs it to the disk. Returns false on failure,
+   the changes are kept pending then and written by the next commit */
+bool AvailabilityLog::commit() {
+	if (pendingCount == 0)
+		return true;
+	if (log == nullptr)
+		return false;
+	long long committed = fseek(log, 0, SEEK_END) == 0 ? (long long)ftell(log) : -1;
+	bool isWritten = committed >= 0 && fwrite(pending.data(), 1, pending.size(), log) == pending.size() && syncFile(log);
+	if (!isWritten) {
+		// Changes stay pending for the next commit, a part of them written can't stay in front of them
+		if (committed >= 0)
+			truncateFile(log, committed);
+		std::cerr << "Can't write availability log in " << directory << std::endl;
+		isFailed = true;
+		return false;
+	}
+	pending.clear();
+	pendingCount = 0;
+	++commits;
+	isFailed = false;
+	return true;
+}
+
+/* Writes availability of the whole catalog into the snapshot and empties the log.
+   Returns false on failure */
+bool AvailabilityLog::snapshot() {
+	if (log == nullptr || !commit())
+		return false;
+	String path = Util::joinPath(directory, AVAILABILITY_SNAPSHOT_FILE);
+	String temporary = path + String(".tmp");
+	FILE* file = fopen(temporary.get(), "wb");
+	if (file == nullptr)
+		return false;
+	std::string contents = "#" + std::to_string(sequence) + "\n";
+	for (int i = 0; i < books.getSize(); ++i) {
+		contents += std::to_string(books[i].getCurrentAmount());
+		contents += '\t';
+		contents += keys[i].get();
+		contents += '\n';
+	}
+	bool isWritten = fwrite(contents.data(), 1, contents.size(), file) == contents.size() && syncFile(file);
+	fclose(file);
+	// The old snapshot stays valid until the new one replaces it; a crash before the log is
+	// emptied is harmless, its records are at or below the snapshot sequence.
+	// The replacement must reach the disk before the log it covers is emptied
+	if (!isWritten || !replaceFile(temporary, path) || !syncDirectory(directory)) {
+		std::cerr << "Can't write availability snapshot " << path << std::endl;
+		return false;
+	}
+	fclose(log);
+	log = fopen(Util::joinPath(directory, AVAILABILITY_LOG_FILE).get(), "wb");
+	sinceSnapshot = 0;
+	return log != nullptr;
+}
+
+/* Returns true if the last commit failed, its changes are kept pending until a commit succeeds */
+bool AvailabilityLog::hasFailed() const {
+	return isFailed;
+}
+
+/* Returns the amount of commits (log syncs) done */
+long long AvailabilityLog::getCommits() const {
+	return commits;
+}
\ No newline at end of file
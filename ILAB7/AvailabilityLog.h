@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+#include "Book.h"
+#include "HashMap.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+#define AVAILABILITY_LOG_FILE "availability.wal"
+#define AVAILABILITY_SNAPSHOT_FILE "availability.snapshot"
+
+/* Availability Log class - makes changes of available copies durable across runs.
+   Every change is appended to a write-ahead log as a text line
+     <sequence> TAB <+n|-n|=n> TAB <author> TAB <title> TAB <year> TAB <occurrence>
+   where occurrence tells apart books sharing author, title and year. Changes are buffered and
+   written with a single write and sync per group of @groupSize changes (group commit), so
+   durability costs one sync per group instead of one per change.
+   Every @snapshotInterval changes the availability of the whole catalog is written into a
+   snapshot (a new file renamed over the old one) which starts with the last sequence it
+   covers, and the log is emptied. Recovery loads the snapshot and replays log records with
+   greater sequence numbers; a torn last record is ignored, a malformed one before it fails recovery */
+class AvailabilityLog {
+
+	ResizableArray<Book>& books;
+	String directory;
+	HashMap<String, int> rows;		// Identity key of a book to its row
+	ResizableArray<String> keys;	// Identity key of every row: author, title, year and occurrence
+	FILE* log;
+	std::string pending;			// Encoded changes not written yet
+	int pendingCount;
+	int groupSize;					// Changes written per commit
+	int snapshotInterval;			// Changes between snapshots, 0 means never
+	int sinceSnapshot;				// Changes logged since the last snapshot
+	long long sequence;				// Sequence number of the last logged change
+	long long commits;				// Successful commits
+	bool isFailed;					// The last commit failed
+
+	AvailabilityLog(const AvailabilityLog&); // Copy constructor disabled
+
+	/* Appends change of @row by @op ('+', '-' or '=') and @amount to pending changes,
+	   commits and snapshots when their intervals are reached */
+	void append(const int row, const char op, const unsigned int amount);
+	/* Applies a single encoded change (or snapshot line if @isSnapshot) to the catalog.
+	   Returns false if @line is malformed */
+	bool apply(const std::string& line, const bool isSnapshot, long long& lineSequence);
+	/* Reads file @name applying its lines. Sets @isTorn if the last line has no line break (it was
+	   torn by a crash and is ignored). Returns false if a line before it is malformed */
+	bool replay(const char* name, const bool isSnapshot, const long long after, int& applied, bool& isTorn);
+
+public:
+
+	/* Instantiates a log of availability of @books kept in @directory.
+	   @books must not be reordered or resized while the log is open */
+	AvailabilityLog(ResizableArray<Book>& books, const String& directory, const int groupSize = 64, const int snapshotInterval = 100000);
+	/* Destructor commits pending changes and closes the log */
+	~AvailabilityLog();
+
+	/* Recovers availability from the snapshot and log in the directory and opens the log
+	   for appending. Returns the amount of changes applied or -1 if the log can't be opened
+	   or a line before the end of the snapshot or log is malformed (both are left untouched) */
+	int open();
+
+	/* Returns row of the book with @author, @title and @year (its @occurrence-th copy) or -1 */
+	int findRow(const String& author, const String& title, const int year, const int occurrence = 0) const;
+
+	/* Adds @amount available copies to the book at @row */
+	void increment(const int row, const unsigned int amount = 1);
+	/* Takes @amount copies of the book at @row. Returns false (changing nothing) if there are fewer available */
+	bool decrement(const int row, const unsigned int amount = 1);
+	/* Sets available copies of the book at @row to @amount */
+	void set(const int row, const unsigned int amount);
+
+	/* Writes pending changes into the log and syncs it to the disk. Returns false on failure,
+	   the changes are kept pending then and written by the next commit */
+	bool commit();
+	/* Writes availability of the whole catalog into the snapshot and empties the log.
+	   Returns false on failure */
+	bool snapshot();
+
+	/* Returns true if the last commit failed, its changes are kept pending until a commit succeeds */
+	bool hasFailed() const;
+
+	/* Returns the amount of commits (log syncs) done */
+	long long getCommits() const;
+
+};
\ No newline at end of file
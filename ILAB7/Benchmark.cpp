@@ -0,0 +1,1081 @@
+#include "Benchmark.h"
+#include "AvailabilityLog.h"
+#include "Book.h"
+#include "BookParser.h"
+#include "Exception.h"
+#include "GroupBy.h"
+#include "LinkedList.h"
+#include "LoadGenerator.h"
+#include "Pair.h"
+#include "ParallelSort.h"
+#include "QueryEngine.h"
+#include "QueryServer.h"
+#include "RadixSort.h"
+#include "ShardCoordinator.h"
+#include "Sketches.h"
+#include "Socket.h"
+#include "ThreadPool.h"
+#include "ResizableArray.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+static const char* benchAuthors[] = {
+	"Herbert Schildt", "William Shakespeare", "Alexander Pushkin", "Patrick H. Hutton", "Simon Blackburn",
+	"Gilles Deleuze", "Stephen G. Kochan", "Ian Mc Bride", "Dylan Jones", "Jack London", "Ugo Bianchi",
+	"Martin Preistman", "Rick Arrington", "M Allaby", "O Gracia", "Charlez Pertzold"
+};
+
+static const char* benchWords[] = {
+	"the", "complete", "reference", "history", "memory", "art", "of", "programming", "in", "guide",
+	"java", "language", "code", "hidden", "philosophy", "modern", "world", "new", "lands", "crime"
+};
+
+static const char* benchSpheres[] = {
+	"Programming", "Computer Science", "History", "Philosophy", "Fiction", "Science", "Mythology",
+	"Classics", "Tragedy", "Guide", "Language", "Educational", "Geology", "Religion", "Romance"
+};
+
+#define BENCH_COUNT(arr) (int)(sizeof(arr) / sizeof(arr[0]))
+
+/* Returns the next pseudo random number of xorshift sequence @state */
+static unsigned int nextRandom(unsigned int& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/* Returns milliseconds passed since @start */
+static double millisecondsSince(const std::chrono::steady_clock::time_point& start) {
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/* Outputs a single result line: @label, time and throughput of @items items */
+static void report(std::ostream& out, const char* label, const double ms, const long long items, const char* unit) {
+	out << "  " << std::left << std::setw(36) << label << std::right
+		<< std::setw(10) << std::fixed << std::setprecision(1) << ms << " ms"
+		<< std::setw(14) << (long long)(ms > 0 ? items * 1000.0 / ms : 0) << ' ' << unit << "/s\n";
+}
+
+/* Writes @count synthetic Book records into the stream &out, every record starts with '%'.
+   About @dirtyPercent percent of records are malformed in one of the fields.
+   The same @seed always produces the same catalog */
+void generateCatalog(std::ostream& out, const int count, const int dirtyPercent, const unsigned int seed) {
+	unsigned int state = seed ? seed : 1;
+	for (int i = 0; i < count; ++i) {
+		bool isDirty = (int)(nextRandom(state) % 100) < dirtyPercent;
+		int brokenField = isDirty ? nextRandom(state) % 4 : -1;
+
+		out << '%' << (brokenField == 0 ? "R2 D2" : benchAuthors[nextRandom(state) % BENCH_COUNT(benchAuthors)]) << '\n';
+		int words = 2 + nextRandom(state) % 6;
+		for (int w = 0; w < words; ++w)
+			out << (w ? " " : "") << benchWords[nextRandom(state) % BENCH_COUNT(benchWords)];
+		out << ' ' << i << '\n';
+		if (brokenField == 1)
+			out << "unknown\n";
+		else out << 1500 + nextRandom(state) % 521 << '\n';
+		int sphereCount = 1 + nextRandom(state) % 3;
+		out << sphereCount << '\n';
+		for (int s = 0; s < sphereCount; ++s)
+			out << (brokenField == 2 && s == 0 ? "C++ 11" : benchSpheres[nextRandom(state) % BENCH_COUNT(benchSpheres)]) << '\n';
+		if (brokenField == 3)
+			out << "many\n";
+		else out << nextRandom(state) % 1000 << '\n';
+	}
+}
+
+/* Loads Books the way the program used to: operator>> throwing an Exception per malformed record */
+static int loadWithExceptions(std::istream& in, ResizableArray<Book>& books, const char delim) {
+	int failed = 0;
+	Book book = Book();
+	while (!in.eof() && in.good()) {
+		if (delim != '\n') in.ignore(INT_MAX, delim);
+		else while (!in.eof() && !std::isalnum(in.peek()))
+			in.ignore();
+		if (in.eof()) break;
+		try {
+			in >> book;
+			books.add(book);
+		}
+		catch (Exception&) {
+			++failed;
+			in.clear();
+		}
+	}
+	return failed;
+}
+
+/* Loads Books with non-throwing BookParser skipping malformed records */
+static int loadWithParser(std::istream& in, ResizableArray<Book>& books, const char delim) {
+	int failed = 0;
+	Book book = Book();
+	BookParser parser(in, delim);
+	ParseStatus status;
+	while ((status = parser.next(book)).code != ParseCode::EndOfInput) {
+		if (status.isOk())
+			books.add(book);
+		else ++failed;
+	}
+	return failed;
+}
+
+/* Compares throughput of exception based and status based loading on a dirty catalog */
+static void benchmarkParse(const Options& options, std::ostream& out) {
+	std::stringstream catalog;
+	generateCatalog(catalog, options.benchmarkBooks, options.benchmarkDirtyPercent, 42);
+	std::string text = catalog.str();
+	out << "parse: " << options.benchmarkBooks << " records, " << options.benchmarkDirtyPercent
+		<< "% dirty, " << text.size() / 1024 << " KB\n";
+
+	for (int pass = 0; pass < 2; ++pass) {
+		std::istringstream in(text);
+		ResizableArray<Book> books;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int failed = pass == 0 ? loadWithExceptions(in, books, '%') : loadWithParser(in, books, '%');
+		double ms = millisecondsSince(start);
+		std::ostringstream label;
+		label << (pass == 0 ? "operator>> with exceptions" : "BookParser") << " (" << books.getSize() << "/" << failed << ")";
+		report(out, label.str().c_str(), ms, options.benchmarkBooks, "records");
+	}
+}
+
+/* Loads the synthetic catalog described by @options into @books skipping malformed records */
+static void loadCatalog(const Options& options, ResizableArray<Book>& books) {
+	std::stringstream catalog;
+	generateCatalog(catalog, options.benchmarkBooks, options.benchmarkDirtyPercent, 42);
+	loadWithParser(catalog, books, '%');
+}
+
+/* Measures copying of a whole catalog, which is what every sort pass and report does with Books */
+static void benchmarkCopy(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	out << "copy: " << books.getSize() << " books, " << sizeof(Book) << " bytes per Book\n";
+
+	const int passes = 5;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass) {
+		ResizableArray<Book> copy = books;
+	}
+	report(out, "copy construct catalog", millisecondsSince(start), (long long)books.getSize() * passes, "books");
+
+	ResizableArray<Book> target = books;
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+		for (int i = 0; i < books.getSize(); ++i)
+			target[i] = books[books.getSize() - 1 - i];
+	report(out, "assign into existing Books", millisecondsSince(start), (long long)books.getSize() * passes, "books");
+
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass) {
+		ResizableArray<Book> grown;
+		for (int i = 0; i < books.getSize(); ++i)
+			grown.add(books[i]);
+	}
+	report(out, "grow catalog Book by Book", millisecondsSince(start), (long long)books.getSize() * passes, "books");
+
+	// Plain integer column of the same catalog, copies of it are bound by memory bandwidth
+	const int counts = books.getSize() * 16;
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass) {
+		ResizableArray<int> grown;
+		for (int i = 0; i < counts; ++i)
+			grown.add(i);
+	}
+	report(out, "grow int column one by one", millisecondsSince(start), (long long)counts * passes, "ints");
+
+	ResizableArray<int> column(counts);
+	for (int i = 0; i < counts; ++i)
+		column.add(books[i % books.getSize()].getCurrentAmount());
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass) {
+		ResizableArray<int> copy = column;
+	}
+	report(out, "copy construct int column", millisecondsSince(start), (long long)counts * passes, "ints");
+}
+
+/* Measures parallel sort of a catalog with 1, 2, 4 ... threads up to --threads (or the hardware
+   thread count) and checks every result is the same as the single threaded one */
+static void benchmarkSort(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	int maxThreads = ThreadPool::resolveThreadCount(options.threads);
+	out << "sort: " << books.getSize() << " books, up to " << maxThreads << " threads\n";
+
+	ResizableArray<Book> reference = books;
+	double singleMs = 0;
+	for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+		ResizableArray<Book> sorted = books;
+		ThreadPool pool(threads);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		parallelSort(sorted, pool);
+		double ms = millisecondsSince(start);
+		if (threads == 1) {
+			singleMs = ms;
+			reference = sorted;
+		}
+		bool isSame = true;
+		for (int i = 0; i < sorted.getSize() && isSame; ++i)
+			isSame = sorted[i] == reference[i] && sorted[i].getCurrentAmount() == reference[i].getCurrentAmount();
+		std::ostringstream label;
+		label << threads << (threads == 1 ? " thread" : " threads") << " (x" << std::fixed << std::setprecision(2)
+			<< (ms > 0 ? singleMs / ms : 0) << (isSame ? ")" : ", DIFFERENT ORDER)");
+		report(out, label.str().c_str(), ms, books.getSize(), "books");
+		if (threads == maxThreads)
+			break;
+	}
+
+	// Indirect radix sorts on the integer keys, the one on copies alone has to match the merge sort
+	for (int composite = 0; composite < 2; ++composite) {
+		ResizableArray<Book> sorted = books;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (composite)
+			radixSort(sorted, [](const Book& book) {
+				return (unsigned long long)(unsigned int)book.getCurrentAmount() << 16 | (date_y)book.getPublicationYear();
+			});
+		else radixSort(sorted, [](const Book& book) {
+			return (unsigned long long)(unsigned int)book.getCurrentAmount();
+		});
+		double ms = millisecondsSince(start);
+		bool isSame = true;
+		for (int i = 0; i < sorted.getSize() && isSame; ++i)
+			isSame = composite ? i == 0 || sorted[i - 1].getCurrentAmount() < sorted[i].getCurrentAmount()
+				|| (sorted[i - 1].getCurrentAmount() == sorted[i].getCurrentAmount() && sorted[i - 1].getPublicationYear() <= sorted[i].getPublicationYear())
+				: sorted[i] == reference[i] && sorted[i].getCurrentAmount() == reference[i].getCurrentAmount();
+		std::ostringstream label;
+		label << "radix on " << (composite ? "(copies, year)" : "copies") << " (x" << std::fixed << std::setprecision(2)
+			<< (ms > 0 ? singleMs / ms : 0) << (isSame ? ")" : ", WRONG ORDER)");
+		report(out, label.str().c_str(), ms, books.getSize(), "books");
+	}
+}
+
+/* Measures a findBestAvailability style reduction and a nested parallelFor on pools of 1, 2, 4 ...
+   threads up to --threads (or the hardware thread count). Checks results against sequential ones */
+static void benchmarkPool(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	int maxThreads = ThreadPool::resolveThreadCount(options.threads);
+	const int passes = 20;
+	out << "pool: " << books.getSize() << " books, up to " << maxThreads << " threads\n";
+
+	int expectedBest = 0;
+	for (int i = 1; i < books.getSize(); ++i)
+		if (books[i] > books[expectedBest])
+			expectedBest = i;
+	long long expectedSum = 0;
+	for (int i = 0; i < books.getSize(); ++i)
+		expectedSum += books[i].getCurrentAmount() * (long long)books[i].getSpheresCount();
+
+	double singleMs = 0;
+	for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+		ThreadPool pool(threads);
+		int best = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass)
+			best = parallelReduce(pool, 0, books.getSize(), 0, 0,
+				[&books](int from, int to) {
+					int bestAvailable = from;
+					for (int i = from + 1; i < to; ++i)
+						if (books[i] > books[bestAvailable])
+							bestAvailable = i;
+					return bestAvailable;
+				},
+				[&books](int left, int right) {
+					return books[right] > books[left] ? right : left;
+				});
+		double ms = millisecondsSince(start);
+		if (threads == 1)
+			singleMs = ms;
+		std::ostringstream label;
+		label << "best availability, " << threads << "t (x" << std::fixed << std::setprecision(2)
+			<< (ms > 0 ? singleMs / ms : 0) << (best == expectedBest ? ")" : ", WRONG)");
+		report(out, label.str().c_str(), ms, (long long)books.getSize() * passes, "books");
+
+		// Outer loop over chunks of books, inner loop over spheres of each chunk, both parallel
+		std::atomic<long long> sum(0);
+		start = std::chrono::steady_clock::now();
+		parallelFor(pool, 0, books.getSize(), 0, [&pool, &books, &sum](int from, int to) {
+			long long chunk = parallelReduce(pool, from, to, 256, 0LL,
+				[&books](int f, int t) {
+					long long partial = 0;
+					for (int i = f; i < t; ++i)
+						partial += books[i].getCurrentAmount() * (long long)books[i].getSpheresCount();
+					return partial;
+				},
+				[](long long left, long long right) { return left + right; });
+			sum += chunk;
+		});
+		label.str("");
+		label << "nested parallel sum, " << threads << "t" << (sum == expectedSum ? "" : " (WRONG)");
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "books");
+		if (threads == maxThreads)
+			break;
+	}
+}
+
+/* Measures parallel group-by of a catalog by sphere, author and year on pools of 1, 2, 4 ...
+   threads up to --threads (or the hardware thread count) */
+static void benchmarkGroup(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	int maxThreads = ThreadPool::resolveThreadCount(options.threads);
+	out << "group: " << books.getSize() << " books, up to " << maxThreads << " threads\n";
+
+	for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+		ThreadPool pool(threads);
+		ResizableArray<Pair<String, int>> groups;
+		ResizableArray<Pair<int, int>> years;
+		std::ostringstream label;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		countSpheres(books, groups, pool);
+		label << "spheres, " << threads << "t (" << groups.getSize() << " groups)";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "books");
+
+		start = std::chrono::steady_clock::now();
+		countAuthors(books, groups, pool);
+		label.str("");
+		label << "authors, " << threads << "t (" << groups.getSize() << " groups)";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "books");
+
+		start = std::chrono::steady_clock::now();
+		countYears(books, years, pool);
+		label.str("");
+		label << "years, " << threads << "t (" << years.getSize() << " groups)";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "books");
+		if (threads == maxThreads)
+			break;
+	}
+}
+
+/* Measures checkouts and returns of random books through an AvailabilityLog kept in the
+   output directory with commit groups of 1, 8, 64 and 512 changes, then recovery of the log */
+static void benchmarkWal(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	const int changes = 20000;
+	String logPath = Util::joinPath(options.outputDirectory, AVAILABILITY_LOG_FILE);
+	String snapshotPath = Util::joinPath(options.outputDirectory, AVAILABILITY_SNAPSHOT_FILE);
+	out << "wal: " << books.getSize() << " books, " << changes << " changes in " << options.outputDirectory << '\n';
+	if (books.isEmpty())
+		return;
+
+	const int groups[] = { 1, 8, 64, 512 };
+	for (int g = 0; g < BENCH_COUNT(groups); ++g) {
+		std::remove(logPath.get());
+		std::remove(snapshotPath.get());
+		AvailabilityLog log(books, options.outputDirectory, groups[g], 0);
+		if (log.open() < 0) {
+			out << "  can't open the log\n";
+			return;
+		}
+		unsigned int state = 42;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < changes; ++i) {
+			int row = nextRandom(state) % books.getSize();
+			if (!log.decrement(row))
+				log.increment(row);
+		}
+		log.commit();
+		std::ostringstream label;
+		label << "commit every " << groups[g] << " (" << log.getCommits() << " syncs)";
+		report(out, label.str().c_str(), millisecondsSince(start), changes, "changes");
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int recovered;
+	{
+		AvailabilityLog log(books, options.outputDirectory, 64, 0);
+		recovered = log.open();
+	}
+	report(out, "recovery from the log", millisecondsSince(start), recovered, "changes");
+	start = std::chrono::steady_clock::now();
+	{
+		AvailabilityLog log(books, options.outputDirectory, 64, 0);
+		log.open();
+		log.snapshot();
+	}
+	report(out, "snapshot", millisecondsSince(start), books.getSize(), "books");
+	std::remove(logPath.get());
+	std::remove(snapshotPath.get());
+}
+
+/* Scans integer columns @counts and @years with checked accesses: the maximum amount of copies
+   plus the amount of books published in [1950, 2000] */
+static long long scanChecked(const ResizableArray<int>& counts, const ResizableArray<date_y>& years) {
+	int best = 0, inRange = 0;
+	for (int i = 0; i < counts.getSize(); ++i) {
+		best = counts.elementAt(i) > best ? counts.elementAt(i) : best;
+		inRange += years.elementAt(i) >= 1950 && years.elementAt(i) <= 2000;
+	}
+	return (long long)best + inRange;
+}
+
+/* Same scan as one loop over the raw column data, only the bounds checks are gone */
+static long long scanUnchecked(const ResizableArray<int>& counts, const ResizableArray<date_y>& years) {
+	const int* count = counts.data();
+	const date_y* year = years.data();
+	int best = 0, inRange = 0;
+	for (int i = 0; i < counts.getSize(); ++i) {
+		best = count[i] > best ? count[i] : best;
+		inRange += year[i] >= 1950 && year[i] <= 2000;
+	}
+	return (long long)best + inRange;
+}
+
+/* Measures scans of the availability and year columns of a catalog through checked elementAt
+   against unchecked accesses of the same loop */
+static void benchmarkScan(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	ResizableArray<int> counts(books.getSize());
+	ResizableArray<date_y> years(books.getSize());
+	for (const Book& book : books) {
+		counts.add(book.getCurrentAmount());
+		years.add((date_y)book.getPublicationYear());
+	}
+	out << "scan: " << books.getSize() << " books\n";
+
+	const int passes = 50;
+	long long checksum[2] = { 0, 0 };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+		checksum[0] += scanChecked(counts, years);
+	report(out, "columns through elementAt", millisecondsSince(start), (long long)books.getSize() * passes, "books");
+
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+		checksum[1] += scanUnchecked(counts, years);
+	report(out, "columns through data()", millisecondsSince(start), (long long)books.getSize() * passes, "books");
+	if (checksum[0] != checksum[1])
+		out << "  scans disagree!\n";
+}
+
+/* Measures year range selections and per-decade sums of available copies: scanning every Book
+   against the Year Index, and a sphere query combined with a year range through the engine */
+static void benchmarkYears(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	out << "years: " << books.getSize() << " books\n";
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	QueryEngine engine;
+	engine.build(books);
+	report(out, "build engine (spheres and years)", millisecondsSince(start), books.getSize(), "books");
+	const YearIndex& years = engine.getYearIndex();
+
+	const int passes = 20;
+	const int ranges[][2] = { { 2000, 2000 }, { 1990, 1999 }, { 1900, 2020 } };
+	RowSet result;
+	for (int r = 0; r < 3; ++r) {
+		int from = ranges[r][0], to = ranges[r][1];
+		int scanned = 0, selected = 0;
+		start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			result.reset(books.getSize());
+			for (int i = 0; i < books.getSize(); ++i)
+				if (books[i].getPublicationYear() >= from && books[i].getPublicationYear() <= to)
+					result.add(i);
+			scanned = result.count();
+		}
+		std::ostringstream label;
+		label << from << "-" << to << ", scanning Books";
+		report(out, label.str().c_str(), millisecondsSince(start), (long long)passes, "ranges");
+
+		start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			engine.selectYears(from, to, result);
+			selected = result.count();
+		}
+		label.str("");
+		label << from << "-" << to << ", year index (" << selected << " rows" << (selected == scanned ? ")" : ", DIFFERENT)");
+		report(out, label.str().c_str(), millisecondsSince(start), (long long)passes, "ranges");
+	}
+
+	long long checksum[2] = { 0, 0 };
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass) {
+		long long decades[BOOK_MAX_YEAR / 10 + 1] = {};
+		for (const Book& book : books)
+			decades[book.getPublicationYear() / 10] += book.getCurrentAmount();
+		for (long long copies : decades)
+			checksum[0] += copies;
+	}
+	report(out, "copies per decade, scanning Books", millisecondsSince(start), (long long)passes, "reports");
+
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+		for (int decade = 0; decade <= years.getLastYear(); decade += 10)
+			checksum[1] += years.getCopies(decade, decade + 9);
+	report(out, checksum[0] == checksum[1] ? "copies per decade, year index" : "copies per decade, year index (DIFFERENT)",
+		millisecondsSince(start), (long long)passes, "reports");
+
+	String query = "Science AND YEAR 1990-1999";
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+		engine.evaluate(query, result);
+	std::ostringstream label;
+	label << query << " (" << result.count() << " rows)";
+	report(out, label.str().c_str(), millisecondsSince(start), (long long)passes, "queries");
+}
+
+/* Comparison Strings used before sort keys: tolower of both characters at every position */
+static bool isGreaterByFolding(const String& str1, const String& str2) {
+	if (str2.getLength() == 0)
+		return str1.getLength() != 0;
+	const char* a = str1.get();
+	const char* b = str2.get();
+	int lim = str1.getLength() < str2.getLength() ? str1.getLength() : str2.getLength();
+	for (int i = 0; i < lim; ++i) {
+		if (tolower(a[i]) > tolower(b[i]))
+			return true;
+		else if (tolower(a[i]) < tolower(b[i]))
+			return false;
+	}
+	return false;
+}
+
+/* Measures sorting of author and title columns of a catalog: comparing by folding every
+   character against comparing sort keys first, then the parallel sort on one thread */
+static void benchmarkStrings(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	out << "strings: " << books.getSize() << " books\n";
+	const char* columns[] = { "authors", "titles" };
+	for (int c = 0; c < 2; ++c) {
+		ResizableArray<String> column(books.getSize());
+		for (int i = 0; i < books.getSize(); ++i)
+			column.add(c == 0 ? books[i].getAuthor() : books[i].getTitle());
+		std::ostringstream label;
+
+		ResizableArray<String> sorted = column;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::stable_sort(sorted.begin(), sorted.end(), [](const String& a, const String& b) { return isGreaterByFolding(b, a); });
+		label << columns[c] << ", folding every character";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "strings");
+
+		sorted = column;
+		start = std::chrono::steady_clock::now();
+		std::stable_sort(sorted.begin(), sorted.end(), [](const String& a, const String& b) { return a < b; });
+		label.str("");
+		label << columns[c] << ", sort keys";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "strings");
+
+		ThreadPool pool(1);
+		sorted = column;
+		start = std::chrono::steady_clock::now();
+		parallelSort(sorted, pool);
+		label.str("");
+		label << columns[c] << ", sort keys, parallelSort 1t";
+		report(out, label.str().c_str(), millisecondsSince(start), books.getSize(), "strings");
+	}
+}
+
+/* Measures copy heavy paths of reports and queries with Strings sharing their buffers against
+   Strings duplicating them: author and title getters, sphere counts put into Pairs and a list,
+   copies of the whole catalog and copies dropped by other threads than the ones which made them */
+static void benchmarkSharing(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	out << "sharing: " << books.getSize() << " books\n";
+	bool wasSharing = String::getSharing();
+	const int passes = 5;
+	ThreadPool pool(ThreadPool::resolveThreadCount(options.threads));
+	for (int mode = 0; mode < 2; ++mode) {
+		String::setSharing(mode == 1);
+		const char* how = mode == 1 ? ", shared" : ", duplicated";
+		std::ostringstream label;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		long long characters = 0;
+		for (int pass = 0; pass < passes; ++pass)
+			for (int i = 0; i < books.getSize(); ++i) {
+				String author = books[i].getAuthor();
+				String title = books[i].getTitle();
+				characters += author.getLength() + title.getLength();
+			}
+		label << "author, title getters" << how;
+		report(out, label.str().c_str(), millisecondsSince(start), characters, "chars");
+
+		start = std::chrono::steady_clock::now();
+		long long spheres = 0;
+		for (int pass = 0; pass < passes; ++pass) {
+			LinkedList<Pair<String, int>> list;
+			for (int i = 0; i < books.getSize(); ++i)
+				for (int j = 0; j < books[i].getSpheresCount(); ++j) {
+					list.add(Pair<String, int>(books[i].getSpheres()[j], 1));
+					++spheres;
+				}
+		}
+		label.str("");
+		label << "sphere Pairs into list" << how;
+		report(out, label.str().c_str(), millisecondsSince(start), spheres, "spheres");
+
+		start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			ResizableArray<Book> copy = books;
+		}
+		label.str("");
+		label << "copy catalog" << how;
+		report(out, label.str().c_str(), millisecondsSince(start), (long long)books.getSize() * passes, "books");
+
+		// Every thread copies the authors and drops its copies, the counts change concurrently
+		start = std::chrono::steady_clock::now();
+		parallelFor(pool, 0, pool.getThreadCount() * passes, 1, [&books](int from, int to) {
+			for (int p = from; p < to; ++p) {
+				ResizableArray<String> authors(books.getSize());
+				for (int i = 0; i < books.getSize(); ++i)
+					authors.add(books[i].getAuthor());
+			}
+		});
+		label.str("");
+		label << "authors on " << pool.getThreadCount() << " threads" << how;
+		report(out, label.str().c_str(), millisecondsSince(start), (long long)books.getSize() * pool.getThreadCount() * passes, "strings");
+	}
+	String::setSharing(wasSharing);
+}
+
+/* Query Server over a part of the benchmark catalog, running on a thread of its own */
+struct BenchmarkServer {
+	ResizableArray<Book> books;
+	ResizableArray<int> rowIds;		// Rows of a shard in the whole catalog
+	QueryEngine engine;
+	ThreadPool pool;
+	QueryServer* server;
+	std::thread thread;
+
+	BenchmarkServer(const int threads) : pool(threads) {
+		server = nullptr;
+	}
+
+	/* Starts serving on a free port, as a shard if @isShard, forwarding requests to @coordinator
+	   unless it is nullptr. Returns the port, -1 on failure */
+	int start(const bool isShard, ShardCoordinator* coordinator) {
+		engine.build(books);
+		server = new QueryServer(books, engine, pool);
+		if (isShard)
+			server->setRowIds(rowIds);
+		if (coordinator != nullptr)
+			server->setCoordinator(*coordinator);
+		if (!server->listen(0))
+			return -1;
+		thread = std::thread([this]() { server->run(); });
+		return server->getPort();
+	}
+
+	~BenchmarkServer() {
+		if (thread.joinable())
+			thread.join();
+		delete server;
+	}
+};
+
+/* Sends every one of @requests to the server on localhost:@port and stores the responses in
+   @responses. Returns false if the server can't be reached */
+static bool askServer(const int port, const ResizableArray<String>& requests, ResizableArray<std::string>& responses) {
+	socket_t socket = Net::connectLocal(port);
+	if (socket == NET_INVALID_SOCKET)
+		return false;
+	Net::LineReader* reader = new Net::LineReader(socket);
+	bool isOk = true;
+	std::string response;
+	for (int i = 0; i < requests.getSize() && isOk; ++i) {
+		std::string line = requests[i].get();
+		line += '\n';
+		isOk = Net::sendAll(socket, line.data(), (int)line.size()) && readResponse(*reader, response);
+		responses.add(response);
+	}
+	delete reader;
+	Net::close(socket);
+	return isOk;
+}
+
+/* Measures throughput of the default request mix against a single server over the whole catalog
+   and against a coordinator of 1, 2, 4 ... shard servers up to --threads (at least 2), every server
+   on a pool of one thread. Checks every coordinator answers as the single server does */
+static void benchmarkShards(const Options& options, std::ostream& out) {
+	if (!Net::startup()) {
+		out << "shards: sockets are not available\n";
+		return;
+	}
+	BenchmarkServer* whole = new BenchmarkServer(1);
+	loadCatalog(options, whole->books);
+	int maxShards = ThreadPool::resolveThreadCount(options.threads);
+	maxShards = maxShards < 2 ? 2 : maxShards > SHARD_MAX_COUNT ? SHARD_MAX_COUNT : maxShards;
+	out << "shards: " << whole->books.getSize() << " books, up to " << maxShards << " shards\n";
+
+	ResizableArray<String> requests;
+	addDefaultRequests(requests);
+	requests.add("SPHERES");
+	const int connections = 8;
+	const int perConnection = 500;
+	ResizableArray<String> shutdowns;
+	shutdowns.add("SHUTDOWN");
+	ResizableArray<std::string> ignored;
+
+	int port = whole->start(false, nullptr);
+	ResizableArray<std::string> expected;
+	if (port < 0 || !askServer(port, requests, expected)) {
+		out << "shards: can't start a server\n";
+		delete whole;
+		return;
+	}
+	LoadResult result = generateLoad(port, requests, connections, perConnection, 1);
+	report(out, "whole catalog, single server", result.milliseconds, result.requests, "requests");
+	askServer(port, shutdowns, ignored);
+
+	for (int shards = 1; shards <= maxShards; shards *= 2) {
+		BenchmarkServer** parts = new BenchmarkServer*[shards];
+		ResizableArray<int> ports;
+		for (int s = 0; s < shards; ++s) {
+			parts[s] = new BenchmarkServer(1);
+			parts[s]->books = whole->books;
+			int nextRow = 0;
+			keepShard(parts[s]->books, 0, s, shards, parts[s]->rowIds, nextRow);
+			ports.add(parts[s]->start(true, nullptr));
+		}
+		// Coordinator threads mostly wait for shards, a few of them keep every shard busy
+		ShardCoordinator coordinator(ports);
+		BenchmarkServer* front = new BenchmarkServer(connections);
+		bool isOk = coordinator.connect() && (port = front->start(false, &coordinator)) >= 0;
+		ResizableArray<std::string> responses;
+		std::ostringstream label;
+		label << shards << (shards == 1 ? " shard" : " shards") << ", coordinator";
+		if (!isOk || !askServer(port, requests, responses))
+			out << "  " << label.str() << ": can't start the servers\n";
+		else {
+			result = generateLoad(port, requests, connections, perConnection, 1);
+			report(out, label.str().c_str(), result.milliseconds, result.requests, "requests");
+			for (int i = 0; i < requests.getSize(); ++i)
+				if (responses[i] != expected[i])
+					out << "  answers to " << requests[i] << " differ from the single server!\n";
+		}
+		// Stops the coordinator and its shards
+		if (isOk)
+			askServer(port, shutdowns, ignored);
+		else for (int s = 0; s < shards; ++s)
+			if (ports[s] >= 0)
+				askServer(ports[s], shutdowns, ignored);
+		delete front;
+		for (int s = 0; s < shards; ++s)
+			delete parts[s];
+		delete[] parts;
+	}
+	delete whole;
+}
+
+/* Measures summarizing a catalog in sketches while parsing it against parsing it into Books, the
+   same with slices of the catalog sketched on every thread and merged, and compares the estimates
+   with exact counts */
+static void benchmarkSketch(const Options& options, std::ostream& out) {
+	std::stringstream catalog;
+	generateCatalog(catalog, options.benchmarkBooks, options.benchmarkDirtyPercent, 42);
+	std::string text = catalog.str();
+	out << "sketch: " << options.benchmarkBooks << " records, " << sizeof(CatalogSketch) << " bytes of sketches\n";
+
+	ResizableArray<Book> books;
+	std::istringstream booksInput(text);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	loadWithParser(booksInput, books, '%');
+	report(out, "parse into Books", millisecondsSince(start), books.getSize(), "books");
+
+	CatalogSketch* sequential = new CatalogSketch();
+	std::istringstream sketchInput(text);
+	LoadReport loadReport;
+	start = std::chrono::steady_clock::now();
+	sketchBooks(sketchInput, *sequential, '%', ErrorPolicy::Skip, loadReport);
+	report(out, "parse into sketches", millisecondsSince(start), sequential->getBookCount(), "books");
+
+	// Slices start at records, every thread sketches its own and the sketches are merged
+	ThreadPool pool(ThreadPool::resolveThreadCount(options.threads));
+	int slices = pool.getThreadCount();
+	ResizableArray<size_t> bounds;
+	bounds.add(0);
+	for (int i = 1; i < slices; ++i) {
+		size_t bound = text.find("\n%", text.size() / slices * i);
+		bounds.add(bound == std::string::npos ? text.size() : bound + 1);
+	}
+	bounds.add(text.size());
+	CatalogSketch** parts = new CatalogSketch*[slices];
+	for (int i = 0; i < slices; ++i)
+		parts[i] = new CatalogSketch();
+	start = std::chrono::steady_clock::now();
+	parallelFor(pool, 0, slices, 1, [&text, &bounds, parts](int from, int to) {
+		for (int i = from; i < to; ++i) {
+			std::istringstream in(text.substr(bounds[i], bounds[i + 1] - bounds[i]));
+			LoadReport sliceReport;
+			sketchBooks(in, *parts[i], '%', ErrorPolicy::Skip, sliceReport);
+		}
+	});
+	for (int i = 1; i < slices; ++i)
+		parts[0]->merge(*parts[i]);
+	std::ostringstream label;
+	label << "parse into sketches, " << slices << " threads";
+	report(out, label.str().c_str(), millisecondsSince(start), parts[0]->getBookCount(), "books");
+	if (parts[0]->getBookCount() != sequential->getBookCount() || parts[0]->getAuthorCount() != sequential->getAuthorCount()
+		|| parts[0]->getTitleCount() != sequential->getTitleCount() || parts[0]->getSphereCount() != sequential->getSphereCount()
+		|| parts[0]->getAmounts().getQuantile(0.5) != sequential->getAmounts().getQuantile(0.5))
+		out << "  merged sketches differ from the sequential ones!\n";
+
+	// Exact counts of the same Books
+	HashMap<String, int> authors, titles, spheres;
+	ResizableArray<int> amounts(books.getSize() > 0 ? books.getSize() : 1);
+	for (int i = 0; i < books.getSize(); ++i) {
+		++authors[books[i].getAuthor()];
+		++titles[books[i].getTitle()];
+		for (int s = 0; s < books[i].getSpheresCount(); ++s)
+			++spheres[books[i].getSpheres()[s]];
+		amounts.add(books[i].getCurrentAmount());
+	}
+	std::sort(amounts.begin(), amounts.end());
+	out << std::fixed << std::setprecision(2)
+		<< "  distinct authors " << authors.getSize() << ", estimated " << (long long)sequential->getAuthorCount()
+		<< " (" << (sequential->getAuthorCount() / (authors.getSize() > 0 ? authors.getSize() : 1) - 1) * 100 << "%)\n"
+		<< "  distinct titles " << titles.getSize() << ", estimated " << (long long)sequential->getTitleCount()
+		<< " (" << (sequential->getTitleCount() / (titles.getSize() > 0 ? titles.getSize() : 1) - 1) * 100 << "%)\n";
+	const HeavyHitters& top = sequential->getTopSpheres();
+	long long worst = 0;
+	for (int i = 0; i < top.getSize(); ++i) {
+		const int* exact = spheres.find(top.getKey(i));
+		long long over = (long long)top.getEstimate(i) - (exact != nullptr ? *exact : 0);
+		worst = over > worst ? over : worst;
+	}
+	out << "  sphere counts exceed exact ones by up to " << worst << ", bound " << (long long)top.getCounts().getErrorBound() << '\n';
+	if (!amounts.isEmpty())
+		out << "  median of available copies " << amounts[(amounts.getSize() - 1) / 2] << ", estimated "
+			<< sequential->getAmounts().getQuantile(0.5) << '\n';
+
+	for (int i = 0; i < slices; ++i)
+		delete parts[i];
+	delete[] parts;
+	delete sequential;
+}
+
+static const char* benchNonLatinFields[] = {
+	"\xD0\xB0\xD0\xBB\xD0\xB5\xD0\xBA\xD1\x81\xD0\xB0\xD0\xBD\xD0\xB4\xD1\x80 \xD0\xBF\xD1\x83\xD1\x88\xD0\xBA\xD0\xB8\xD0\xBD",	// alexandr pushkin
+	"\xCE\xBD\xCE\xAF\xCE\xBA\xCE\xBF\xCF\x82  \xCE\xBA\xCE\xB1\xCE\xB6\xCE\xB1\xCE\xBD\xCF\x84\xCE\xB6\xCE\xAC\xCE\xBA\xCE\xB7\xCF\x82",	// nikos kazantzakis
+	" JOS\xC3\x89 SARAMAGO ", "g\xC3\xBCnter grass", "\xC5\x81ODZ \xC5\xBB\xC3\x93\xC5\x81W"
+};
+
+/* Name check used before the lookup tables: isalpha of every character */
+static bool isValidNameByBytes(const char* name, const int length) {
+	for (int i = 0; i < length; ++i)
+		if (!(isalpha(name[i]) || name[i] == ' ' || name[i] == '-' || name[i] == '.'))
+			return false;
+	return true;
+}
+
+/* Normalization used before the lookup tables: toupper or tolower of every character */
+static int normalizeByBytes(char* str, const int length) {
+	int read = 0, write = 0;
+	while (read < length && str[read] == ' ')
+		read++;
+	for (; read < length; ++read) {
+		if (str[read] == ' ' && (read + 1 == length || str[read + 1] == ' '))
+			continue;
+		if (write == 0 || str[write - 1] == ' ')
+			str[write++] = toupper(str[read]);
+		else str[write++] = tolower(str[read]);
+	}
+	return write;
+}
+
+/* Name check through the lookup tables */
+static bool isValidNameByTables(const char* name, const int length) {
+	return Util::isValidField(name, length, Util::CharLetter | Util::CharSpace | Util::CharNameMark);
+}
+
+/* Checks a name and normalizes it the way the parsers used to, returns its new length or -1 */
+static int normalizeNameByBytes(char* name, const int length) {
+	return isValidNameByBytes(name, length) ? normalizeByBytes(name, length) : -1;
+}
+
+/* Checks a name and normalizes it through the lookup tables in two passes, returns its new length or -1 */
+static int normalizeNameByTables(char* name, const int length) {
+	return isValidNameByTables(name, length) ? Util::normalizeBuffer(name, length) : -1;
+}
+
+/* Checks a name and normalizes it in the single pass the parsers make, returns its new length or -1 */
+static int normalizeNameInOnePass(char* name, const int length) {
+	return Util::normalizeField(name, length, Util::CharLetter | Util::CharSpace | Util::CharNameMark);
+}
+
+/* Checks and normalizes every field of @fields @passes times with @normalize, returns the sum of results */
+static long long checkFields(const ResizableArray<String>& fields, const int passes, int (*normalize)(char*, const int)) {
+	char buffer[BOOK_PARSER_LINE_SIZE];
+	long long sum = 0;
+	for (int pass = 0; pass < passes; ++pass)
+		for (int i = 0; i < fields.getSize(); ++i) {
+			int length = fields[i].getLength() < BOOK_PARSER_LINE_SIZE ? fields[i].getLength() : BOOK_PARSER_LINE_SIZE - 1;
+			std::memcpy(buffer, fields[i].get(), length);
+			sum += normalize(buffer, length);
+		}
+	return sum;
+}
+
+/* Measures validation and normalization of author and sphere fields: per character locale calls
+   against the lookup tables on ASCII fields, and the UTF-8 path on non-Latin fields, then parsing
+   of numeric fields by stream extraction against parseUnsigned */
+static void benchmarkNormalize(const Options& options, std::ostream& out) {
+	ResizableArray<Book> books;
+	loadCatalog(options, books);
+	ResizableArray<String> fields(books.getSize() * 2 + 1);
+	for (int i = 0; i < books.getSize(); ++i) {
+		String author = books[i].getAuthor(), sphere = books[i].getSpheres()[0];
+		Util::lowerBuffer(&author[0], author.getLength());
+		Util::lowerBuffer(&sphere[0], sphere.getLength());
+		fields.add(author);
+		fields.add(sphere);
+	}
+	long long characters = 0;
+	for (int i = 0; i < fields.getSize(); ++i)
+		characters += fields[i].getLength();
+	out << "normalize: " << fields.getSize() << " fields, " << characters << " characters\n";
+	const int passes = 5;
+	const long long checked = fields.getSize() * (long long)passes;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	long long before = checkFields(fields, passes, normalizeNameByBytes);
+	report(out, "ASCII, isalpha/toupper per character", millisecondsSince(start), checked, "fields");
+	start = std::chrono::steady_clock::now();
+	long long tables = checkFields(fields, passes, normalizeNameByTables);
+	report(out, "ASCII, lookup tables, two passes", millisecondsSince(start), checked, "fields");
+	start = std::chrono::steady_clock::now();
+	long long fused = checkFields(fields, passes, normalizeNameInOnePass);
+	report(out, "ASCII, lookup tables, one pass", millisecondsSince(start), checked, "fields");
+	if (before != tables || before != fused)
+		out << "  lookup tables give other results than the per character calls!\n";
+
+	ResizableArray<String> nonLatin(fields.getSize());
+	for (int i = 0; i < fields.getSize(); ++i)
+		nonLatin.add(benchNonLatinFields[i % BENCH_COUNT(benchNonLatinFields)]);
+	start = std::chrono::steady_clock::now();
+	checkFields(nonLatin, passes, normalizeNameInOnePass);
+	report(out, "UTF-8, decoding and case mapping", millisecondsSince(start), checked, "fields");
+	String example = benchNonLatinFields[1];
+	Util::normalizeString(example);
+	out << "  \"" << benchNonLatinFields[1] << "\" is normalized into \"" << example << "\", "
+		<< (isValidNameByTables(example.get(), example.getLength()) ? "a valid" : "not a valid") << " name\n";
+
+	// Year, sphere count and available copies lines of every Book
+	std::ostringstream numbers;
+	for (int i = 0; i < books.getSize(); ++i)
+		numbers << books[i].getPublicationYear() << '\n' << books[i].getSpheresCount() << '\n' << books[i].getCurrentAmount() << '\n';
+	std::string text = numbers.str();
+	long long lines = books.getSize() * 3LL;
+
+	start = std::chrono::steady_clock::now();
+	long long sum = 0;
+	for (int pass = 0; pass < passes; ++pass) {
+		std::istringstream in(text);
+		unsigned int num;
+		for (long long i = 0; i < lines; ++i) {
+			in >> num;
+			in.ignore(INT_MAX, '\n');
+			sum += num;
+		}
+	}
+	report(out, "numbers, operator>> and ignore", millisecondsSince(start), lines * passes, "fields");
+	start = std::chrono::steady_clock::now();
+	long long parsedSum = 0;
+	for (int pass = 0; pass < passes; ++pass)
+		for (const char* line = text.c_str(), *end = line + text.size(); line < end;) {
+			const char* lineEnd = (const char*)std::memchr(line, '\n', end - line);
+			unsigned long long num;
+			if (Util::parseUnsigned(line, (int)(lineEnd - line), UINT_MAX, num))
+				parsedSum += num;
+			line = lineEnd + 1;
+		}
+	report(out, "numbers, parseUnsigned", millisecondsSince(start), lines * passes, "fields");
+	if (sum != parsedSum)
+		out << "  parseUnsigned gives other numbers than operator>>!\n";
+}
+
+/* Runs benchmark named in @options and outputs timings into the stream &out.
+   Returns false if there is no benchmark with such name */
+bool runBenchmark(const Options& options, std::ostream& out) {
+	const String& name = options.benchmark;
+	bool isAll = name == "all";
+	bool isFound = false;
+	if (isAll || name == "parse") {
+		benchmarkParse(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "copy") {
+		benchmarkCopy(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "sort") {
+		benchmarkSort(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "pool") {
+		benchmarkPool(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "group") {
+		benchmarkGroup(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "strings") {
+		benchmarkStrings(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "sharing") {
+		benchmarkSharing(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "shards") {
+		benchmarkShards(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "sketch") {
+		benchmarkSketch(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "normalize") {
+		benchmarkNormalize(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "scan") {
+		benchmarkScan(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "years") {
+		benchmarkYears(options, out);
+		isFound = true;
+	}
+	if (isAll || name == "wal") {
+		benchmarkWal(options, out);
+		isFound = true;
+	}
+	return isFound;
+}
+
+/* Outputs names of available benchmarks into the stream &out */
+void listBenchmarks(std::ostream& out) {
+	out << "Available benchmarks (run with --bench <name>, or --bench all):\n"
+		"  parse      loading a dirty catalog: operator>> with exceptions against BookParser\n"
+		"  copy       copying, assigning and growing arrays of Books and of an integer column\n"
+		"  sort       parallel sort scaling from 1 thread up to --threads, indirect radix sorts\n"
+		"  pool       thread pool reduction and nested parallel loop scaling\n"
+		"  group      parallel group-by of a catalog by sphere, author and year\n"
+		"  normalize  validating and normalizing fields and parsing numbers: per character calls against lookup tables\n"
+		"  scan       scanning integer columns through checked elementAt against unchecked data()\n"
+		"  shards     request throughput of a single server against a coordinator of 1, 2, 4 ... shards\n"
+		"  sketch     summarizing a catalog in sketches while parsing, merging sketches of slices\n"
+		"  sharing    copies of Strings sharing their buffers against duplicating them\n"
+		"  strings    sorting author and title columns: folding every character against sort keys\n"
+		"  years      year range selections and copies per decade: scanning Books against the year index\n"
+		"  wal        availability changes through the log with different commit groups, recovery\n";
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include <iostream>
+
+#include "Options.h"
+
+/* Writes @count synthetic Book records into the stream &out, every record starts with '%'.
+   About @dirtyPercent percent of records are malformed in one of the fields.
+   The same @seed always produces the same catalog */
+void generateCatalog(std::ostream& out, const int count, const int dirtyPercent, const unsigned int seed);
+
+/* Runs benchmark named in @options and outputs timings into the stream &out.
+   Returns false if there is no benchmark with such name */
+bool runBenchmark(const Options& options, std::ostream& out);
+
+/* Outputs names of available benchmarks into the stream &out */
+void listBenchmarks(std::ostream& out);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Book.h"
+#include "BookParser.h"
 #include "Util.h"
 #include "Exception.h"
 
@@ -16,8 +17,6 @@ void copySpheres(String* dest, const String* source, const unsigned int size) {
 Book::Book() {
 	title = '\0';
 	author = '\0';
-	sphereCount = 0;
-	spheres = nullptr;
 	publicationYear = 1970;
 	currentlyAvailable = 0;
 }
@@ -28,7 +27,7 @@ Book::Book(
 	String title = '\0',
 	date_y publicationYear = 1970,
 	unsigned int sphereCount = 0,
-	String* spheres = nullptr,
+	const String* spheres = nullptr,
 	unsigned int currentlyAvailable = 0
 ) {
 	if (!isValidName(author))
@@ -38,38 +37,22 @@ Book::Book(
 	this->publicationYear = publicationYear;
 	if (sphereCount > BOOK_MAX_SPHERE_COUNT || sphereCount == 0)
 		throw Exception("Sphere count exceeds limit or must be at least 1!", 30, "Book.cpp");
-	if (this->sphereCount < sphereCount) {
-		delete[] spheres;
-		spheres = new String[sphereCount];
-	}
-	copySpheres(this->spheres, spheres, sphereCount);
-	this->sphereCount = sphereCount;
+	this->spheres.setSize(sphereCount);
+	copySpheres(this->spheres.get(), spheres, sphereCount);
 	this->currentlyAvailable = currentlyAvailable;
 }
 
 /* Instantiates a copy of the Book @book */
 Book::Book(const Book& book) {
-	if (this == &book)
-		return;
 	author = book.author;
 	title = book.title;
 	publicationYear = book.publicationYear;
-	if (sphereCount < book.sphereCount) {
-		delete[] spheres;
-		spheres = new String[book.sphereCount];
-	}
-	copySpheres(spheres, book.spheres, book.sphereCount);
-	sphereCount = book.sphereCount;
+	spheres = book.spheres;
 	currentlyAvailable = book.currentlyAvailable;
 }
 
 #pragma endregion
 
-Book::~Book() {
-	if (spheres != nullptr)
-		delete[] spheres;
-}
-
 #pragma region Getters
 
 /* Returns this Book's author as a String copy */
@@ -88,12 +71,12 @@ int Book::getPublicationYear() const {
 }
 
 int Book::getSpheresCount() const {
-	return sphereCount;
+	return spheres.getSize();
 }
 
 /* Returns this Book's sphere as a String copy */
 const String* Book::getSpheres() const {
-	return spheres;
+	return spheres.get();
 }
 
 /* Returns this Book's copy amount as an integer */
@@ -126,8 +109,8 @@ void Book::setPublicationYear(const int year) {
 void Book::setSpheres(const String* spheres, const int sphereCount) {
 	if (sphereCount > BOOK_MAX_SPHERE_COUNT || sphereCount <= 0)
 		throw Exception("Sphere count exceeds limit!", 30, "Book.cpp");
-	this->sphereCount = sphereCount;
-	copySpheres(this->spheres, spheres, sphereCount);
+	this->spheres.setSize(sphereCount);
+	copySpheres(this->spheres.get(), spheres, sphereCount);
 }
 
 /* Sets this Book's current copy amount */
@@ -157,14 +140,14 @@ bool operator!=(const Book& b1, const Book& b2) {
    Return the first Book otherwise */
 Book operator-(const Book& b1, const Book& b2) {
 	if (b1 != b2) return b1;
-	return Book(b1.author, b1.title, b1.publicationYear, b1.sphereCount, b1.spheres, b1.currentlyAvailable - b2.currentlyAvailable);
+	return Book(b1.author, b1.title, b1.publicationYear, b1.spheres.getSize(), b1.spheres.get(), b1.currentlyAvailable - b2.currentlyAvailable);
 }
 
 /* Increments the available amount of the first Book, if the Books are the same.
    Return the first Book otherwise */
 Book Book::operator+(const Book& book) const {
 	if (*this != book) return *this;
-	return Book(author, title, publicationYear, sphereCount, spheres, currentlyAvailable + book.currentlyAvailable);
+	return Book(author, title, publicationYear, spheres.getSize(), spheres.get(), currentlyAvailable + book.currentlyAvailable);
 }
 
 /* Returns true if the first Book has less available copies
@@ -186,12 +169,7 @@ Book& Book::operator=(const Book& book) {
 	author = book.author;
 	title = book.title;
 	publicationYear = book.publicationYear;
-	if (sphereCount < book.sphereCount) {
-		delete[] spheres;
-		spheres = new String[book.sphereCount];
-	}
-	copySpheres(spheres, book.spheres, book.sphereCount);
-	sphereCount = book.sphereCount;
+	spheres = book.spheres;
 	currentlyAvailable = book.currentlyAvailable;
 	return *this;
 }
@@ -230,101 +208,96 @@ const Book& Book::operator--() {
 
 /* Outputs information about this Book into the stream &out as table row */
 std::ostream& operator<<(std::ostream& out, const Book& b) {
+	String author = Book::trimToSize(b.author, BOOK_AUTHOR_WIDTH - 1); // -1 to leave space between columns
+	String title = Book::trimToSize(b.title, BOOK_TITLE_WIDTH - 1);
+	String sphere = Book::trimToSize(b.spheres[0], BOOK_SPHERE_WIDTH - 1);
 	out <<
-		std::setw(BOOK_AUTHOR_WIDTH) << Book::trimToSize(b.author, BOOK_AUTHOR_WIDTH - 1) <<
-		std::setw(BOOK_TITLE_WIDTH) << Book::trimToSize(b.title, BOOK_TITLE_WIDTH - 1) << // -1 to leave space between columns
+		std::setw(Util::getColumnWidth(author, BOOK_AUTHOR_WIDTH)) << author <<
+		std::setw(Util::getColumnWidth(title, BOOK_TITLE_WIDTH)) << title <<
 		std::setw(BOOK_YEAR_WIDTH) << b.publicationYear <<
-		std::setw(BOOK_SPHERE_WIDTH) << Book::trimToSize(b.spheres[0], BOOK_SPHERE_WIDTH - 1) <<
+		std::setw(Util::getColumnWidth(sphere, BOOK_SPHERE_WIDTH)) << sphere <<
 		std::setw(BOOK_COUNT_WIDTH) << b.currentlyAvailable << std::endl;
 	return out;
 }
 
+/* Reads the next line of the stream &in into @line of BOOK_PARSER_LINE_SIZE characters without
+   the line break and returns its length. Throws Exception with info @info if it can't be read */
+static int readLine(std::istream& in, char* line, const char* info) {
+	in.getline(line, BOOK_PARSER_LINE_SIZE);
+	if (in.fail())
+		throw Exception("Wrong input stream format!", 174, "Book.cpp", info);
+	// The line break is counted unless the stream ended without it
+	int length = (int)in.gcount() - !in.eof();
+	if (length > 0 && line[length - 1] == '\r')
+		line[--length] = '\0';
+	return length;
+}
+
 /* Reads Book object properties from input stream &in consecutively, each on a separate line
    Throws invalid_argument exception if input format is invalid.*/
 std::istream& operator>>(std::istream& in, Book& b) {
 
-	String line;
+	char line[BOOK_PARSER_LINE_SIZE];
+	unsigned long long num;
 
-	try {
-		getline(in, line);
-	}
-	catch (Exception& e) {
-		e.setInfo("Wrong author name format");
-		throw e;
-	}
-	if (!Book::isValidName(line))
+	int length = Util::normalizeField(line, readLine(in, line, "Wrong author name format"),
+		Util::CharLetter | Util::CharSpace | Util::CharNameMark);
+	if (length < 0)
 		throw Exception("Not a valid name!", 250, "Book.cpp");
-	b.author = line;
-	Util::normalizeString(b.author);
+	b.author.set(line, length);
 
-	try {
-		getline(in, b.title);
-	}
-	catch (Exception& e) {
-		e.setInfo("Wrong title format");
-		throw e;
-	}
-	Util::normalizeString(b.title);
+	length = readLine(in, line, "Wrong title format");
+	b.title.set(line, Util::normalizeField(line, length, Util::CharAny));
 
-	int num;
-	in >> num;
-	if (in.fail() || num < 0 || num > 2020)
+	if (!Util::parseUnsigned(line, readLine(in, line, "Wrong publication year format"), BOOK_MAX_YEAR, num))
 		throw Exception("Wrong input stream format!", 258, "Book.cpp", "Wrong publication year format");
-	b.publicationYear = num;
-	in.ignore(INT_MAX, '\n');
+	b.publicationYear = (date_y)num;
 
-	in >> num;
-	if (in.fail() || num <= 0 || num > BOOK_MAX_SPHERE_COUNT)
+	if (!Util::parseUnsigned(line, readLine(in, line, "Wrong sphere count format"), BOOK_MAX_SPHERE_COUNT, num) || num == 0)
 		throw Exception("Wrong input stream format!", 258, "Book.cpp", "Wrong sphere count format");
-	if (b.sphereCount < num) {
-		delete[] b.spheres;
-		b.spheres = new String[num];
-	}
-	b.sphereCount = num;
-	in.ignore(INT_MAX, '\n');
-
-	for (int i = 0; i < b.sphereCount; ++i) {
-		try {
-			getline(in, line);
-		}
-		catch (Exception& e) {
-			e.setInfo("Wrong sphere format");
-			throw e;
-		}
-		if (!Book::isValidSphere(line))
+	b.spheres.setSize((size_t)num);
+
+	for (int i = 0; i < b.spheres.getSize(); ++i) {
+		length = Util::normalizeField(line, readLine(in, line, "Wrong sphere format"), Util::CharLetter | Util::CharSpace);
+		if (length < 0)
 			throw Exception("Not a valid sphere name", 289, "Book.cpp");
-		b.spheres[i] = line;
-		Util::normalizeString(b.spheres[i]);
+		b.spheres[i].set(line, length);
 	}
 
-	in >> b.currentlyAvailable;
-	if (in.fail())
+	if (!Util::parseUnsigned(line, readLine(in, line, "Wrong book amount format"), UINT_MAX, num))
 		throw Exception("Wrong input stream format!", 237, "Book.cpp", "Wrong book amount format");
-	in.ignore(INT_MAX, '\n');
+	b.currentlyAvailable = (unsigned int)num;
 
 	return in;
 }
 
 bool Book::isValidName(const String& name) {
-	for (int i = 0; i < name.getLength(); ++i)
-		if (!(isalpha(name[i]) || name[i] == ' ' || name[i] == '-' || name[i] == '.'))
-			return false;
-	return true;
+	return isValidName(name.get(), name.getLength());
+}
+
+bool Book::isValidName(const char* name, const int length) {
+	return Util::isValidField(name, length, Util::CharLetter | Util::CharSpace | Util::CharNameMark);
 }
 
 bool Book::isValidSphere(const String& sphere) {
-	for (int i = 0; i < sphere.getLength(); ++i)
-		if (!(isalpha(sphere[i]) || sphere[i] == ' '))
-			return false;
-	return true;
+	return isValidSphere(sphere.get(), sphere.getLength());
+}
+
+bool Book::isValidSphere(const char* sphere, const int length) {
+	return Util::isValidField(sphere, length, Util::CharLetter | Util::CharSpace);
 }
 
 String Book::trimToSize(const String& string, const unsigned int size) {
-	if (string.getLength() < size)
+	if ((unsigned int)Util::countCharacters(string.get(), string.getLength()) < size)
 		return string;
-	char* str = new char[size + 1];
+	// Keeps size - 3 characters, a UTF-8 one takes several bytes
+	int length = 0;
+	for (unsigned int characters = 0; length < string.getLength(); ++length)
+		if (((unsigned char)string[length] & 0xC0) != 0x80 && characters++ == size - 3)
+			break;
+	char* str = new char[length + 4];
 	int i;
-	for (i = 0; i < string.getLength() && i < size - 3; ++i)
+	for (i = 0; i < length; ++i)
 		str[i] = string[i];
 	if (i < string.getLength()) {
 		str[i++] = '.';
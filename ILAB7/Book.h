@@ -1,9 +1,12 @@
 #pragma once
 #include <iomanip>
 
+#include "InlineArray.h"
 #include "String.h"
+#include "TypeTraits.h"
 
 #define BOOK_MAX_SPHERE_COUNT 5
+#define BOOK_MAX_YEAR 2020
 #define BOOK_AUTHOR_WIDTH 25
 #define BOOK_TITLE_WIDTH 50
 #define BOOK_YEAR_WIDTH 7
@@ -17,13 +20,14 @@ class Book {
 	String author;
 	String title;
 	date_y publicationYear;
-	unsigned int sphereCount;
-	String* spheres;
+	InlineArray<String, BOOK_MAX_SPHERE_COUNT> spheres; // Stored inside the Book, no separate allocation
 	unsigned int currentlyAvailable;
 
-	static bool isValidName(const String&); // Returns true if a string could be a valid name (consists of only alphabetic characters or '-')
+	static bool isValidName(const String&); // Returns true if a string could be a valid name (consists of only letters, including UTF-8 ones, spaces, '-' or '.')
+	static bool isValidName(const char*, const int); // Buffer version
 
-	static bool isValidSphere(const String&); // Return true if a string could be a valid sphere name (consists of only alphabetic characters)
+	static bool isValidSphere(const String&); // Return true if a string could be a valid sphere name (consists of only letters, including UTF-8 ones, or spaces)
+	static bool isValidSphere(const char*, const int); // Buffer version
 
 	static String trimToSize(const String&, const unsigned int); // Returns trimmed string to fit in size
 
@@ -32,11 +36,9 @@ public:
 	/* Instantiates a Book with empty fields/default values */
 	Book();
 	/* Instantiates a Book with recieved arguments */
-	Book(String, String, date_y, unsigned int, String*, unsigned int);
+	Book(String, String, date_y, unsigned int, const String*, unsigned int);
 	/* Instantiates a copy of the Book @book */
 	Book(const Book&);
-	/* Destructor cleans up spheres memory */
-	~Book();
 	/* Returns this Book's author as a String copy */
 	String getAuthor() const;
 	/* Returns this Book's title as a String copy */
@@ -106,4 +108,12 @@ public:
 
 	friend void copySpheres(String*, const String*, const unsigned int);
 
+	friend class BookParser;
+	friend class CompactCatalog;
+
+};
+
+/* Book consists of Strings and values stored inline, so it is moved as a block of bytes */
+template<>
+struct IsTriviallyRelocatable<Book> : std::true_type {
 };
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "BookParser.h"
+#include "Util.h"
+
+#include <cctype>
+#include <climits>
+
+/* Instantiates a parser reading from stream &in with Books starting with @delim.
+   @offset is the position of the stream in its file, offsets of statuses count from it */
+BookParser::BookParser(std::istream& in, const char delim, const long long offset) : in(in) {
+	this->delim = delim;
+	this->offset = offset;
+	lineLength = 0;
+	line[0] = '\0';
+}
+
+/* Returns the position reached in the file: starting offset plus bytes consumed from the stream */
+long long BookParser::getOffset() const {
+	return offset;
+}
+
+/* Reads the next line into @line without the line break. Returns false if the stream
+   ended before anything was read or the line didn't fit (rest of it is skipped) */
+bool BookParser::readLine(bool& isTooLong) {
+	isTooLong = false;
+	in.getline(line, BOOK_PARSER_LINE_SIZE);
+	long long read = in.gcount();
+	offset += read;
+	if (in.fail()) {
+		if (read == 0 || in.eof())
+			return false;
+		// Line didn't fit into the buffer
+		isTooLong = true;
+		in.clear();
+		in.ignore(INT_MAX, '\n');
+		offset += in.gcount();
+		return false;
+	}
+	// The line break is counted unless the stream ended without it
+	lineLength = (int)read - !in.eof();
+	if (lineLength > 0 && line[lineLength - 1] == '\r')
+		line[--lineLength] = '\0';
+	return true;
+}
+
+/* Fills @status and returns it */
+ParseStatus BookParser::makeStatus(ParseStatus& status, const ParseCode code, const long long offset, const char* field) const {
+	status.code = code;
+	status.offset = offset;
+	status.field = field;
+	return status;
+}
+
+/* Skips to the next record and parses it into @book. Contents of @book are undefined
+   unless the returned status is Ok */
+ParseStatus BookParser::next(Book& book) {
+	ParseStatus status;
+
+	// Resynchronize on the next record start
+	if (delim != '\n') {
+		in.ignore(INT_MAX, delim);
+		offset += in.gcount();
+	}
+	else while (!in.eof() && in.peek() != EOF && !isalnum(in.peek())) {
+		in.ignore();
+		++offset;
+	}
+	if (in.eof() || in.peek() == EOF)
+		return makeStatus(status, ParseCode::EndOfInput, offset, nullptr);
+
+	long long start = offset;
+	bool isTooLong;
+
+	if (!readLine(isTooLong))
+		return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadAuthor, start, "author");
+	int length = Util::normalizeField(line, lineLength, Util::CharLetter | Util::CharSpace | Util::CharNameMark);
+	if (length < 0)
+		return makeStatus(status, ParseCode::BadAuthor, start, "author");
+	book.author.set(line, length);
+
+	long long fieldStart = offset;
+	if (!readLine(isTooLong))
+		return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadTitle, fieldStart, "title");
+	book.title.set(line, Util::normalizeField(line, lineLength, Util::CharAny));
+
+	unsigned long long num;
+	fieldStart = offset;
+	if (!readLine(isTooLong) || !Util::parseUnsigned(line, lineLength, BOOK_MAX_YEAR, num))
+		return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadYear, fieldStart, "publicationYear");
+	book.publicationYear = (date_y)num;
+
+	fieldStart = offset;
+	if (!readLine(isTooLong) || !Util::parseUnsigned(line, lineLength, BOOK_MAX_SPHERE_COUNT, num) || num == 0)
+		return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadSphereCount, fieldStart, "sphereCount");
+	book.spheres.setSize((size_t)num);
+
+	for (int i = 0; i < book.spheres.getSize(); ++i) {
+		fieldStart = offset;
+		if (!readLine(isTooLong))
+			return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadSphere, fieldStart, "sphere");
+		length = Util::normalizeField(line, lineLength, Util::CharLetter | Util::CharSpace);
+		if (length < 0)
+			return makeStatus(status, ParseCode::BadSphere, fieldStart, "sphere");
+		book.spheres[i].set(line, length);
+	}
+
+	fieldStart = offset;
+	if (!readLine(isTooLong) || !Util::parseUnsigned(line, lineLength, UINT_MAX, num))
+		return makeStatus(status, isTooLong ? ParseCode::LineTooLong : ParseCode::BadAmount, fieldStart, "currentlyAvailable");
+	book.currentlyAvailable = (unsigned int)num;
+
+	return makeStatus(status, ParseCode::Ok, start, nullptr);
+}
+
+/* Returns human readable description of a parse code */
+const char* BookParser::describe(const ParseCode code) {
+	switch (code) {
+	case ParseCode::Ok: return "Ok";
+	case ParseCode::EndOfInput: return "End of input";
+	case ParseCode::BadAuthor: return "Not a valid name";
+	case ParseCode::BadTitle: return "Wrong title format";
+	case ParseCode::BadYear: return "Wrong publication year format";
+	case ParseCode::BadSphereCount: return "Wrong sphere count format";
+	case ParseCode::BadSphere: return "Not a valid sphere name";
+	case ParseCode::BadAmount: return "Wrong book amount format";
+	case ParseCode::LineTooLong: return "Line is too long";
+	}
+	return "Unknown error";
+}
\ No newline at end of file
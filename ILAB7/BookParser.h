@@ -0,0 +1,74 @@
+#pragma once
+#include <iostream>
+
+#include "Book.h"
+
+#define BOOK_PARSER_LINE_SIZE 255
+
+/* Result of parsing a single record */
+enum class ParseCode {
+	Ok,
+	EndOfInput,		// No more records in the stream
+	BadAuthor,
+	BadTitle,
+	BadYear,
+	BadSphereCount,
+	BadSphere,
+	BadAmount,
+	LineTooLong		// Field doesn't fit into BOOK_PARSER_LINE_SIZE characters
+};
+
+/* Status of a parsed record: code, byte offset of the offending field (or of the record
+   start if it was parsed) from the beginning of the stream and its name */
+struct ParseStatus {
+	ParseCode code;
+	long long offset;
+	const char* field;
+
+	/* Returns true if the record was parsed */
+	bool isOk() const {
+		return code == ParseCode::Ok;
+	}
+};
+
+/* Book Parser class - reads Book records from a stream without throwing exceptions.
+   Record layout and validation rules are the same as of operator>>(std::istream&, Book&).
+   Fields are read into a fixed line buffer and stored into a caller-owned scratch Book,
+   which reuses its String buffers, so parsing a stream doesn't allocate memory once
+   the scratch Book has seen the longest fields. After a malformed record the parser
+   is positioned after the offending line and the next call resynchronizes on the
+   delimiter (or the next alphanumeric character when there is no delimiter) */
+class BookParser {
+
+	std::istream& in;
+	char delim;					// Book delimiter, '\n' means none
+	long long offset;			// Bytes consumed from the stream
+	char line[BOOK_PARSER_LINE_SIZE];
+	int lineLength;
+
+	BookParser(const BookParser&); // Copy constructor disabled
+
+	/* Reads the next line into @line without the line break. Returns false if the stream
+	   ended before anything was read or the line didn't fit (rest of it is skipped) */
+	bool readLine(bool& isTooLong);
+
+	/* Fills @status and returns it */
+	ParseStatus makeStatus(ParseStatus& status, const ParseCode code, const long long offset, const char* field) const;
+
+public:
+
+	/* Instantiates a parser reading from stream &in with Books starting with @delim.
+	   @offset is the position of the stream in its file, offsets of statuses count from it */
+	BookParser(std::istream& in, const char delim, const long long offset = 0);
+
+	/* Skips to the next record and parses it into @book. Contents of @book are undefined
+	   unless the returned status is Ok */
+	ParseStatus next(Book& book);
+
+	/* Returns the position reached in the file: starting offset plus bytes consumed from the stream */
+	long long getOffset() const;
+
+	/* Returns human readable description of a parse code */
+	static const char* describe(const ParseCode code);
+
+};
\ No newline at end of file
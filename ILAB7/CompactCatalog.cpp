@@ -0,0 +1,425 @@
+#include "CompactCatalog.h"
+#include "HashMap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <string>
+
+#pragma region Packed Array
+
+/* Instantiates an empty Packed Array */
+PackedArray::PackedArray() {
+	width = count = 0;
+}
+
+/* Allocates @count zero values of @width bits, dropping the previous ones */
+void PackedArray::allocate(const int count, const int width) {
+	this->count = count;
+	this->width = width;
+	// One spare word, so a value crossing the last word boundary is read without a check
+	size_t wordCount = ((unsigned long long)count * width + 63) / 64 + 1;
+	words.clear();
+	words.reserve((int)wordCount);
+	for (size_t i = 0; i < wordCount; ++i)
+		words.add(0);
+}
+
+/* Stores @value (must fit into the width) at index @index */
+void PackedArray::set(const int index, const unsigned long long value) {
+	if (width == 0)
+		return;
+	unsigned long long bit = (unsigned long long)index * width;
+	unsigned long long* word = words.data() + (bit >> 6);
+	int shift = (int)(bit & 63);
+	unsigned long long mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+	word[0] = (word[0] & ~(mask << shift)) | (value & mask) << shift;
+	if (shift + width > 64)
+		word[1] = (word[1] & ~(mask >> (64 - shift))) | (value & mask) >> (64 - shift);
+}
+
+/* Returns the amount of bits every value takes */
+int PackedArray::getWidth() const {
+	return width;
+}
+
+/* Returns memory taken by the values */
+size_t PackedArray::getMemoryUsage() const {
+	return sizeof(PackedArray) + words.getSize() * sizeof(unsigned long long);
+}
+
+/* Returns the amount of bits needed to store @value */
+int PackedArray::bitsOf(unsigned long long value) {
+	int bits = 0;
+	for (; value != 0; value >>= 1)
+		++bits;
+	return bits;
+}
+
+#pragma endregion
+
+#pragma region Patched Array
+
+/* Instantiates an empty Patched Array */
+PatchedArray::PatchedArray() {
+	base = 0;
+}
+
+/* Rebuilds this array from @count @values */
+void PatchedArray::build(const unsigned int* values, const int count) {
+	base = 0xFFFFFFFF;
+	for (int i = 0; i < count; ++i)
+		if (values[i] < base)
+			base = values[i];
+	if (count == 0)
+		base = 0;
+
+	// A value fits @width bits if its distance plus one does, the largest one marks outliers
+	long long fitting[34] = {};
+	for (int i = 0; i < count; ++i)
+		++fitting[PackedArray::bitsOf((unsigned long long)(values[i] - base) + 1)];
+	int width = 33;
+	long long bestBits = (long long)count * width;
+	long long outliers = 0;
+	for (int bits = 32; bits >= 1; --bits) {
+		outliers += fitting[bits + 1];
+		long long total = (long long)count * bits + outliers * (sizeof(int) + sizeof(unsigned int)) * 8;
+		if (total <= bestBits) {
+			bestBits = total;
+			width = bits;
+		}
+	}
+
+	unsigned long long outlier = (1ULL << width) - 1;
+	packed.allocate(count, width);
+	patchIndexes.clear();
+	patchValues.clear();
+	for (int i = 0; i < count; ++i) {
+		unsigned long long distance = values[i] - base;
+		if (distance < outlier)
+			packed.set(i, distance);
+		else {
+			packed.set(i, outlier);
+			patchIndexes.add(i);
+			patchValues.add(values[i]);
+		}
+	}
+}
+
+/* Returns the outlier at index @index */
+unsigned int PatchedArray::getPatch(const int index) const {
+	const int* begin = patchIndexes.begin();
+	const int* found = std::lower_bound(begin, patchIndexes.end(), index);
+	return patchValues[(int)(found - begin)];
+}
+
+/* Returns the amount of bits every value takes */
+int PatchedArray::getWidth() const {
+	return packed.getWidth();
+}
+
+/* Returns the amount of outliers */
+int PatchedArray::getPatchCount() const {
+	return patchIndexes.getSize();
+}
+
+/* Returns memory taken by the values and outliers */
+size_t PatchedArray::getMemoryUsage() const {
+	return sizeof(PatchedArray) - sizeof(PackedArray) + packed.getMemoryUsage()
+		+ patchIndexes.getSize() * (sizeof(int) + sizeof(unsigned int));
+}
+
+#pragma endregion
+
+#pragma region Front Coded Strings
+
+/* Instantiates an empty dictionary */
+FrontCodedStrings::FrontCodedStrings() {
+	count = 0;
+}
+
+/* Appends @value encoded as a variable length number */
+void FrontCodedStrings::putNumber(unsigned int value) {
+	// Seven bits per byte, the high bit tells that more bytes follow
+	while (value >= 0x80) {
+		bytes.add((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	bytes.add((char)value);
+}
+
+/* Returns number encoded at @offset and moves the offset past it */
+unsigned int FrontCodedStrings::getNumber(unsigned int& offset) const {
+	unsigned int value = 0;
+	for (int shift = 0;; shift += 7) {
+		unsigned char byte = (unsigned char)bytes[offset++];
+		value |= (unsigned int)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+			return value;
+	}
+}
+
+/* Rebuilds this dictionary from @count distinct strings @strings in ascending bytewise order */
+void FrontCodedStrings::build(const String* const* strings, const int count) {
+	this->count = count;
+	bytes.clear();
+	blocks.clear();
+	size_t total = 0;
+	for (int i = 0; i < count; ++i)
+		total += strings[i]->getLength();
+	bytes.reserve(total);
+	blocks.reserve(count / FRONT_CODED_BLOCK + 1);
+	for (int i = 0; i < count; ++i) {
+		const char* chars = strings[i]->get();
+		int length = strings[i]->getLength();
+		int shared = 0;
+		if (i % FRONT_CODED_BLOCK == 0)
+			blocks.add(bytes.getSize());
+		else {
+			const char* previous = strings[i - 1]->get();
+			int previousLength = strings[i - 1]->getLength();
+			while (shared < length && shared < previousLength && chars[shared] == previous[shared])
+				++shared;
+			putNumber(shared);
+		}
+		putNumber(length - shared);
+		for (int c = shared; c < length; ++c)
+			bytes.add(chars[c]);
+	}
+}
+
+/* Returns the amount of stored strings */
+int FrontCodedStrings::getSize() const {
+	return count;
+}
+
+/* Copies string number @id into @out */
+void FrontCodedStrings::get(const int id, String& out) const {
+	static thread_local std::string current;
+	unsigned int offset = blocks[id / FRONT_CODED_BLOCK];
+	int first = id - id % FRONT_CODED_BLOCK;
+	for (int i = first; i <= id; ++i) {
+		unsigned int shared = i == first ? 0 : getNumber(offset);
+		unsigned int length = getNumber(offset);
+		current.resize(shared);
+		current.append(bytes.data() + offset, length);
+		offset += length;
+	}
+	out.set(current.data(), (int)current.size());
+}
+
+/* Returns memory taken by the dictionary */
+size_t FrontCodedStrings::getMemoryUsage() const {
+	return sizeof(FrontCodedStrings) + bytes.getSize() + blocks.getSize() * sizeof(unsigned int);
+}
+
+#pragma endregion
+
+#pragma region Compact Catalog
+
+/* Outputs memory per Book of @stats into the stream &out as a single line */
+std::ostream& operator<<(std::ostream& out, const CompactCatalogStats& stats) {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	double books = stats.books > 0 ? stats.books : 1;
+	out << std::fixed << std::setprecision(1) << stats.books << " books in " << stats.getTotal() << " bytes, "
+		<< stats.getTotal() / books << " per book (authors " << stats.authors / books
+		<< ", titles " << stats.titles / books << ", years " << stats.years / books
+		<< ", copies " << stats.amounts / books << ", spheres " << stats.spheres / books
+		<< "), as Books at least " << stats.booksLayout / books << " per book";
+	out.flags(flags);
+	out.precision(precision);
+	return out;
+}
+
+/* Returns memory taken by the whole Compact Catalog */
+size_t CompactCatalogStats::getTotal() const {
+	return authors + titles + years + amounts + spheres;
+}
+
+/* Instantiates an empty catalog */
+CompactCatalog::CompactCatalog() {
+	count = 0;
+	listOffsets.add(0);
+}
+
+/* Replaces strings of @books picked by @fieldOf with ids into @dictionary stored in @ids */
+template<class FieldOf>
+void CompactCatalog::encodeStrings(const ResizableArray<Book>& books, const FieldOf& fieldOf, FrontCodedStrings& dictionary, PackedArray& ids) {
+	// Rows sorted by their strings put equal ones together, ids are ranks of distinct strings.
+	// Sorting mostly compares the first 8 bytes packed big endian, close together in memory
+	struct Entry {
+		unsigned long long prefix;
+		int row;
+	};
+	int count = books.getSize();
+	ResizableArray<const char*> chars(count);
+	Entry* order = new Entry[count > 0 ? count : 1];
+	for (int row = 0; row < count; ++row) {
+		const char* value = fieldOf(books[row]).get();
+		chars.add(value);
+		unsigned long long prefix = 0;
+		int i = 0;
+		for (; i < 8 && value[i]; ++i)
+			prefix = prefix << 8 | (unsigned char)value[i];
+		order[row].prefix = prefix << (8 * (8 - i));
+		order[row].row = row;
+	}
+	const char* const* text = chars.data();
+	std::sort(order, order + count, [text](const Entry& a, const Entry& b) {
+		if (a.prefix != b.prefix)
+			return a.prefix < b.prefix;
+		return std::strcmp(text[a.row], text[b.row]) < 0;
+	});
+
+	ResizableArray<const String*> distinct;
+	for (int i = 0; i < count; ++i)
+		if (i == 0 || std::strcmp(text[order[i - 1].row], text[order[i].row]) != 0)
+			distinct.add(&fieldOf(books[order[i].row]));
+	dictionary.build(distinct.data(), distinct.getSize());
+	ids.allocate(count, PackedArray::bitsOf(distinct.getSize() > 0 ? distinct.getSize() - 1 : 0));
+	int id = -1;
+	for (int i = 0; i < count; ++i) {
+		if (i == 0 || std::strcmp(text[order[i - 1].row], text[order[i].row]) != 0)
+			++id;
+		ids.set(order[i].row, id);
+	}
+	delete[] order;
+}
+
+/* Rebuilds this catalog from the array of Books @books */
+void CompactCatalog::build(const ResizableArray<Book>& books) {
+	count = books.getSize();
+	encodeStrings(books, [](const Book& book) -> const String& { return book.author; }, authors, authorIds);
+	encodeStrings(books, [](const Book& book) -> const String& { return book.title; }, titles, titleIds);
+
+	ResizableArray<unsigned int> values(count);
+	for (const Book& book : books)
+		values.add(book.publicationYear);
+	years.build(values.data(), count);
+	values.clear();
+	for (const Book& book : books)
+		values.add(book.currentlyAvailable);
+	amounts.build(values.data(), count);
+
+	// Books share few distinct lists of spheres, each is stored once
+	HashMap<String, int> sphereIds;
+	HashMap<String, int> lists;
+	ResizableArray<int> rowLists(count);
+	sphereNames.clear();
+	listOffsets.clear();
+	listSpheres.clear();
+	listNames.clear();
+	listOffsets.add(0);
+	String key;
+	for (const Book& book : books) {
+		key = "";
+		for (int i = 0; i < book.getSpheresCount(); ++i) {
+			const String& sphere = book.spheres[i];
+			int* id = sphereIds.find(sphere);
+			if (id == nullptr) {
+				id = &sphereIds[sphere];
+				*id = sphereNames.getSize();
+				sphereNames.add(sphere);
+			}
+			key += String(std::to_string(*id).c_str());
+			key += ',';
+		}
+		int* list = lists.find(key);
+		if (list == nullptr) {
+			list = &lists[key];
+			*list = listOffsets.getSize() - 1;
+			for (int i = 0; i < book.getSpheresCount(); ++i) {
+				listSpheres.add(*sphereIds.find(book.spheres[i]));
+				listNames.add(book.spheres[i]);
+			}
+			listOffsets.add(listSpheres.getSize());
+		}
+		rowLists.add(*list);
+	}
+	int listCount = listOffsets.getSize() - 1;
+	listIds.allocate(count, PackedArray::bitsOf(listCount > 0 ? listCount - 1 : 0));
+	for (int row = 0; row < count; ++row)
+		listIds.set(row, rowLists[row]);
+}
+
+/* Returns the amount of rows */
+int CompactCatalog::getSize() const {
+	return count;
+}
+
+/* Returns the amount of distinct authors */
+int CompactCatalog::getAuthorCount() const {
+	return authors.getSize();
+}
+
+/* Copies author number @id into @out */
+void CompactCatalog::getAuthor(const int id, String& out) const {
+	authors.get(id, out);
+}
+
+/* Returns the amount of spheres of row @row */
+int CompactCatalog::getSpheresCount(const int row) const {
+	int list = (int)listIds.get(row);
+	return listOffsets[list + 1] - listOffsets[list];
+}
+
+/* Returns immutable pointer to sphere ids of row @row */
+const int* CompactCatalog::getSphereIds(const int row) const {
+	return listSpheres.data() + listOffsets[(int)listIds.get(row)];
+}
+
+/* Returns immutable pointer to sphere names of row @row */
+const String* CompactCatalog::getSpheres(const int row) const {
+	return listNames.data() + listOffsets[(int)listIds.get(row)];
+}
+
+/* Returns the amount of distinct spheres */
+int CompactCatalog::getSphereNameCount() const {
+	return sphereNames.getSize();
+}
+
+/* Returns name of sphere @id */
+const String& CompactCatalog::getSphereName(const int id) const {
+	return sphereNames[id];
+}
+
+/* Copies row @row into @book, reusing its buffers */
+void CompactCatalog::decode(const int row, Book& book) const {
+	authors.get((int)authorIds.get(row), book.author);
+	titles.get((int)titleIds.get(row), book.title);
+	book.publicationYear = (date_y)years.get(row);
+	book.currentlyAvailable = amounts.get(row);
+	int sphereCount = getSpheresCount(row);
+	const String* spheres = getSpheres(row);
+	book.spheres.setSize(sphereCount);
+	for (int i = 0; i < sphereCount; ++i)
+		book.spheres[i] = spheres[i];
+}
+
+/* Returns memory taken by the parts of the catalog, compared with the array of Books
+   @books it was built from */
+CompactCatalogStats CompactCatalog::getStats(const ResizableArray<Book>& books) const {
+	CompactCatalogStats stats;
+	stats.books = count;
+	stats.authors = authors.getMemoryUsage() + authorIds.getMemoryUsage();
+	stats.titles = titles.getMemoryUsage() + titleIds.getMemoryUsage();
+	stats.years = years.getMemoryUsage();
+	stats.amounts = amounts.getMemoryUsage();
+	stats.spheres = listIds.getMemoryUsage() + (listOffsets.getSize() + listSpheres.getSize()) * sizeof(int);
+	for (const String& sphere : sphereNames)
+		stats.spheres += sizeof(String) + sphere.getLength() + 1;
+	for (const String& sphere : listNames)
+		stats.spheres += sizeof(String) + sphere.getLength() + 1;
+
+	// Every Book holds its Strings inline, their characters are allocated separately
+	stats.booksLayout = (size_t)books.getSize() * sizeof(Book);
+	for (const Book& book : books) {
+		stats.booksLayout += book.author.getLength() + 1 + book.title.getLength() + 1;
+		for (int i = 0; i < book.getSpheresCount(); ++i)
+			stats.booksLayout += book.spheres[i].getLength() + 1;
+	}
+	return stats;
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,225 @@
+#pragma once
+#include <iostream>
+
+#include "Book.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+#define FRONT_CODED_BLOCK 16		// Strings per front coded block, the first one is stored whole
+
+/* Packed Array class - array of unsigned values all stored in the same amount of bits
+   (0 to 64), packed one after another into 64 bit words */
+class PackedArray {
+
+	ResizableArray<unsigned long long> words;
+	int width;
+	int count;
+
+public:
+
+	/* Instantiates an empty Packed Array */
+	PackedArray();
+
+	/* Allocates @count zero values of @width bits, dropping the previous ones */
+	void allocate(const int count, const int width);
+
+	/* Stores @value (must fit into the width) at index @index */
+	void set(const int index, const unsigned long long value);
+
+	/* Returns value at index @index */
+	unsigned long long get(const int index) const {
+		if (width == 0)
+			return 0;
+		unsigned long long bit = (unsigned long long)index * width;
+		const unsigned long long* word = words.data() + (bit >> 6);
+		int shift = (int)(bit & 63);
+		unsigned long long value = word[0] >> shift;
+		if (shift + width > 64)
+			value |= word[1] << (64 - shift);
+		return width == 64 ? value : value & ((1ULL << width) - 1);
+	}
+
+	/* Returns the amount of bits every value takes */
+	int getWidth() const;
+
+	/* Returns memory taken by the values */
+	size_t getMemoryUsage() const;
+
+	/* Returns the amount of bits needed to store @value */
+	static int bitsOf(unsigned long long value);
+
+};
+
+/* Patched Array class - frame of reference coding of unsigned values: every value is stored
+   as its distance from the smallest one in a width chosen to make the whole array smallest.
+   The few values which don't fit the width (outliers) store the largest value of the width
+   and are looked up in a sorted patch list */
+class PatchedArray {
+
+	unsigned int base;					// Smallest value
+	PackedArray packed;
+	ResizableArray<int> patchIndexes;	// Ascending
+	ResizableArray<unsigned int> patchValues;
+
+public:
+
+	/* Instantiates an empty Patched Array */
+	PatchedArray();
+
+	/* Rebuilds this array from @count @values */
+	void build(const unsigned int* values, const int count);
+
+	/* Returns value at index @index */
+	unsigned int get(const int index) const {
+		unsigned long long value = packed.get(index);
+		if (value + 1 != 1ULL << packed.getWidth())
+			return base + (unsigned int)value;
+		return getPatch(index);
+	}
+
+	/* Returns the outlier at index @index */
+	unsigned int getPatch(const int index) const;
+
+	/* Returns the amount of bits every value takes */
+	int getWidth() const;
+
+	/* Returns the amount of outliers */
+	int getPatchCount() const;
+
+	/* Returns memory taken by the values and outliers */
+	size_t getMemoryUsage() const;
+
+};
+
+/* Front Coded Strings class - immutable dictionary of distinct strings sorted bytewise.
+   Strings are cut into blocks of FRONT_CODED_BLOCK, the first one of a block is stored whole,
+   every next one as the length of the prefix it shares with the previous one and the rest of it.
+   A string is decoded from the start of its block, so access costs up to a block of copying */
+class FrontCodedStrings {
+
+	ResizableArray<char> bytes;
+	ResizableArray<unsigned int> blocks;	// Offset of every block in @bytes
+	int count;
+
+	/* Appends @value encoded as a variable length number */
+	void putNumber(unsigned int value);
+	/* Returns number encoded at @offset and moves the offset past it */
+	unsigned int getNumber(unsigned int& offset) const;
+
+public:
+
+	/* Instantiates an empty dictionary */
+	FrontCodedStrings();
+
+	/* Rebuilds this dictionary from @count distinct strings @strings in ascending bytewise order */
+	void build(const String* const* strings, const int count);
+
+	/* Returns the amount of stored strings */
+	int getSize() const;
+
+	/* Copies string number @id into @out */
+	void get(const int id, String& out) const;
+
+	/* Returns memory taken by the dictionary */
+	size_t getMemoryUsage() const;
+
+};
+
+/* Memory taken by the parts of a Compact Catalog */
+struct CompactCatalogStats {
+	int books = 0;
+	size_t authors = 0;			// Author dictionary and ids
+	size_t titles = 0;			// Title dictionary and ids
+	size_t years = 0;
+	size_t amounts = 0;
+	size_t spheres = 0;			// Sphere names, distinct sphere lists and list ids
+	size_t booksLayout = 0;		// The same Books held in an array of Book objects
+
+	/* Returns memory taken by the whole Compact Catalog */
+	size_t getTotal() const;
+};
+
+/* Compact Catalog class - read only, columnar copy of an array of Books taking a fraction
+   of its memory. Authors and titles are replaced by ids into front coded dictionaries,
+   publication years and available copies are patched bit packed columns and every distinct
+   list of spheres is stored once, Books keep an id of their list. Rows keep the order of
+   the array. Years, copies and spheres of a row are read directly, decode() rebuilds a Book */
+class CompactCatalog {
+
+	int count;
+	FrontCodedStrings authors;
+	FrontCodedStrings titles;
+	PackedArray authorIds;
+	PackedArray titleIds;
+	PatchedArray years;
+	PatchedArray amounts;
+	ResizableArray<String> sphereNames;		// Distinct spheres in the order they were first seen
+	ResizableArray<int> listOffsets;		// Where every distinct sphere list starts in @listSpheres
+	ResizableArray<int> listSpheres;		// Sphere ids of every distinct list one after another
+	ResizableArray<String> listNames;		// The same lists as names, so a row's spheres are contiguous
+	PackedArray listIds;
+
+	CompactCatalog(const CompactCatalog&); // Copy constructor disabled
+
+	/* Replaces strings of @books picked by @fieldOf with ids into @dictionary stored in @ids */
+	template<class FieldOf>
+	void encodeStrings(const ResizableArray<Book>& books, const FieldOf& fieldOf, FrontCodedStrings& dictionary, PackedArray& ids);
+
+public:
+
+	/* Instantiates an empty catalog */
+	CompactCatalog();
+
+	/* Rebuilds this catalog from the array of Books @books */
+	void build(const ResizableArray<Book>& books);
+
+	/* Returns the amount of rows */
+	int getSize() const;
+
+	/* Returns publication year of row @row */
+	int getPublicationYear(const int row) const {
+		return (int)years.get(row);
+	}
+
+	/* Returns available copies of row @row */
+	int getCurrentAmount(const int row) const {
+		return (int)amounts.get(row);
+	}
+
+	/* Returns id of the author of row @row, ids follow bytewise order of the authors */
+	int getAuthorId(const int row) const {
+		return (int)authorIds.get(row);
+	}
+
+	/* Returns the amount of distinct authors */
+	int getAuthorCount() const;
+
+	/* Copies author number @id into @out */
+	void getAuthor(const int id, String& out) const;
+
+	/* Returns the amount of spheres of row @row */
+	int getSpheresCount(const int row) const;
+
+	/* Returns immutable pointer to sphere ids of row @row */
+	const int* getSphereIds(const int row) const;
+
+	/* Returns immutable pointer to sphere names of row @row */
+	const String* getSpheres(const int row) const;
+
+	/* Returns the amount of distinct spheres */
+	int getSphereNameCount() const;
+
+	/* Returns name of sphere @id */
+	const String& getSphereName(const int id) const;
+
+	/* Copies row @row into @book, reusing its buffers */
+	void decode(const int row, Book& book) const;
+
+	/* Returns memory taken by the parts of the catalog, compared with the array of Books
+	   @books it was built from */
+	CompactCatalogStats getStats(const ResizableArray<Book>& books) const;
+
+};
+
+/* Outputs memory per Book of @stats into the stream &out as a single line */
+std::ostream& operator<<(std::ostream& out, const CompactCatalogStats& stats);
\ No newline at end of file
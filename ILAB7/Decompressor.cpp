@@ -0,0 +1,326 @@
+#include "Decompressor.h"
+
+#ifdef ILAB_WITH_ZLIB
+#include <zlib.h>
+#ifdef _WIN32
+#pragma comment(lib, "zlib.lib")
+#endif
+#endif
+#ifdef ILAB_WITH_ZSTD
+#include <zstd.h>
+#ifdef _WIN32
+#pragma comment(lib, "zstd.lib")
+#endif
+#endif
+
+/* Instantiates a buffer over file @path compressed with @compression and starts decompressing */
+DecompressingBuffer::DecompressingBuffer(const char* path, const Compression compression)
+	: file(path, std::ios::in | std::ios::binary) {
+	this->compression = compression;
+	for (int i = 0; i < DECOMPRESSOR_BLOCKS; ++i) {
+		blocks[i].resize(DECOMPRESSOR_BLOCK_SIZE);
+		lengths[i] = 0;
+	}
+	filled = 0;
+	readBlock = -1;
+	writeBlock = 0;
+	pending = 0;
+	isFinished = false;
+	isClosed = false;
+	decompressor = std::thread(&DecompressingBuffer::decompressLoop, this);
+}
+
+/* Destructor stops the decompressor */
+DecompressingBuffer::~DecompressingBuffer() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		isClosed = true;
+	}
+	changed.notify_all();
+	if (decompressor.joinable())
+		decompressor.join();
+}
+
+/* Returns why decompression stopped early, empty if the whole file was read */
+String DecompressingBuffer::getError() {
+	std::lock_guard<std::mutex> guard(lock);
+	return error;
+}
+
+/* Decompresses the file into blocks until its end, an error or the reader closing */
+void DecompressingBuffer::decompressLoop() {
+	char* input = new char[DECOMPRESSOR_INPUT_SIZE];
+	if (!file.is_open()) {
+		std::lock_guard<std::mutex> guard(lock);
+		error = "File can't be opened";
+	}
+	else if (compression == Compression::Gzip)
+		inflateGzip(input);
+	else decompressZstd(input);
+	delete[] input;
+
+	// The last block is usually not full
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (pending > 0 && !isClosed) {
+			lengths[writeBlock] = pending;
+			++filled;
+		}
+		isFinished = true;
+	}
+	changed.notify_all();
+}
+
+/* Hands the block being filled to the reader and waits for a free one.
+   Returns pointer to the free block, nullptr if the reader closed */
+char* DecompressingBuffer::passBlock() {
+	std::unique_lock<std::mutex> guard(lock);
+	lengths[writeBlock] = pending;
+	++filled;
+	writeBlock = (writeBlock + 1) % DECOMPRESSOR_BLOCKS;
+	pending = 0;
+	changed.notify_all();
+	// The block the reader is in stays untouched until it moves on
+	changed.wait(guard, [this]() {
+		return isClosed || filled + (readBlock != -1 ? 1 : 0) < DECOMPRESSOR_BLOCKS;
+	});
+	return isClosed ? nullptr : &blocks[writeBlock][0];
+}
+
+/* Decompresses a gzip file, returns false on error (stored in @error) */
+bool DecompressingBuffer::inflateGzip(char* input) {
+#ifdef ILAB_WITH_ZLIB
+	z_stream stream = z_stream();
+	// Window bits over 32 accept both gzip and zlib headers
+	if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+		std::lock_guard<std::mutex> guard(lock);
+		error = "Can't start gzip decompression";
+		return false;
+	}
+	char* output = &blocks[writeBlock][0];
+	bool isMemberEnd = false;	// The last member ended, more input may start another one
+	bool isDrained = true;		// The last call left room in the output, so it needs more input
+	const char* failure = nullptr;
+	while (output != nullptr) {
+		if (stream.avail_in == 0 && isDrained) {
+			file.read(input, DECOMPRESSOR_INPUT_SIZE);
+			stream.next_in = (Bytef*)input;
+			stream.avail_in = (uInt)file.gcount();
+			if (stream.avail_in == 0) {
+				if (!isMemberEnd)
+					failure = "File is truncated";
+				break;
+			}
+		}
+		stream.next_out = (Bytef*)output + pending;
+		stream.avail_out = (uInt)(DECOMPRESSOR_BLOCK_SIZE - pending);
+		int status = inflate(&stream, Z_NO_FLUSH);
+		if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+			failure = stream.msg != nullptr ? stream.msg : "File is damaged";
+			break;
+		}
+		isDrained = stream.avail_out > 0;
+		pending = DECOMPRESSOR_BLOCK_SIZE - stream.avail_out;
+		if (status == Z_STREAM_END) {
+			inflateReset(&stream);
+			isMemberEnd = true;
+		}
+		else if (status == Z_OK)
+			isMemberEnd = false;
+		if (pending == DECOMPRESSOR_BLOCK_SIZE)
+			output = passBlock();
+	}
+	inflateEnd(&stream);
+	if (failure != nullptr) {
+		std::lock_guard<std::mutex> guard(lock);
+		error = failure;
+		return false;
+	}
+	return true;
+#else
+	std::lock_guard<std::mutex> guard(lock);
+	error = "Built without gzip support (ILAB_WITH_ZLIB)";
+	return false;
+#endif
+}
+
+/* Decompresses a zstd file, returns false on error (stored in @error) */
+bool DecompressingBuffer::decompressZstd(char* input) {
+#ifdef ILAB_WITH_ZSTD
+	ZSTD_DStream* stream = ZSTD_createDStream();
+	if (stream == nullptr || ZSTD_isError(ZSTD_initDStream(stream))) {
+		ZSTD_freeDStream(stream);
+		std::lock_guard<std::mutex> guard(lock);
+		error = "Can't start zstd decompression";
+		return false;
+	}
+	char* output = &blocks[writeBlock][0];
+	ZSTD_inBuffer in = { input, 0, 0 };
+	size_t hint = 0;			// Zero once a frame is complete
+	bool isDrained = true;		// The last call left room in the output, so it needs more input
+	const char* failure = nullptr;
+	while (output != nullptr) {
+		if (in.pos == in.size && isDrained) {
+			file.read(input, DECOMPRESSOR_INPUT_SIZE);
+			in.size = (size_t)file.gcount();
+			in.pos = 0;
+			if (in.size == 0) {
+				if (hint != 0)
+					failure = "File is truncated";
+				break;
+			}
+		}
+		ZSTD_outBuffer out = { output, DECOMPRESSOR_BLOCK_SIZE, pending };
+		hint = ZSTD_decompressStream(stream, &out, &in);
+		if (ZSTD_isError(hint)) {
+			failure = ZSTD_getErrorName(hint);
+			break;
+		}
+		isDrained = out.pos < out.size;
+		pending = out.pos;
+		if (pending == DECOMPRESSOR_BLOCK_SIZE)
+			output = passBlock();
+	}
+	ZSTD_freeDStream(stream);
+	if (failure != nullptr) {
+		std::lock_guard<std::mutex> guard(lock);
+		error = failure;
+		return false;
+	}
+	return true;
+#else
+	std::lock_guard<std::mutex> guard(lock);
+	error = "Built without zstd support (ILAB_WITH_ZSTD)";
+	return false;
+#endif
+}
+
+/* Switches to the next decompressed block, waiting for it if needed */
+DecompressingBuffer::int_type DecompressingBuffer::underflow() {
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+	int next;
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		changed.wait(guard, [this]() {
+			return filled > 0 || isFinished;
+		});
+		if (filled == 0)
+			return traits_type::eof();
+		// Leaving the current block frees it for the decompressor
+		next = (readBlock + 1) % DECOMPRESSOR_BLOCKS;
+		readBlock = next;
+		--filled;
+	}
+	changed.notify_all();
+	char* begin = &blocks[next][0];
+	setg(begin, begin, begin + lengths[next]);
+	return traits_type::to_int_type(*gptr());
+}
+
+/* Instantiates a stream without a file */
+CatalogInput::CatalogInput() : std::istream(nullptr) {
+	compressed = nullptr;
+	compression = Compression::None;
+	isOpened = false;
+}
+
+/* Opens file @path, check is_open() and getError() before and after reading */
+CatalogInput::CatalogInput(const char* path) : CatalogInput() {
+	open(path);
+}
+
+/* Destructor stops decompression of the file */
+CatalogInput::~CatalogInput() {
+	rdbuf(nullptr);
+	delete compressed;
+}
+
+/* Opens file @path unless a file is open already. Returns false if it can't be opened */
+bool CatalogInput::open(const char* path) {
+	if (isOpened)
+		return true;
+	if (plain.open(path, std::ios::in) == nullptr) {
+		setstate(std::ios::failbit);
+		return false;
+	}
+	isOpened = true;
+	compression = detect(path);
+	if (compression == Compression::None) {
+		rdbuf(&plain);
+		return true;
+	}
+	plain.close();
+	if (!isSupported(compression)) {
+		error = "Built without ";
+		error += describe(compression);
+		error += " support";
+		setstate(std::ios::badbit);
+		return true;
+	}
+	compressed = new DecompressingBuffer(path, compression);
+	rdbuf(compressed);
+	return true;
+}
+
+/* Returns true if the file was opened */
+bool CatalogInput::is_open() const {
+	return isOpened;
+}
+
+/* Returns the compression of the file */
+Compression CatalogInput::getCompression() const {
+	return compression;
+}
+
+/* Returns why the file couldn't be read completely, empty if it could */
+String CatalogInput::getError() {
+	if (error.getLength() != 0 || compressed == nullptr)
+		return error;
+	return compressed->getError();
+}
+
+/* Returns the compression of file @path recognized by its magic bytes,
+   None if it isn't compressed or can't be opened */
+Compression CatalogInput::detect(const char* path) {
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	unsigned char magic[4] = { 0, 0, 0, 0 };
+	file.read((char*)magic, sizeof(magic));
+	if (file.gcount() >= 2 && magic[0] == 0x1F && magic[1] == 0x8B)
+		return Compression::Gzip;
+	if (file.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD)
+		return Compression::Zstd;
+	return Compression::None;
+}
+
+/* Returns true if files of @compression can be read by this build */
+bool CatalogInput::isSupported(const Compression compression) {
+	switch (compression) {
+	case Compression::Gzip:
+#ifdef ILAB_WITH_ZLIB
+		return true;
+#else
+		return false;
+#endif
+	case Compression::Zstd:
+#ifdef ILAB_WITH_ZSTD
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return true;
+	}
+}
+
+/* Returns the name of @compression */
+const char* CatalogInput::describe(const Compression compression) {
+	switch (compression) {
+	case Compression::Gzip:
+		return "gzip";
+	case Compression::Zstd:
+		return "zstd";
+	default:
+		return "none";
+	}
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+#include <condition_variable>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "String.h"
+
+// Compressed inputs are read with the system libraries when the build defines
+// ILAB_WITH_ZLIB (gzip, link zlib) and ILAB_WITH_ZSTD (zstd, link libzstd)
+
+#define DECOMPRESSOR_INPUT_SIZE (64 << 10)		// Compressed bytes read from the file at once
+#define DECOMPRESSOR_BLOCK_SIZE (256 << 10)		// Decompressed bytes handed to the reader at once
+#define DECOMPRESSOR_BLOCKS 4					// Blocks decompressed ahead of the reader
+
+/* Compression format of an input file */
+enum class Compression {
+	None,
+	Gzip,
+	Zstd
+};
+
+/* Decompressing Buffer class - stream buffer over a compressed file. A background thread
+   reads the file and decompresses it into a few fixed blocks, while the reader parses the
+   blocks already decompressed, so decompression overlaps with parsing. Concatenated gzip
+   members and zstd frames are read one after another. A damaged or truncated file ends the
+   stream early and leaves an error message */
+class DecompressingBuffer : public std::streambuf {
+
+	std::ifstream file;
+	Compression compression;
+	std::string blocks[DECOMPRESSOR_BLOCKS];	// Ring of decompressed blocks
+	size_t lengths[DECOMPRESSOR_BLOCKS];		// Decompressed bytes in every block
+	int filled;						// Blocks ready for the reader
+	int readBlock;					// Block the reader is in, -1 before the first one
+	int writeBlock;					// Block the decompressor fills
+	size_t pending;					// Bytes decompressed into @writeBlock so far
+	bool isFinished;				// Decompressor stored its last block
+	bool isClosed;					// Reader is gone, decompressor has to stop
+	String error;					// Why decompression stopped early, empty if it didn't
+	std::mutex lock;
+	std::condition_variable changed;
+	std::thread decompressor;
+
+	DecompressingBuffer(const DecompressingBuffer&); // Copy constructor disabled
+
+	/* Decompresses the file into blocks until its end, an error or the reader closing */
+	void decompressLoop();
+	/* Decompresses a gzip file, returns false on error (stored in @error) */
+	bool inflateGzip(char* input);
+	/* Decompresses a zstd file, returns false on error (stored in @error) */
+	bool decompressZstd(char* input);
+	/* Hands the block being filled to the reader and waits for a free one.
+	   Returns pointer to the free block, nullptr if the reader closed */
+	char* passBlock();
+
+protected:
+
+	/* Switches to the next decompressed block, waiting for it if needed */
+	int_type underflow() override;
+
+public:
+
+	/* Instantiates a buffer over file @path compressed with @compression and starts decompressing */
+	DecompressingBuffer(const char* path, const Compression compression);
+	/* Destructor stops the decompressor */
+	~DecompressingBuffer();
+
+	/* Returns why decompression stopped early, empty if the whole file was read */
+	String getError();
+
+};
+
+/* Catalog Input class - input stream over a catalog file, compressed or not. Compression
+   is recognized by the magic bytes at the start of the file, a compressed file is read
+   through a Decompressing Buffer, a plain one through a file buffer */
+class CatalogInput : public std::istream {
+
+	std::filebuf plain;
+	DecompressingBuffer* compressed;
+	Compression compression;
+	bool isOpened;
+	String error;				// Why the file can't be read, besides errors of @compressed
+
+	CatalogInput(const CatalogInput&); // Copy constructor disabled
+
+public:
+
+	/* Instantiates a stream without a file */
+	CatalogInput();
+	/* Opens file @path, check is_open() and getError() before and after reading */
+	CatalogInput(const char* path);
+	/* Destructor stops decompression of the file */
+	~CatalogInput();
+
+	/* Opens file @path unless a file is open already. Returns false if it can't be opened */
+	bool open(const char* path);
+
+	/* Returns true if the file was opened */
+	bool is_open() const;
+
+	/* Returns the compression of the file */
+	Compression getCompression() const;
+
+	/* Returns why the file couldn't be read completely, empty if it could */
+	String getError();
+
+	/* Returns the compression of file @path recognized by its magic bytes,
+	   None if it isn't compressed or can't be opened */
+	static Compression detect(const char* path);
+
+	/* Returns true if files of @compression can be read by this build */
+	static bool isSupported(const Compression compression);
+
+	/* Returns the name of @compression */
+	static const char* describe(const Compression compression);
+
+};
\ No newline at end of file
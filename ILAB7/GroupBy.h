@@ -0,0 +1,121 @@
+#pragma once
+#include "Book.h"
+#include "HashMap.h"
+#include "Pair.h"
+#include "ParallelSort.h"
+#include "ResizableArray.h"
+#include "ThreadPool.h"
+
+/* Compares groups by key, so sorted groups are ordered by key */
+template<class K>
+bool operator>(const Pair<K, int>& p1, const Pair<K, int>& p2) {
+	return p1.getFirst() > p2.getFirst();
+}
+
+/* Count of a single group and where it was first seen: row of the Book in the high
+   32 bits, index of the key among the keys of that Book in the low ones */
+struct GroupCount {
+	int count = 0;
+	long long firstSeen = -1;
+};
+
+/* Group Counter class - counts keys of the Books of a single slice */
+template<class K>
+class GroupCounter {
+
+	HashMap<K, GroupCount> counts;
+	int row;
+	int keyIndex;		// Keys added for the current row so far
+
+	template<class T, class KeysOf>
+	friend void countGroups(const ResizableArray<Book>&, const KeysOf&, ResizableArray<Pair<T, int>>&, ThreadPool&);
+
+public:
+
+	GroupCounter() {
+		row = keyIndex = 0;
+	}
+
+	/* Counts @key for the Book being processed */
+	void add(const K& key) {
+		GroupCount& group = counts[key];
+		if (group.count++ == 0)
+			group.firstSeen = ((long long)row << 32) | keyIndex;
+		++keyIndex;
+	}
+
+};
+
+/* Parallel group-by over Books: counts how many times every key occurs in @books.
+   @keysOf(book, counter) calls counter.add(key) for the keys of a single Book, so one Book
+   may contribute any amount of keys. Every thread of @pool counts its own slice of @books
+   into its own GroupCounter, the partial maps are merged at the end.
+   Fills @groups with (key, count) pairs in order of the first Book having the key,
+   which is the order a sequential scan would find them in */
+template<class K, class KeysOf>
+void countGroups(const ResizableArray<Book>& books, const KeysOf& keysOf, ResizableArray<Pair<K, int>>& groups, ThreadPool& pool = ThreadPool::shared()) {
+	groups.clear();
+	int count = books.getSize();
+	if (count == 0)
+		return;
+	int slices = pool.getThreadCount() < count ? pool.getThreadCount() : count;
+	GroupCounter<K>* partial = new GroupCounter<K>[slices];
+	parallelFor(pool, 0, slices, 1, [&books, &keysOf, partial, slices, count](int from, int to) {
+		for (int s = from; s < to; ++s) {
+			GroupCounter<K>& counter = partial[s];
+			int end = (int)((long long)count * (s + 1) / slices);
+			for (counter.row = (int)((long long)count * s / slices); counter.row < end; ++counter.row) {
+				counter.keyIndex = 0;
+				keysOf(books[counter.row], counter);
+			}
+		}
+	});
+
+	// Slices are merged in row order, so the first occurrence of every group is the earliest one
+	HashMap<K, GroupCount>& total = partial[0].counts;
+	for (int s = 1; s < slices; ++s) {
+		HashMap<K, GroupCount>& counts = partial[s].counts;
+		for (size_t slot = 0; slot < counts.getCapacity(); ++slot)
+			if (counts.isUsed(slot)) {
+				GroupCount& group = total[counts.keyAt(slot)];
+				if (group.count == 0)
+					group.firstSeen = counts.valueAt(slot).firstSeen;
+				group.count += counts.valueAt(slot).count;
+			}
+	}
+
+	ResizableArray<Pair<long long, int>> order(total.getSize());
+	for (size_t slot = 0; slot < total.getCapacity(); ++slot)
+		if (total.isUsed(slot))
+			order.add(makePair(total.valueAt(slot).firstSeen, (int)slot));
+	parallelSort(order, pool);
+	groups.reserve(total.getSize());
+	for (int i = 0; i < order.getSize(); ++i) {
+		size_t slot = order[i].getSecond();
+		groups.add(makePair(total.keyAt(slot), total.valueAt(slot).count));
+	}
+	delete[] partial;
+}
+
+/* Counts Books of every sphere (a Book listing a sphere twice counts twice) */
+inline void countSpheres(const ResizableArray<Book>& books, ResizableArray<Pair<String, int>>& groups, ThreadPool& pool = ThreadPool::shared()) {
+	countGroups(books, [](const Book& book, GroupCounter<String>& counter) {
+		const String* spheres = book.getSpheres();
+		for (int g = 0; g < book.getSpheresCount(); ++g)
+			counter.add(spheres[g]);
+	}, groups, pool);
+}
+
+/* Counts Books of every author */
+inline void countAuthors(const ResizableArray<Book>& books, ResizableArray<Pair<String, int>>& groups, ThreadPool& pool = ThreadPool::shared()) {
+	countGroups(books, [](const Book& book, GroupCounter<String>& counter) {
+		counter.add(book.getAuthor());
+	}, groups, pool);
+}
+
+/* Counts Books published in every year */
+inline void countYears(const ResizableArray<Book>& books, ResizableArray<Pair<int, int>>& groups, ThreadPool& pool = ThreadPool::shared()) {
+	countGroups(books, [](const Book& book, GroupCounter<int>& counter) {
+		counter.add(book.getPublicationYear());
+	}, groups, pool);
+}
\ No newline at end of file
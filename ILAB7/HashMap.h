@@ -0,0 +1,218 @@
+#pragma once
+#include "Util.h"
+
+/* Hash Map class - maps unique keys of type K to values of type V. Uses open addressing
+   with linear probing over a power of two sized table. Key type must be supported by
+   Util::hash and operator== */
+template<class K, class V>
+class HashMap {
+
+	K* keys;
+	V* values;
+	bool* used;
+	size_t filled;
+	size_t capacity;
+	static const size_t initialCapacity = 16;
+
+	/* Returns slot of @key or the first empty slot where it would be placed */
+	size_t findSlot(const K& key) const {
+		size_t mask = capacity - 1;
+		size_t slot = Util::hash(key) & mask;
+		while (used[slot] && !(keys[slot] == key))
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	/* Reallocates the table to hold @newCapacity slots and reinserts all entries */
+	void rehash(const size_t newCapacity) {
+		K* oldKeys = keys;
+		V* oldValues = values;
+		bool* oldUsed = used;
+		size_t oldCapacity = capacity;
+
+		capacity = newCapacity;
+		keys = new K[capacity];
+		values = new V[capacity];
+		used = new bool[capacity];
+		for (size_t i = 0; i < capacity; ++i)
+			used[i] = false;
+
+		for (size_t i = 0; i < oldCapacity; ++i)
+			if (oldUsed[i]) {
+				size_t slot = findSlot(oldKeys[i]);
+				keys[slot] = oldKeys[i];
+				values[slot] = oldValues[i];
+				used[slot] = true;
+			}
+
+		delete[] oldKeys;
+		delete[] oldValues;
+		delete[] oldUsed;
+	}
+
+	/* Allocates an empty table of @capacity slots */
+	void allocate(const size_t capacity) {
+		this->capacity = capacity;
+		filled = 0;
+		keys = new K[capacity];
+		values = new V[capacity];
+		used = new bool[capacity];
+		for (size_t i = 0; i < capacity; ++i)
+			used[i] = false;
+	}
+
+	/* Copies every slot of @map, map must be of the same capacity */
+	void copySlots(const HashMap& map) {
+		filled = map.filled;
+		for (size_t i = 0; i < capacity; ++i) {
+			used[i] = map.used[i];
+			if (used[i]) {
+				keys[i] = map.keys[i];
+				values[i] = map.values[i];
+			}
+		}
+	}
+
+public:
+
+#pragma region Constructors
+
+	/* Instantiates an empty Hash Map */
+	HashMap() {
+		allocate(initialCapacity);
+	}
+
+	/* Instantiates an empty Hash Map able to hold @expected entries without rehashing */
+	HashMap(const size_t expected) {
+		size_t capacity = initialCapacity;
+		while (capacity < expected * 2)
+			capacity *= 2;
+		allocate(capacity);
+	}
+
+	/* Copy constructor */
+	HashMap(const HashMap& map) {
+		allocate(map.capacity);
+		copySlots(map);
+	}
+
+#pragma endregion
+
+	/* Destructor returns allocated memory */
+	~HashMap() {
+		delete[] keys;
+		delete[] values;
+		delete[] used;
+	}
+
+	/* Copies contents of @map into this Hash Map */
+	HashMap& operator=(const HashMap& map) {
+		if (this == &map)
+			return *this;
+		delete[] keys;
+		delete[] values;
+		delete[] used;
+		allocate(map.capacity);
+		copySlots(map);
+		return *this;
+	}
+
+	/* Returns the amount of stored entries */
+	int getSize() const {
+		return filled;
+	}
+
+	/* Returns pointer to the value stored for @key or nullptr if there is none */
+	V* find(const K& key) {
+		size_t slot = findSlot(key);
+		return used[slot] ? &values[slot] : nullptr;
+	}
+
+	/* Immutable version */
+	const V* find(const K& key) const {
+		size_t slot = findSlot(key);
+		return used[slot] ? &values[slot] : nullptr;
+	}
+
+	/* Returns true if @key is present in this Hash Map */
+	bool contains(const K& key) const {
+		return used[findSlot(key)];
+	}
+
+	/* Returns reference to the value stored for @key. Inserts @key with
+	   default constructed value if it is not present */
+	V& operator[](const K& key) {
+		size_t slot = findSlot(key);
+		if (used[slot])
+			return values[slot];
+		if ((filled + 1) * 2 > capacity) {
+			rehash(capacity * 2);
+			slot = findSlot(key);
+		}
+		keys[slot] = key;
+		values[slot] = V();
+		used[slot] = true;
+		++filled;
+		return values[slot];
+	}
+
+	/* Removes the entry of @key. Returns false if there is none */
+	bool remove(const K& key) {
+		size_t mask = capacity - 1;
+		size_t hole = findSlot(key);
+		if (!used[hole])
+			return false;
+		used[hole] = false;
+		--filled;
+		// Entries probed past the hole move back into it, so their lookups don't stop early
+		for (size_t slot = (hole + 1) & mask; used[slot]; slot = (slot + 1) & mask) {
+			size_t home = Util::hash(keys[slot]) & mask;
+			bool isBetween = hole <= slot ? home > hole && home <= slot : home > hole || home <= slot;
+			if (isBetween)
+				continue;
+			keys[hole] = keys[slot];
+			values[hole] = values[slot];
+			used[hole] = true;
+			used[slot] = false;
+			hole = slot;
+		}
+		return true;
+	}
+
+	/* Removes every entry, keeps allocated memory */
+	void clear() {
+		for (size_t i = 0; i < capacity; ++i)
+			used[i] = false;
+		filled = 0;
+	}
+
+#pragma region Slot iteration
+
+	/* Returns the amount of slots in the table, used to iterate over entries */
+	size_t getCapacity() const {
+		return capacity;
+	}
+
+	/* Returns true if slot @slot holds an entry */
+	bool isUsed(const size_t slot) const {
+		return used[slot];
+	}
+
+	/* Returns key stored in slot @slot */
+	const K& keyAt(const size_t slot) const {
+		return keys[slot];
+	}
+
+	/* Returns value stored in slot @slot (mutable) */
+	V& valueAt(const size_t slot) {
+		return values[slot];
+	}
+
+	/* Immutable version */
+	const V& valueAt(const size_t slot) const {
+		return values[slot];
+	}
+
+#pragma endregion
+
+};
\ No newline at end of file
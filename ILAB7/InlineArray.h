@@ -0,0 +1,147 @@
+#pragma once
+#include <new>
+
+#include "Exception.h"
+#include "TypeTraits.h"
+
+/* Template Inline Array class - holds up to N elements of type T inside the object itself.
+   Nothing is ever allocated on the heap by the array, so an object containing it stays
+   a single contiguous block. Elements are constructed only when the array grows into
+   their slot and are kept after shrinking, so their own resources (e.g. String buffers)
+   are reused by later assignments */
+template<class T, size_t N>
+class InlineArray {
+
+	alignas(T) unsigned char storage[sizeof(T) * N];
+	size_t filled;
+	size_t constructed;		// Slots holding a live T, always >= filled
+
+	T* items() {
+		return reinterpret_cast<T*>(storage);
+	}
+
+	const T* items() const {
+		return reinterpret_cast<const T*>(storage);
+	}
+
+	/* Default constructs elements up to @count */
+	void construct(const size_t count) {
+		for (; constructed < count; ++constructed)
+			new (items() + constructed) T();
+	}
+
+public:
+
+	/* Instantiates an empty Inline Array */
+	InlineArray() {
+		filled = constructed = 0;
+	}
+
+	/* Copy constructor, copies only the stored elements */
+	InlineArray(const InlineArray& arr) {
+		filled = constructed = 0;
+		for (; constructed < arr.filled; ++constructed)
+			new (items() + constructed) T(arr.items()[constructed]);
+		filled = arr.filled;
+	}
+
+	/* Copies stored elements of @arr into this Inline Array */
+	InlineArray& operator=(const InlineArray& arr) {
+		if (this == &arr)
+			return *this;
+		size_t i = 0;
+		for (; i < arr.filled && i < constructed; ++i)
+			items()[i] = arr.items()[i];
+		for (; constructed < arr.filled; ++constructed)
+			new (items() + constructed) T(arr.items()[constructed]);
+		filled = arr.filled;
+		return *this;
+	}
+
+	/* Destructor destroys every constructed element */
+	~InlineArray() {
+		for (size_t i = 0; i < constructed; ++i)
+			items()[i].~T();
+	}
+
+	/* Returns the maximum amount of elements this Inline Array can hold */
+	static size_t getCapacity() {
+		return N;
+	}
+
+	/* Returns the amount of currently stored elements */
+	int getSize() const {
+		return (int)filled;
+	}
+
+	/* Returns true if this Inline Array is empty */
+	bool isEmpty() const {
+		return !filled;
+	}
+
+	/* Changes the amount of stored elements to @size, elements which were stored before keep
+	   their previous values, never used ones are default constructed.
+	   Throws Exception if @size exceeds capacity */
+	void setSize(const size_t size) {
+		if (size > N)
+			throw Exception("Size exceeds capacity of InlineArray!", 86, "InlineArray.h");
+		construct(size);
+		filled = size;
+	}
+
+	/* Adds another element of type T at the end of the array.
+	   Throws Exception if the array is full */
+	void add(const T& elem) {
+		if (filled >= N)
+			throw Exception("Size exceeds capacity of InlineArray!", 95, "InlineArray.h");
+		if (filled < constructed)
+			items()[filled] = elem;
+		else new (items() + constructed++) T(elem);
+		++filled;
+	}
+
+	/* Removes all elements */
+	void clear() {
+		filled = 0;
+	}
+
+	/* Returns pointer to the first element (mutable) */
+	T* get() {
+		return items();
+	}
+
+	/* Immutable version */
+	const T* get() const {
+		return items();
+	}
+
+	/* Return element at @index by reference (mutable) */
+	T& elementAt(const int index) {
+		if (index < 0 || index >= (int)filled)
+			throw Exception("Index out of range in InlineArray!", 120, "InlineArray.h");
+		return items()[index];
+	}
+
+	/* Immutable version */
+	const T& elementAt(const int index) const {
+		if (index < 0 || index >= (int)filled)
+			throw Exception("Index out of range in InlineArray!", 127, "InlineArray.h");
+		return items()[index];
+	}
+
+	/* Return element at @index by reference (mutable) */
+	T& operator[](const int index) {
+		return elementAt(index);
+	}
+
+	/* Immutable version */
+	const T& operator[](const int index) const {
+		return elementAt(index);
+	}
+
+};
+
+/* Elements are stored inside the Inline Array, which is relocatable whenever they are */
+template<class T, size_t N>
+struct IsTriviallyRelocatable<InlineArray<T, N>> : IsTriviallyRelocatable<T> {
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "LoadGenerator.h"
+#include "ParallelSort.h"
+#include "QueryServer.h"
+#include "ResizableArray.h"
+#include "Socket.h"
+#include "String.h"
+#include "Util.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+static const char* defaultRequests[] = {
+	"PING", "BEST", "TOP 10", "COUNT Programming OR History", "SPHERE Philosophy",
+	"QUERY Fiction AND YEAR 1990-2005", "TOP 5 NOT Fiction", "COUNT YEAR 2000-"
+};
+
+/* Adds the default mix of requests, used when there is no query file, to @requests */
+void addDefaultRequests(ResizableArray<String>& requests) {
+	for (int i = 0; i < (int)(sizeof(defaultRequests) / sizeof(defaultRequests[0])); ++i)
+		requests.add(defaultRequests[i]);
+}
+
+/* Sends @count requests from @requests (cycling, starting at @offset) over a new connection to
+   @port, keeping up to @pipeline in flight. Stores latency of every request in microseconds
+   into @latencies. Returns false if the connection failed */
+static bool runConnection(const int port, const ResizableArray<String>& requests, const int offset, const int count,
+	const int pipeline, double* latencies) {
+	socket_t socket = Net::connectLocal(port);
+	if (socket == NET_INVALID_SOCKET)
+		return false;
+	Net::LineReader reader(socket);
+	std::chrono::steady_clock::time_point* sent = new std::chrono::steady_clock::time_point[pipeline];
+	std::string batch, line;
+	int sentCount = 0, receivedCount = 0;
+	bool isOk = true;
+	while (receivedCount < count && isOk) {
+		// Top up the pipeline, then wait for the oldest response
+		batch.clear();
+		int first = sentCount;
+		while (sentCount < count && sentCount - receivedCount < pipeline) {
+			batch += requests[(offset + sentCount) % requests.getSize()].get();
+			batch += '\n';
+			++sentCount;
+		}
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		for (int i = first; i < sentCount; ++i)
+			sent[i % pipeline] = now;
+		if (!batch.empty() && !Net::sendAll(socket, batch.data(), (int)batch.size()))
+			isOk = false;
+		else if (!readResponse(reader, line))
+			isOk = false;
+		else {
+			std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - sent[receivedCount % pipeline];
+			latencies[receivedCount++] = elapsed.count();
+		}
+	}
+	delete[] sent;
+	Net::close(socket);
+	return isOk;
+}
+
+/* Returns requests answered per second */
+double LoadResult::getQps() const {
+	return milliseconds > 0 ? requests * 1000.0 / milliseconds : 0;
+}
+
+/* Sends @perConnection requests (cycling through @requests) over each of @connections connections
+   to a QueryServer on localhost:@port, keeping up to @pipeline of them in flight per connection */
+LoadResult generateLoad(const int port, const ResizableArray<String>& requests, const int connections,
+	const int perConnection, const int pipeline) {
+	LoadResult result;
+	double* latencies = new double[(long long)connections * perConnection];
+	std::atomic<int> failed(0);
+	std::thread* clients = new std::thread[connections];
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int c = 0; c < connections; ++c)
+		clients[c] = std::thread([&, c]() {
+			if (!runConnection(port, requests, c, perConnection, pipeline, latencies + (long long)c * perConnection))
+				++failed;
+		});
+	for (int c = 0; c < connections; ++c)
+		clients[c].join();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	delete[] clients;
+
+	result.failedConnections = failed;
+	if (failed == 0) {
+		int total = connections * perConnection;
+		parallelSort(latencies, total);
+		result.requests = total;
+		result.milliseconds = elapsed.count();
+		result.p50 = latencies[total / 2];
+		result.p99 = latencies[(long long)total * 99 / 100];
+		result.max = latencies[total - 1];
+	}
+	delete[] latencies;
+	return result;
+}
+
+/* Runs the load generator described by @options against a QueryServer on localhost:
+   @options.connections connections each send @options.requests requests keeping up to
+   @options.pipeline of them in flight. Requests are lines of @options.queryFile (a default
+   mix when there is none). Outputs QPS and p50/p99 latencies into the stream &out.
+   Returns false if the server can't be reached */
+bool runLoadGenerator(const Options& options, std::ostream& out) {
+	if (!Net::startup())
+		return false;
+	ResizableArray<String> requests;
+	if (options.queryFile.getLength() != 0) {
+		std::ifstream fin(options.queryFile.get());
+		String line;
+		while (fin.peek() != EOF) {
+			try {
+				getline(fin, line);
+			}
+			catch (...) {
+				break;
+			}
+			Util::trim(line);
+			if (line.getLength() != 0)
+				requests.add(line);
+		}
+	}
+	if (requests.isEmpty())
+		addDefaultRequests(requests);
+
+	LoadResult result = generateLoad(options.loadPort, requests, options.loadConnections, options.loadRequests, options.loadPipeline);
+	if (result.failedConnections > 0) {
+		out << result.failedConnections << " of " << options.loadConnections << " connections to port " << options.loadPort << " failed\n";
+		return false;
+	}
+
+	out << std::fixed << std::setprecision(1)
+		<< "requests: " << result.requests << " over " << options.loadConnections << " connections, pipeline " << options.loadPipeline << '\n'
+		<< "time:     " << result.milliseconds << " ms\n"
+		<< "qps:      " << (long long)result.getQps() << '\n'
+		<< "latency:  p50 " << result.p50 << " us, p99 " << result.p99
+		<< " us, max " << result.max << " us\n";
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include <iostream>
+
+#include "Options.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+/* Throughput and latencies of a load generator run */
+struct LoadResult {
+	int requests = 0;				// Answered requests, 0 if a connection failed
+	double milliseconds = 0;
+	double p50 = 0;					// Latencies in microseconds
+	double p99 = 0;
+	double max = 0;
+	int failedConnections = 0;
+
+	/* Returns requests answered per second */
+	double getQps() const;
+};
+
+/* Adds the default mix of requests, used when there is no query file, to @requests */
+void addDefaultRequests(ResizableArray<String>& requests);
+
+/* Sends @perConnection requests (cycling through @requests) over each of @connections connections
+   to a QueryServer on localhost:@port, keeping up to @pipeline of them in flight per connection */
+LoadResult generateLoad(const int port, const ResizableArray<String>& requests, const int connections,
+	const int perConnection, const int pipeline);
+
+/* Runs the load generator described by @options against a QueryServer on localhost:
+   @options.connections connections each send @options.requests requests keeping up to
+   @options.pipeline of them in flight. Requests are lines of @options.queryFile (a default
+   mix when there is none). Outputs QPS and p50/p99 latencies into the stream &out.
+   Returns false if the server can't be reached */
+bool runLoadGenerator(const Options& options, std::ostream& out);
\ No newline at end of file
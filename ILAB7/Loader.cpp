@@ -0,0 +1,201 @@
+#include "Loader.h"
+#include "Sketches.h"
+#include "Util.h"
+
+#include <fstream>
+#include <sstream>
+
+/* Formats exception @e as "message: info" line */
+String describeException(const Exception& e) {
+	String description = e.getMsg();
+	if (e.getInfo() != nullptr && *e.getInfo()) {
+		description += ": ";
+		description += e.getInfo();
+	}
+	return description;
+}
+
+/* Formats parse status @status as "message (field at byte offset)" line */
+String describeStatus(const ParseStatus& status) {
+	std::ostringstream description;
+	description << BookParser::describe(status.code);
+	if (status.field != nullptr)
+		description << " (" << status.field << " at byte " << status.offset << ")";
+	return description.str().c_str();
+}
+
+/* Asks the user on the console whether reading should go on after a malformed record */
+static bool askToContinue() {
+	char yn;
+	do {
+		std::cout << "Continue reading file? (more exceptions may pop up if delimiter is not set) (y/n): ";
+		std::cin.clear();
+		std::cin >> yn;
+	} while (std::cin.fail() || (yn != 'y' && yn != 'n'));
+	return yn == 'y';
+}
+
+/* Handles malformed record number @record of @source with parse @status according to @policy.
+   Returns false if reading has to stop */
+static bool handleMalformed(const ParseStatus& status, const ErrorPolicy policy, LoadReport& report, const char* source, const int record) {
+	++report.failed;
+	switch (policy) {
+	case ErrorPolicy::Ask:
+		std::cerr << describeStatus(status) << std::endl;
+		if (!askToContinue()) {
+			report.aborted = true;
+			return false;
+		}
+		break;
+	case ErrorPolicy::Abort:
+		std::cerr << source << ": record " << record << ": " << describeStatus(status) << std::endl;
+		report.aborted = true;
+		return false;
+	case ErrorPolicy::Collect: {
+		std::ostringstream message;
+		message << source << ": record " << record << ": " << describeStatus(status);
+		report.errors.add(message.str().c_str());
+		break;
+	}
+	case ErrorPolicy::Skip:
+		break;
+	}
+	return true;
+}
+
+/* Reads Books from stream &in into @books until the end of the stream. Every Book starts
+   with @delim ('\n' means no delimiter, records start at the next alphanumeric character).
+   Malformed records are handled according to @policy without throwing exceptions,
+   @source names the stream in collected error messages. Returns false if reading was aborted */
+bool loadBooks(
+	std::istream& in,
+	ResizableArray<Book>& books,
+	const char delim,
+	const ErrorPolicy policy,
+	LoadReport& report,
+	const char* source
+) {
+	int record = 0;
+	Book book = Book();
+	BookParser parser(in, delim);
+	ParseStatus status;
+	while ((status = parser.next(book)).code != ParseCode::EndOfInput) {
+
+		++record;
+		if (status.isOk()) {
+			books.add(book);
+			++report.loaded;
+			continue;
+		}
+
+		if (!handleMalformed(status, policy, report, source, record))
+			return false;
+	}
+	return true;
+}
+
+/* Reads Books from stream &in like loadBooks, but only adds every one to @sketch without
+   keeping it, so memory doesn't grow with the stream. Returns false if reading was aborted */
+bool sketchBooks(
+	std::istream& in,
+	CatalogSketch& sketch,
+	const char delim,
+	const ErrorPolicy policy,
+	LoadReport& report,
+	const char* source
+) {
+	int record = 0;
+	Book book = Book();
+	BookParser parser(in, delim);
+	ParseStatus status;
+	while ((status = parser.next(book)).code != ParseCode::EndOfInput) {
+
+		++record;
+		if (status.isOk()) {
+			sketch.add(book);
+			++report.loaded;
+			continue;
+		}
+
+		if (!handleMalformed(status, policy, report, source, record))
+			return false;
+	}
+	return true;
+}
+
+/* Instantiates a tail of catalog file @path with Books starting with @delim,
+   malformed records are handled according to @policy (Ask is treated as Skip) */
+CatalogTail::CatalogTail(const String& path, const char delim, const ErrorPolicy policy) : path(path) {
+	this->delim = delim;
+	this->policy = policy == ErrorPolicy::Ask ? ErrorPolicy::Skip : policy;
+	reset();
+}
+
+/* Forgets the reached offset, the next poll reads the file from the start */
+void CatalogTail::reset() {
+	offset = 0;
+	fingerprint = 0;
+	record = 0;
+}
+
+/* Returns the position past the last complete record read */
+long long CatalogTail::getOffset() const {
+	return offset;
+}
+
+/* Returns path of the followed file */
+const String& CatalogTail::getPath() const {
+	return path;
+}
+
+/* Returns hash of up to CATALOG_TAIL_FINGERPRINT bytes at the start of stream &in and as many
+   before @end, so both a replaced file and a rewritten tail change it */
+unsigned int CatalogTail::fingerprintOf(std::istream& in, const long long end) {
+	char bytes[CATALOG_TAIL_FINGERPRINT * 2];
+	long long headEnd = end < CATALOG_TAIL_FINGERPRINT ? end : CATALOG_TAIL_FINGERPRINT;
+	long long tailStart = end - CATALOG_TAIL_FINGERPRINT > headEnd ? end - CATALOG_TAIL_FINGERPRINT : headEnd;
+	in.clear();
+	in.seekg(0);
+	in.read(bytes, headEnd);
+	in.seekg(tailStart);
+	in.read(bytes + headEnd, end - tailStart);
+	return Util::hash(bytes, (int)(headEnd + end - tailStart));
+}
+
+/* Reads records appended to the file since the last poll (the whole file on the first one)
+   and adds them to @books */
+TailStatus CatalogTail::poll(ResizableArray<Book>& books, LoadReport& report) {
+	// Binary mode, so offsets are file positions on every platform
+	std::ifstream in(path.get(), std::ios::binary);
+	if (!in.is_open())
+		return TailStatus::Unreadable;
+	in.seekg(0, std::ios::end);
+	long long size = (long long)in.tellg();
+	if (size < offset || (offset > 0 && fingerprintOf(in, offset) != fingerprint))
+		return TailStatus::Rewritten;
+	if (size == offset)
+		return TailStatus::Ok;
+
+	in.clear();
+	in.seekg(offset);
+	Book book = Book();
+	BookParser parser(in, delim, offset);
+	ParseStatus status;
+	while ((status = parser.next(book)).code != ParseCode::EndOfInput) {
+		// The file ended inside this record, it may still be being written
+		if (in.eof())
+			break;
+		offset = parser.getOffset();
+		++record;
+		if (status.isOk()) {
+			books.add(book);
+			++report.loaded;
+		}
+		else if (!handleMalformed(status, policy, report, path.get(), record)) {
+			fingerprint = fingerprintOf(in, offset);
+			return TailStatus::Aborted;
+		}
+	}
+	fingerprint = fingerprintOf(in, offset);
+	return TailStatus::Ok;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+#include <iostream>
+
+#include "Book.h"
+#include "BookParser.h"
+#include "Exception.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+class CatalogSketch;
+
+/* What to do when a record of the input file can't be read */
+enum class ErrorPolicy {
+	Ask,		// Ask the user on the console whether to continue
+	Skip,		// Skip the record and continue silently
+	Abort,		// Stop reading at the first malformed record
+	Collect		// Skip the record and remember the error message
+};
+
+/* Summary of a single load: amounts of read and malformed records and collected errors */
+struct LoadReport {
+	int loaded = 0;
+	int failed = 0;
+	bool aborted = false;
+	ResizableArray<String> errors;
+};
+
+/* Reads Books from stream &in into @books until the end of the stream. Every Book starts
+   with @delim ('\n' means no delimiter, records start at the next alphanumeric character).
+   Malformed records are handled according to @policy without throwing exceptions,
+   @source names the stream in collected error messages. Returns false if reading was aborted */
+bool loadBooks(
+	std::istream& in,
+	ResizableArray<Book>& books,
+	const char delim,
+	const ErrorPolicy policy,
+	LoadReport& report,
+	const char* source = "input"
+);
+
+/* Reads Books from stream &in like loadBooks, but only adds every one to @sketch without
+   keeping it, so memory doesn't grow with the stream. Returns false if reading was aborted */
+bool sketchBooks(
+	std::istream& in,
+	CatalogSketch& sketch,
+	const char delim,
+	const ErrorPolicy policy,
+	LoadReport& report,
+	const char* source = "input"
+);
+
+#define CATALOG_TAIL_FINGERPRINT 64	// Bytes at the start and before the reached offset checked for rewrites
+
+/* Result of reading the appended part of a catalog file */
+enum class TailStatus {
+	Ok,			// Appended records (if any) were read
+	Rewritten,	// The file was truncated or changed before the reached offset, nothing was read
+	Unreadable,	// The file can't be opened
+	Aborted		// A malformed record stopped reading (Abort policy)
+};
+
+/* Catalog Tail class - reads a catalog file that is only appended to incrementally.
+   Remembers the offset past the last complete record and on every poll parses only the
+   bytes appended since then, with the same delimiter and resynchronization rules as
+   loadBooks, so the books read over many polls are the ones a single load would read.
+   A record counts as complete once its last line is terminated: a record cut by the end
+   of the file is read again on the next poll. A file changed before the remembered
+   offset (rewritten or truncated) is reported, the caller reloads it from scratch */
+class CatalogTail {
+
+	String path;
+	char delim;
+	ErrorPolicy policy;
+	long long offset;			// Position past the last complete record
+	unsigned int fingerprint;	// Hash of the bytes at the start and before @offset
+	int record;					// Records read so far, numbers records in messages
+
+	/* Returns hash of up to CATALOG_TAIL_FINGERPRINT bytes at the start of stream &in and as many
+	   before @end, so both a replaced file and a rewritten tail change it */
+	static unsigned int fingerprintOf(std::istream& in, const long long end);
+
+public:
+
+	/* Instantiates a tail of catalog file @path with Books starting with @delim,
+	   malformed records are handled according to @policy (Ask is treated as Skip) */
+	CatalogTail(const String& path, const char delim, const ErrorPolicy policy);
+
+	/* Reads records appended to the file since the last poll (the whole file on the first one)
+	   and adds them to @books */
+	TailStatus poll(ResizableArray<Book>& books, LoadReport& report);
+
+	/* Forgets the reached offset, the next poll reads the file from the start */
+	void reset();
+
+	/* Returns the position past the last complete record read */
+	long long getOffset() const;
+
+	/* Returns path of the followed file */
+	const String& getPath() const;
+
+};
+
+/* Formats exception @e as "message: info" line */
+String describeException(const Exception& e);
+
+/* Formats parse status @status as "message (field at byte offset)" line */
+String describeStatus(const ParseStatus& status);
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "Options.h"
+#include "Exception.h"
+#include "ShardCoordinator.h"
+#include "Util.h"
+
+#include <cctype>
+#include <climits>
+
+/* Returns true if @arg equals either of the names @shortName or @longName */
+static bool isOption(const char* arg, const char* shortName, const char* longName) {
+	String option = arg;
+	return option == shortName || option == longName;
+}
+
+/* Returns the value following option at @i and moves @i past it.
+   Throws Exception if there is no value */
+static const char* takeValue(int argc, char** argv, int& i) {
+	if (i + 1 >= argc)
+		throw Exception("Invalid command line!", 16, "Options.cpp", "Option requires a value");
+	return argv[++i];
+}
+
+/* Returns the number following option at @i and moves @i past it.
+   Throws Exception if there is no value or it is out of [@min, @max] */
+static int takeNumber(int argc, char** argv, int& i, const int min, const int max) {
+	const char* value = takeValue(argc, argv, i);
+	long long number = 0;
+	int c = 0;
+	for (; isdigit(value[c]) && number <= max; ++c)
+		number = number * 10 + (value[c] - '0');
+	if (c == 0 || value[c] != '\0' || number < min || number > max)
+		throw Exception("Invalid command line!", 28, "Options.cpp", "Option requires a number in allowed range");
+	return (int)number;
+}
+
+/* Adds the numbers following option at @i, separated by @separator, to @numbers and moves @i past them.
+   Throws Exception if there is no value or a number is out of [@min, @max] */
+static void takeNumbers(int argc, char** argv, int& i, const char separator, const int min, const int max,
+	ResizableArray<int>& numbers) {
+	const char* value = takeValue(argc, argv, i);
+	int c = 0;
+	do {
+		long long number = 0;
+		int start = c;
+		for (; isdigit(value[c]) && number <= max; ++c)
+			number = number * 10 + (value[c] - '0');
+		if (c == start || (value[c] != '\0' && value[c] != separator) || number < min || number > max)
+			throw Exception("Invalid command line!", 45, "Options.cpp", "Option requires separated numbers in allowed range");
+		numbers.add((int)number);
+	} while (value[c++] != '\0');
+}
+
+/* Returns true if the program was started with any command line arguments,
+   which means it should run in batch mode */
+bool isBatchMode(int argc, char** argv) {
+	return argc > 1;
+}
+
+/* Parses command line arguments into @options.
+   Throws Exception describing the problem if arguments are invalid */
+void parseOptions(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		if (isOption(arg, "-h", "--help"))
+			options.showHelp = true;
+		else if (isOption(arg, "-i", "--input"))
+			options.inputs.add(takeValue(argc, argv, i));
+		else if (isOption(arg, "-d", "--delimiter")) {
+			const char* value = takeValue(argc, argv, i);
+			if (Util::strlen(value) != 1 || isalnum(*value))
+				throw Exception("Invalid command line!", 37, "Options.cpp", "Delimiter must be a single non alphanumeric character");
+			options.delimiter = *value;
+		}
+		else if (isOption(arg, "-e", "--errors")) {
+			String value = takeValue(argc, argv, i);
+			if (value == "skip")
+				options.errorPolicy = ErrorPolicy::Skip;
+			else if (value == "abort")
+				options.errorPolicy = ErrorPolicy::Abort;
+			else if (value == "collect")
+				options.errorPolicy = ErrorPolicy::Collect;
+			else throw Exception("Invalid command line!", 49, "Options.cpp", "Error policy must be skip, abort or collect");
+		}
+		else if (isOption(arg, "-o", "--output"))
+			options.outputDirectory = takeValue(argc, argv, i);
+		else if (isOption(arg, "-q", "--queries"))
+			options.queryFile = takeValue(argc, argv, i);
+		else if (isOption(arg, "-t", "--threads"))
+			options.threads = takeNumber(argc, argv, i, 0, 1024);
+		else if (isOption(arg, "-s", "--sort")) {
+			String value = takeValue(argc, argv, i);
+			if (value == "count")
+				options.sortMode = SortMode::Count;
+			else if (value == "count-year")
+				options.sortMode = SortMode::CountYear;
+			else if (value == "merge")
+				options.sortMode = SortMode::Merge;
+			else throw Exception("Invalid command line!", 72, "Options.cpp", "Sort must be count, count-year or merge");
+		}
+		else if (isOption(arg, "-b", "--bench"))
+			options.benchmark = takeValue(argc, argv, i);
+		else if (String(arg) == "--books")
+			options.benchmarkBooks = takeNumber(argc, argv, i, 1, INT_MAX);
+		else if (String(arg) == "--dirty")
+			options.benchmarkDirtyPercent = takeNumber(argc, argv, i, 0, 100);
+		else if (isOption(arg, "-j", "--journal"))
+			options.journalDirectory = takeValue(argc, argv, i);
+		else if (String(arg) == "--commit-every")
+			options.commitEvery = takeNumber(argc, argv, i, 1, 1000000);
+		else if (String(arg) == "--snapshot-every")
+			options.snapshotEvery = takeNumber(argc, argv, i, 0, INT_MAX);
+		else if (isOption(arg, "-c", "--changes"))
+			options.changesFile = takeValue(argc, argv, i);
+		else if (String(arg) == "--serve")
+			options.servePort = takeNumber(argc, argv, i, 0, 65535);
+		else if (isOption(arg, "-f", "--follow"))
+			options.followInterval = takeNumber(argc, argv, i, 0, INT_MAX);
+		else if (String(arg) == "--loadgen")
+			options.loadPort = takeNumber(argc, argv, i, 1, 65535);
+		else if (String(arg) == "--connections")
+			options.loadConnections = takeNumber(argc, argv, i, 1, 1024);
+		else if (String(arg) == "--requests")
+			options.loadRequests = takeNumber(argc, argv, i, 1, 10000000);
+		else if (String(arg) == "--pipeline")
+			options.loadPipeline = takeNumber(argc, argv, i, 1, 1024);
+		else if (String(arg) == "--compact")
+			options.compact = true;
+		else if (String(arg) == "--sketch")
+			options.sketch = true;
+		else if (String(arg) == "--shard") {
+			ResizableArray<int> numbers;
+			takeNumbers(argc, argv, i, '/', 0, SHARD_MAX_COUNT, numbers);
+			if (numbers.getSize() != 2 || numbers[1] == 0 || numbers[0] >= numbers[1])
+				throw Exception("Invalid command line!", 130, "Options.cpp", "Shard must be <shard>/<shards> with shard below shards");
+			options.shard = numbers[0];
+			options.shardCount = numbers[1];
+		}
+		else if (String(arg) == "--shards") {
+			options.shardPorts.clear();
+			takeNumbers(argc, argv, i, ',', 1, 65535, options.shardPorts);
+			if (options.shardPorts.getSize() > SHARD_MAX_COUNT)
+				throw Exception("Invalid command line!", 138, "Options.cpp", "Too many shards");
+		}
+		else if (*arg != '-')
+			options.inputs.add(arg);
+		else throw Exception("Invalid command line!", 58, "Options.cpp", "Unknown option");
+	}
+	if (options.changesFile.getLength() != 0 && options.journalDirectory.getLength() == 0)
+		throw Exception("Invalid command line!", 96, "Options.cpp", "Changes require a journal directory");
+	if (options.compact && (options.servePort >= 0 || options.queryFile.getLength() != 0))
+		throw Exception("Invalid command line!", 98, "Options.cpp", "Compact catalog only writes reports, it can't serve or answer queries");
+	if (options.sketch && (options.servePort >= 0 || options.queryFile.getLength() != 0 || options.compact
+		|| options.journalDirectory.getLength() != 0))
+		throw Exception("Invalid command line!", 153, "Options.cpp", "Sketches keep no books, they can't serve, answer queries or keep a journal");
+	if (options.shard >= 0 && (options.servePort < 0 || options.followInterval >= 0 || options.journalDirectory.getLength() != 0))
+		throw Exception("Invalid command line!", 150, "Options.cpp", "A shard only serves its part of the catalog, it can't follow inputs or keep a journal");
+	if (!options.shardPorts.isEmpty() && (options.servePort < 0 || !options.inputs.isEmpty() || options.shard >= 0))
+		throw Exception("Invalid command line!", 152, "Options.cpp", "Coordinating shards requires --serve and no input files");
+	if (options.inputs.isEmpty() && !options.showHelp && options.benchmark.getLength() == 0 && options.loadPort < 0
+		&& options.shardPorts.isEmpty())
+		throw Exception("Invalid command line!", 61, "Options.cpp", "At least one input file is required");
+}
+
+/* Outputs command line usage into the stream &out */
+void printUsage(std::ostream& out, const char* program) {
+	out <<
+		"Usage: " << program << " [options] [input files...]\n"
+		"Without arguments the program runs interactively.\n"
+		"  -i, --input <file>      catalog file to read (may be repeated)\n"
+		"                          gzip and zstd files are decompressed while reading\n"
+		"  -d, --delimiter <char>  symbol every book starts with (default: none)\n"
+		"  -e, --errors <policy>   skip, abort or collect malformed books (default: skip)\n"
+		"  -o, --output <dir>      directory to write reports into (default: .)\n"
+		"  -q, --queries <file>    file with a sphere name on every line to answer in bulk\n"
+		"  -t, --threads <n>       threads of the shared thread pool (default: 0, one per core)\n"
+		"  -s, --sort <order>      order of booksTable: count (radix sort on available copies),\n"
+		"                          count-year (then on year) or merge (comparison sort) (default: count)\n"
+		"      --compact           keep the catalog in a compact columnar form and write the reports\n"
+		"                          from it, reports its memory per book\n"
+		"      --sketch            don't keep the books, summarize them while reading in fixed memory\n"
+		"                          sketches: writes sketchSpheresList.txt and sketchSummary.txt\n"
+		"  -b, --bench <name>      run benchmark on a synthetic catalog (list shows available)\n"
+		"      --books <n>         size of the benchmark catalog (default: 100000)\n"
+		"      --dirty <percent>   percent of malformed benchmark records (default: 10)\n"
+		"  -j, --journal <dir>     keep availability changes durable in a log and snapshot in dir\n"
+		"      --commit-every <n>  availability changes synced to the log together (default: 64)\n"
+		"      --snapshot-every <n> availability changes between snapshots, 0 never (default: 100000)\n"
+		"  -c, --changes <file>    availability changes to apply, lines of +n, -n or =n TAB author\n"
+		"                          TAB title TAB year (needs --journal)\n"
+		"      --serve <port>      answer queries on localhost:port instead of writing reports (0 picks a port)\n"
+		"  -f, --follow <ms>       while serving, read records appended to the inputs every ms\n"
+		"                          milliseconds (0: only on RELOAD requests), inputs must not be compressed\n"
+		"      --shard <i>/<n>     serve only shard i (from 0) of the catalog split into n by hash of\n"
+		"                          author, title and year, rows stay those of the whole catalog\n"
+		"      --shards <ports>    serve by coordinating shard servers on comma separated localhost ports\n"
+		"      --loadgen <port>    send requests (lines of --queries file) to a server on localhost:port\n"
+		"      --connections <n>   connections of the load generator (default: 4)\n"
+		"      --requests <n>      requests per load generator connection (default: 10000)\n"
+		"      --pipeline <n>      requests in flight per load generator connection (default: 1)\n"
+		"  -h, --help              show this message\n";
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include "Loader.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+/* How books are ordered by available copies for the reports */
+enum class SortMode {
+	Count,		// Radix sort on available copies, equal ones keep load order
+	CountYear,	// Radix sort on available copies, then on publication year
+	Merge		// Parallel merge sort comparing Books, equal ones keep load order
+};
+
+/* Command line options of a non-interactive (batch) run */
+struct Options {
+	ResizableArray<String> inputs;			// Catalog files to read, in order
+	char delimiter = '\n';					// Book delimiter, '\n' means none
+	ErrorPolicy errorPolicy = ErrorPolicy::Skip;
+	String outputDirectory = ".";			// Directory reports are written into
+	String queryFile;						// File with a sphere query on every line (optional)
+	int threads = 0;						// Threads used by parallel work, 0 means one per hardware thread
+	SortMode sortMode = SortMode::Count;	// How books are ordered for the reports
+	String benchmark;						// Benchmark to run instead of processing inputs (optional)
+	int benchmarkBooks = 100000;			// Size of synthetic catalog used by benchmarks
+	int benchmarkDirtyPercent = 10;			// Percent of malformed records in synthetic catalog
+	String journalDirectory;				// Directory of the availability log and snapshot (optional)
+	int commitEvery = 64;					// Availability changes written and synced together
+	int snapshotEvery = 100000;				// Availability changes between snapshots, 0 means never
+	String changesFile;						// File with availability changes to apply (optional)
+	int servePort = -1;						// Port to serve queries on instead of writing reports, -1 means none
+	int followInterval = -1;				// Milliseconds between reads of records appended to inputs while serving, -1 means never
+	int loadPort = -1;						// Port of a running server to generate load against, -1 means none
+	int loadConnections = 4;				// Connections opened by the load generator
+	int loadRequests = 10000;				// Requests sent over every load generator connection
+	int loadPipeline = 1;					// Requests the load generator keeps in flight per connection
+	bool compact = false;					// Keep the catalog compacted while writing reports
+	bool sketch = false;					// Summarize inputs in fixed memory sketches instead of keeping the Books
+	int shard = -1;							// Shard of the catalog to serve (0 to @shardCount - 1), -1 means the whole catalog
+	int shardCount = 0;						// Shards the catalog is split into
+	ResizableArray<int> shardPorts;			// Ports of shard servers to coordinate instead of reading a catalog
+	bool showHelp = false;
+};
+
+/* Returns true if the program was started with any command line arguments,
+   which means it should run in batch mode */
+bool isBatchMode(int argc, char** argv);
+
+/* Parses command line arguments into @options.
+   Throws Exception describing the problem if arguments are invalid */
+void parseOptions(int argc, char** argv, Options& options);
+
+/* Outputs command line usage into the stream &out */
+void printUsage(std::ostream& out, const char* program);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "TypeTraits.h"
 
 /* Template Pair class - holds two items: first and second of type T and U */
 template<class T, class U>
@@ -9,15 +10,16 @@ class Pair {
 
 public:
 
+	Pair() : first(), second() {
+	}
+
 	Pair(const T& first, const U& second) {
 		this->first = first;
 		this->second = second;
 	}
 
-	Pair(const Pair& p) {
-		first = p.first;
-		second = p.second;
-	}
+	/* Copies both items, a Pair of trivially copyable items is trivially copyable itself */
+	Pair(const Pair& p) = default;
 
 	const T& getFirst() const {
 		return first;
@@ -41,4 +43,9 @@ public:
 template<class T, class U>
 Pair<T, U> makePair(const T& first, const U& second) {
 	return Pair<T, U>(first, second);
-}
\ No newline at end of file
+}
+
+/* A Pair is relocatable when both of its items are */
+template<class T, class U>
+struct IsTriviallyRelocatable<Pair<T, U>> : std::integral_constant<bool, IsTriviallyRelocatable<T>::value && IsTriviallyRelocatable<U>::value> {
+};
\ No newline at end of file
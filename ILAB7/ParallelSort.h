@@ -0,0 +1,139 @@
+#pragma once
+#include "ResizableArray.h"
+#include "ThreadPool.h"
+
+#define PARALLEL_SORT_CUTOFF 8192		// Ranges shorter than this are sorted by a single task
+#define PARALLEL_SORT_RUN 16			// Runs of this length are sorted by insertion before merging
+
+/* Parallel stable merge sort.
+   Elements are compared with operator> only, like the sequential sort templates do, and equal
+   elements keep their relative order, so the result doesn't depend on the amount of threads.
+   Runs as fork/join tasks on a ThreadPool, so sorts started from parallel code share its threads.
+   The sort permutes an array of indices instead of the elements themselves, so every element
+   is copied at most once at the end no matter how heavy its copy is (Books copy Strings) */
+
+/* Stable merge of sorted index runs @left (@leftSize) and @right (@rightSize) of @arr into @out
+   on @pool (nullptr merges on the current thread). Merges longer than @cutoff are split: the left
+   run at its middle element, the right run at the first element which doesn't go before it,
+   and both halves are merged as independent tasks */
+template<class T>
+void parallelMerge(const T* arr, const int* left, const int leftSize, const int* right, const int rightSize, int* out, ThreadPool* pool, const int cutoff) {
+	if (pool != nullptr && pool->getThreadCount() > 1 && leftSize + rightSize > cutoff && leftSize > 0) {
+		int leftMiddle = leftSize / 2;
+		const T& pivot = arr[left[leftMiddle]];
+		int low = 0, high = rightSize;
+		while (low < high) {
+			int middle = (low + high) / 2;
+			if (pivot > arr[right[middle]])
+				low = middle + 1;
+			else high = middle;
+		}
+		TaskGroup group(*pool);
+		group.run([=]() { parallelMerge(arr, left, leftMiddle, right, low, out, pool, cutoff); });
+		parallelMerge(arr, left + leftMiddle, leftSize - leftMiddle, right + low, rightSize - low, out + leftMiddle + low, pool, cutoff);
+		group.wait();
+		return;
+	}
+	int l = 0, r = 0, o = 0;
+	while (l < leftSize && r < rightSize)
+		out[o++] = arr[left[l]] > arr[right[r]] ? right[r++] : left[l++];
+	while (l < leftSize)
+		out[o++] = left[l++];
+	while (r < rightSize)
+		out[o++] = right[r++];
+}
+
+/* Sorts @n indices @idx of @arr by a single thread, @tmp is scratch space of the same size */
+template<class T>
+void sequentialIndexSort(const T* arr, int* idx, int* tmp, const int n) {
+	for (int start = 0; start < n; start += PARALLEL_SORT_RUN) {
+		int end = start + PARALLEL_SORT_RUN < n ? start + PARALLEL_SORT_RUN : n;
+		for (int i = start + 1; i < end; ++i) {
+			int key = idx[i];
+			int j = i - 1;
+			for (; j >= start && arr[idx[j]] > arr[key]; --j)
+				idx[j + 1] = idx[j];
+			idx[j + 1] = key;
+		}
+	}
+	int* source = idx;
+	int* target = tmp;
+	for (int width = PARALLEL_SORT_RUN; width < n; width *= 2) {
+		for (int start = 0; start < n; start += 2 * width) {
+			int middle = start + width < n ? start + width : n;
+			int end = start + 2 * width < n ? start + 2 * width : n;
+			parallelMerge(arr, source + start, middle - start, source + middle, end - middle, target + start, (ThreadPool*)nullptr, 0);
+		}
+		int* swap = source;
+		source = target;
+		target = swap;
+	}
+	if (source != idx)
+		for (int i = 0; i < n; ++i)
+			idx[i] = source[i];
+}
+
+/* Sorts @n indices @idx of @arr on @pool, @tmp is scratch space of the same size.
+   Halves are sorted as independent tasks and then merged in parallel */
+template<class T>
+void parallelIndexSort(const T* arr, int* idx, int* tmp, const int n, ThreadPool& pool, const int cutoff) {
+	if (pool.getThreadCount() == 1 || n <= cutoff) {
+		sequentialIndexSort(arr, idx, tmp, n);
+		return;
+	}
+	int middle = n / 2;
+	TaskGroup group(pool);
+	group.run([=, &pool]() { parallelIndexSort(arr, idx, tmp, middle, pool, cutoff); });
+	parallelIndexSort(arr, idx + middle, tmp + middle, n - middle, pool, cutoff);
+	group.wait();
+	parallelMerge(arr, idx, middle, idx + middle, n - middle, tmp, &pool, cutoff);
+	parallelFor(pool, 0, n, cutoff, [idx, tmp](int from, int to) {
+		for (int i = from; i < to; ++i)
+			idx[i] = tmp[i];
+	});
+}
+
+/* Rearranges @n elements of @arr so that the element at @i becomes the one previously at @idx[i].
+   Follows permutation cycles, so every element is copied once plus once per cycle. @idx is reset */
+template<class T>
+void applyPermutation(T* arr, int* idx, const int n) {
+	for (int i = 0; i < n; ++i) {
+		if (idx[i] == i)
+			continue;
+		T first = arr[i];
+		int j = i;
+		while (idx[j] != i) {
+			int next = idx[j];
+			arr[j] = arr[next];
+			idx[j] = j;
+			j = next;
+		}
+		arr[j] = first;
+		idx[j] = j;
+	}
+}
+
+/* Sorts an array sent by a pointer in non-descending order on @pool.
+   Ranges shorter than @cutoff are not split between tasks */
+template<class T>
+void parallelSort(T* arr, const int n, ThreadPool& pool = ThreadPool::shared(), const int cutoff = PARALLEL_SORT_CUTOFF) {
+	if (arr == nullptr || n < 2)
+		return;
+	int* idx = new int[n];
+	int* tmp = new int[n];
+	for (int i = 0; i < n; ++i)
+		idx[i] = i;
+	parallelIndexSort(arr, idx, tmp, n, pool, cutoff > 1 ? cutoff : 1);
+	applyPermutation(arr, idx, n);
+	delete[] idx;
+	delete[] tmp;
+}
+
+/* Sorts a resizable array sent by a reference in non-descending order on @pool.
+   Ranges shorter than @cutoff are not split between tasks */
+template<class T>
+void parallelSort(ResizableArray<T>& arr, ThreadPool& pool = ThreadPool::shared(), const int cutoff = PARALLEL_SORT_CUTOFF) {
+	if (arr.getSize() < 2)
+		return;
+	parallelSort(arr.data(), arr.getSize(), pool, cutoff);
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "QueryCache.h"
+
+#include <iomanip>
+
+/* Returns the share of lookups answered from the cache, 0 if there were none */
+double QueryCacheStats::getHitRatio() const {
+	return hits + misses > 0 ? (double)hits / (hits + misses) : 0;
+}
+
+/* Outputs counters @stats into the stream &out as a single line */
+std::ostream& operator<<(std::ostream& out, const QueryCacheStats& stats) {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << stats.hits << " hits, " << stats.misses << " misses (" << std::fixed << std::setprecision(1)
+		<< stats.getHitRatio() * 100 << "% hit ratio), " << stats.entries << " entries in " << stats.bytes << " bytes, "
+		<< stats.evictions << " evicted, " << stats.invalidations << " invalidated";
+	out.flags(flags);
+	out.precision(precision);
+	return out;
+}
+
+/* Instantiates a cache of up to @capacity entries taking up to @maxBytes together */
+QueryCache::QueryCache(const int capacity, const size_t maxBytes) {
+	this->capacity = capacity > 0 ? capacity : 1;
+	this->maxBytes = maxBytes;
+	entries = new Entry[this->capacity];
+	for (int i = 0; i < this->capacity; ++i)
+		entries[i].next = i + 1 < this->capacity ? i + 1 : -1;
+	firstFree = 0;
+	head = tail = -1;
+}
+
+/* Destructor returns allocated memory */
+QueryCache::~QueryCache() {
+	delete[] entries;
+}
+
+/* Returns memory taken by @entry */
+size_t QueryCache::sizeOf(const Entry& entry) {
+	return sizeof(Entry) + entry.sphere.getLength() + entry.rows.getSize() * sizeof(int) + entry.rendered.size();
+}
+
+/* Unlinks entry @index from the recency list */
+void QueryCache::unlink(const int index) {
+	Entry& entry = entries[index];
+	if (entry.previous != -1)
+		entries[entry.previous].next = entry.next;
+	else head = entry.next;
+	if (entry.next != -1)
+		entries[entry.next].previous = entry.previous;
+	else tail = entry.previous;
+	entry.previous = entry.next = -1;
+}
+
+/* Links entry @index at the head of the recency list */
+void QueryCache::pushFront(const int index) {
+	Entry& entry = entries[index];
+	entry.previous = -1;
+	entry.next = head;
+	if (head != -1)
+		entries[head].previous = index;
+	head = index;
+	if (tail == -1)
+		tail = index;
+}
+
+/* Drops entry @index and returns it to the firstFree entries */
+void QueryCache::drop(const int index) {
+	Entry& entry = entries[index];
+	unlink(index);
+	slots.remove(entry.sphere);
+	stats.bytes -= sizeOf(entry);
+	--stats.entries;
+	// Keep the buffers of the entry for the next result stored in it
+	entry.rows.clear();
+	entry.rendered.clear();
+	entry.next = firstFree;
+	firstFree = index;
+}
+
+/* Copies the rendered result of sphere @sphere (normalized) into @rendered and its rows into
+   @rows (unless nullptr). Returns false if it isn't cached */
+bool QueryCache::find(const String& sphere, std::string& rendered, ResizableArray<int>* rows) {
+	std::lock_guard<std::mutex> guard(lock);
+	const int* index = slots.find(sphere);
+	if (index == nullptr) {
+		++stats.misses;
+		return false;
+	}
+	++stats.hits;
+	Entry& entry = entries[*index];
+	rendered = entry.rendered;
+	if (rows != nullptr)
+		*rows = entry.rows;
+	if (head != *index) {
+		unlink(*index);
+		pushFront(*index);
+	}
+	return true;
+}
+
+/* Caches @count @rows matching sphere @sphere (normalized) and their @rendered result,
+   replacing the cached one. Results larger than the whole cache are not kept */
+void QueryCache::insert(const String& sphere, const int* rows, const int count, const std::string& rendered) {
+	std::lock_guard<std::mutex> guard(lock);
+	const int* cached = slots.find(sphere);
+	if (cached != nullptr)
+		drop(*cached);
+	size_t size = sizeof(Entry) + sphere.getLength() + count * sizeof(int) + rendered.size();
+	if (size > maxBytes)
+		return;
+	while (tail != -1 && (firstFree == -1 || stats.bytes + size > maxBytes)) {
+		drop(tail);
+		++stats.evictions;
+	}
+
+	int index = firstFree;
+	Entry& entry = entries[index];
+	firstFree = entry.next;
+	entry.sphere = sphere;
+	entry.rows.clear();
+	entry.rows.reserve(count);
+	for (int i = 0; i < count; ++i)
+		entry.rows.add(rows[i]);
+	entry.rendered = rendered;
+	pushFront(index);
+	slots[sphere] = index;
+	stats.bytes += sizeOf(entry);
+	++stats.entries;
+}
+
+/* Drops entries of every sphere of @book, whose availability changed or which was added */
+void QueryCache::invalidate(const Book& book) {
+	std::lock_guard<std::mutex> guard(lock);
+	const String* spheres = book.getSpheres();
+	for (int i = 0; i < book.getSpheresCount(); ++i) {
+		const int* index = slots.find(spheres[i]);
+		if (index != nullptr) {
+			drop(*index);
+			++stats.invalidations;
+		}
+	}
+}
+
+/* Drops every entry, e.g. after the catalog was read again */
+void QueryCache::clear() {
+	std::lock_guard<std::mutex> guard(lock);
+	while (head != -1) {
+		drop(head);
+		++stats.invalidations;
+	}
+}
+
+/* Returns the counters */
+QueryCacheStats QueryCache::getStats() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include <mutex>
+#include <string>
+
+#include "Book.h"
+#include "HashMap.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+#define QUERY_CACHE_ENTRIES 64				// Default amount of cached spheres
+#define QUERY_CACHE_BYTES (16 << 20)		// Default memory cached results may take
+
+/* Counters of a Query Cache */
+struct QueryCacheStats {
+	long long hits = 0;
+	long long misses = 0;
+	long long evictions = 0;		// Entries dropped to make room
+	long long invalidations = 0;	// Entries dropped because their Books changed
+	int entries = 0;
+	size_t bytes = 0;				// Memory taken by cached results
+
+	/* Returns the share of lookups answered from the cache, 0 if there were none */
+	double getHitRatio() const;
+};
+
+/* Query Cache class - bounded LRU cache of sphere query results keyed by the normalized
+   sphere name. An entry holds the matching rows and the result already rendered by its user,
+   so a hit costs a lookup and a copy. When the amount of entries or their memory exceeds the
+   bound, least recently used entries are dropped. Entries depend only on Books covering their
+   sphere, so invalidating a Book (changed availability, added to the catalog) drops exactly the
+   entries of its spheres. All methods may be called from several threads at once */
+class QueryCache {
+
+	/* Cached result of a single sphere */
+	struct Entry {
+		String sphere;
+		ResizableArray<int> rows;
+		std::string rendered;
+		int previous = -1;			// More recently used neighbour in the recency list, -1 at the head
+		int next = -1;				// Less recently used neighbour (or next firstFree entry), -1 at the tail
+	};
+
+	Entry* entries;
+	int capacity;
+	size_t maxBytes;
+	HashMap<String, int> slots;		// Sphere to its entry
+	int head;						// Most recently used entry, -1 if empty
+	int tail;						// Least recently used entry
+	int firstFree;						// First unused entry
+	QueryCacheStats stats;
+	mutable std::mutex lock;
+
+	QueryCache(const QueryCache&); // Copy constructor disabled
+
+	/* Returns memory taken by @entry */
+	static size_t sizeOf(const Entry& entry);
+	/* Unlinks entry @index from the recency list */
+	void unlink(const int index);
+	/* Links entry @index at the head of the recency list */
+	void pushFront(const int index);
+	/* Drops entry @index and returns it to the firstFree entries */
+	void drop(const int index);
+
+public:
+
+	/* Instantiates a cache of up to @capacity entries taking up to @maxBytes together */
+	QueryCache(const int capacity = QUERY_CACHE_ENTRIES, const size_t maxBytes = QUERY_CACHE_BYTES);
+	/* Destructor returns allocated memory */
+	~QueryCache();
+
+	/* Copies the rendered result of sphere @sphere (normalized) into @rendered and its rows into
+	   @rows (unless nullptr). Returns false if it isn't cached */
+	bool find(const String& sphere, std::string& rendered, ResizableArray<int>* rows = nullptr);
+
+	/* Caches @count @rows matching sphere @sphere (normalized) and their @rendered result,
+	   replacing the cached one. Results larger than the whole cache are not kept */
+	void insert(const String& sphere, const int* rows, const int count, const std::string& rendered);
+
+	/* Drops entries of every sphere of @book, whose availability changed or which was added */
+	void invalidate(const Book& book);
+
+	/* Drops every entry, e.g. after the catalog was read again */
+	void clear();
+
+	/* Returns the counters */
+	QueryCacheStats getStats() const;
+
+};
+
+/* Outputs counters @stats into the stream &out as a single line */
+std::ostream& operator<<(std::ostream& out, const QueryCacheStats& stats);
\ No newline at end of file
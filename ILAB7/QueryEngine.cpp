@@ -0,0 +1,290 @@
+#include "QueryEngine.h"
+#include "Exception.h"
+#include "Util.h"
+
+#include <cctype>
+
+/* Instantiates an engine over no Books */
+QueryEngine::QueryEngine() {
+	rowCount = 0;
+	books = nullptr;
+	isTextBuilt = false;
+}
+
+/* Rebuilds the index over the array of Books @books. Row ids in results refer to this array */
+void QueryEngine::build(const ResizableArray<Book>& books) {
+	index.build(books);
+	years.build(books);
+	rowCount = books.getSize();
+	for (int i = 0; i < QUERY_MAX_DEPTH * 2; ++i)
+		scratch.operands[i].reset(0);
+	this->books = &books;
+	std::lock_guard<std::mutex> guard(textLock);
+	isTextBuilt = false;
+}
+
+/* Indexes Books added at the end of the array the engine was built over since the last
+   build or extend. Old rows keep their ids. Must not run while queries are evaluated */
+void QueryEngine::extend(const ResizableArray<Book>& books) {
+	int from = rowCount;
+	index.append(books, from);
+	years.append(books, from);
+	rowCount = books.getSize();
+	this->books = &books;
+	// The text index is rebuilt on the next TITLE or AUTHOR query
+	std::lock_guard<std::mutex> guard(textLock);
+	isTextBuilt = false;
+}
+
+/* Returns the title and author index, building it on first use.
+   Concurrent callers wait until the first one has built it */
+const TextIndex& QueryEngine::getTextIndex() const {
+	if (!isTextBuilt && books != nullptr) {
+		std::lock_guard<std::mutex> guard(textLock);
+		if (!isTextBuilt) {
+			text.build(*books);
+			isTextBuilt = true;
+		}
+	}
+	return text;
+}
+
+/* Selects rows of Books whose @field has a word starting with @text (@maxDistance of 0) or
+   whose whole @field is within @maxDistance edits from @text into @result */
+void QueryEngine::selectText(const TextField field, const String& text, const int maxDistance, RowSet& result) const {
+	result.reset(rowCount);
+	if (books == nullptr)
+		return;
+	if (maxDistance == 0) {
+		ResizableArray<int> rows;
+		getTextIndex().findPrefix(field, text, -1, rows);
+		if (!rows.isEmpty())
+			result.addRows(rows.data(), rows.getSize());
+		return;
+	}
+	ResizableArray<TextMatch> matches;
+	getTextIndex().findSimilar(field, text, maxDistance, -1, matches);
+	for (int i = 0; i < matches.getSize(); ++i)
+		result.add(matches[i].row);
+}
+
+/* Returns the amount of rows the engine was built over */
+int QueryEngine::getRowCount() const {
+	return rowCount;
+}
+
+/* Returns the sphere index of the engine */
+const SphereIndex& QueryEngine::getIndex() const {
+	return index;
+}
+
+/* Returns the year index of the engine */
+const YearIndex& QueryEngine::getYearIndex() const {
+	return years;
+}
+
+/* Selects rows of Books covering sphere @sphere (already normalized) into @result */
+void QueryEngine::selectSphere(const String& sphere, RowSet& result) const {
+	result.reset(rowCount);
+	int id = index.findSphere(sphere);
+	if (id != -1)
+		result.addRows(index.getRows(id), index.getRowCount(id));
+}
+
+/* Selects rows of Books published from @from to @to inclusively into @result */
+void QueryEngine::selectYears(const int from, const int to, RowSet& result) const {
+	result.reset(rowCount);
+	int count = years.getRowCount(from, to);
+	if (count > 0)
+		result.addRows(years.getRows(from, to), count);
+}
+
+/* Evaluates @query and stores matching rows in @result.
+   Throws Exception if the query is malformed */
+void QueryEngine::evaluate(const String& query, RowSet& result) {
+	evaluate(query, result, scratch);
+}
+
+/* Evaluates @query using caller's @s and stores matching rows in @result, so several
+   threads may evaluate queries at once, each with its own scratch.
+   Throws Exception if the query is malformed */
+void QueryEngine::evaluate(const String& query, RowSet& result, QueryScratch& s) const {
+	s.cursor = query.get();
+	parseExpression(s, 0, result);
+	if (*s.cursor == ')')
+		throw Exception("Invalid query!", 71, "QueryEngine.cpp", "Unmatched closing parenthesis");
+}
+
+/* Returns true if @query is a single sphere name without keywords or parentheses,
+   storing it normalized into @sphere, so its result may be looked up by the name */
+bool QueryEngine::isSphereQuery(const String& query, String& sphere, QueryScratch& s) const {
+	s.cursor = query.get();
+	if (atTokenBoundary(s))
+		return false;
+	readPhrase(s, sphere);
+	if (*s.cursor != '\0')
+		return false;
+	Util::normalizeString(sphere);
+	return true;
+}
+
+/* Skips spaces and returns true if the next token is keyword @keyword */
+bool QueryEngine::peekKeyword(QueryScratch& s, const char* keyword) const {
+	while (*s.cursor == ' ' || *s.cursor == '\t')
+		++s.cursor;
+	int i = 0;
+	for (; keyword[i]; ++i)
+		if (s.cursor[i] != keyword[i])
+			return false;
+	return s.cursor[i] == '\0' || s.cursor[i] == ' ' || s.cursor[i] == '\t' || s.cursor[i] == '(' || s.cursor[i] == ')' || s.cursor[i] == '~';
+}
+
+/* Returns true if the cursor is at a keyword, parenthesis or the end of the query */
+bool QueryEngine::atTokenBoundary(QueryScratch& s) const {
+	return peekKeyword(s, "AND") || peekKeyword(s, "OR") || peekKeyword(s, "NOT") || peekKeyword(s, "YEAR")
+		|| peekKeyword(s, "TITLE") || peekKeyword(s, "AUTHOR")
+		|| *s.cursor == '\0' || *s.cursor == '(' || *s.cursor == ')';
+}
+
+/* Reads the next whitespace separated word into @word */
+void QueryEngine::readWord(QueryScratch& s, String& word) const {
+	while (*s.cursor == ' ' || *s.cursor == '\t')
+		++s.cursor;
+	const char* begin = s.cursor;
+	while (*s.cursor && *s.cursor != ' ' && *s.cursor != '\t' && *s.cursor != '(' && *s.cursor != ')')
+		++s.cursor;
+	char buf[64];
+	int length = s.cursor - begin < 63 ? s.cursor - begin : 63;
+	for (int i = 0; i < length; ++i)
+		buf[i] = begin[i];
+	buf[length] = '\0';
+	word = buf;
+}
+
+/* Reads words up to the next keyword or parenthesis into @phrase */
+void QueryEngine::readPhrase(QueryScratch& s, String& phrase) const {
+	String word;
+	phrase = "";
+	while (!atTokenBoundary(s)) {
+		readWord(s, word);
+		if (phrase.getLength())
+			phrase += ' ';
+		phrase += word;
+	}
+}
+
+/* Parses operands joined by operators until closing parenthesis or end of query */
+void QueryEngine::parseExpression(QueryScratch& s, const int depth, RowSet& result) const {
+	if (depth >= QUERY_MAX_DEPTH)
+		throw Exception("Invalid query!", 113, "QueryEngine.cpp", "Parentheses are nested too deep");
+	parseOperand(s, depth, result);
+	RowSet& operand = s.operands[depth * 2];
+	while (true) {
+		if (peekKeyword(s, "AND")) {
+			s.cursor += 3;
+			parseOperand(s, depth, operand);
+			result.intersect(operand);
+		}
+		else if (peekKeyword(s, "OR")) {
+			s.cursor += 2;
+			parseOperand(s, depth, operand);
+			result.unite(operand);
+		}
+		else if (peekKeyword(s, "NOT")) {
+			s.cursor += 3;
+			parseOperand(s, depth, operand);
+			result.subtract(operand);
+		}
+		else if (*s.cursor == '\0' || *s.cursor == ')')
+			return;
+		else throw Exception("Invalid query!", 135, "QueryEngine.cpp", "Operator expected between operands");
+	}
+}
+
+/* Parses a single operand: sphere name, YEAR range, NOT operand or parenthesized expression */
+void QueryEngine::parseOperand(QueryScratch& s, const int depth, RowSet& result) const {
+	if (peekKeyword(s, "NOT")) {
+		s.cursor += 3;
+		parseOperand(s, depth, result);
+		result.complement();
+		return;
+	}
+	if (peekKeyword(s, "YEAR")) {
+		s.cursor += 4;
+		parseYearRange(s, result);
+		return;
+	}
+	if (*s.cursor == '(') {
+		++s.cursor;
+		parseExpression(s, depth + 1, s.operands[depth * 2 + 1]);
+		if (*s.cursor != ')')
+			throw Exception("Invalid query!", 156, "QueryEngine.cpp", "Closing parenthesis expected");
+		++s.cursor;
+		result = s.operands[depth * 2 + 1];
+		return;
+	}
+	if (peekKeyword(s, "TITLE")) {
+		s.cursor += 5;
+		parseTextSearch(s, TextField::Title, result);
+		return;
+	}
+	if (peekKeyword(s, "AUTHOR")) {
+		s.cursor += 6;
+		parseTextSearch(s, TextField::Author, result);
+		return;
+	}
+	if (atTokenBoundary(s))
+		throw Exception("Invalid query!", 162, "QueryEngine.cpp", "Sphere name expected");
+
+	// Sphere name is every word up to the next keyword or parenthesis
+	String sphere;
+	readPhrase(s, sphere);
+	Util::normalizeString(sphere);
+	selectSphere(sphere, result);
+}
+
+/* Parses year range after YEAR keyword and selects matching rows */
+void QueryEngine::parseYearRange(QueryScratch& s, RowSet& result) const {
+	String range;
+	readWord(s, range);
+	const char* c = range.get();
+	int from = 0, to = 0xFFFF;
+	bool hasDigits = false;
+
+	if (isdigit(*c)) {
+		from = 0;
+		while (isdigit(*c) && from <= 0xFFFF)
+			from = from * 10 + (*c++ - '0');
+		hasDigits = true;
+		to = from;
+	}
+	if (*c == '-') {
+		++c;
+		to = 0xFFFF;
+		if (isdigit(*c)) {
+			to = 0;
+			while (isdigit(*c) && to <= 0xFFFF)
+				to = to * 10 + (*c++ - '0');
+			hasDigits = true;
+		}
+	}
+	if (*c != '\0' || !hasDigits)
+		throw Exception("Invalid query!", 197, "QueryEngine.cpp", "Year range must look like 1990-2005, 1990, 1990- or -2005");
+	selectYears(from, to, result);
+}
+
+/* Parses optional ~distance and text after TITLE or AUTHOR keyword and selects matching rows */
+void QueryEngine::parseTextSearch(QueryScratch& s, const TextField field, RowSet& result) const {
+	int distance = 0;
+	if (*s.cursor == '~') {
+		++s.cursor;
+		if (!isdigit(*s.cursor) || *s.cursor - '0' > TEXT_INDEX_MAX_DISTANCE)
+			throw Exception("Invalid query!", 260, "QueryEngine.cpp", "Edit distance after ~ must be a digit from 0 to 3");
+		distance = *s.cursor++ - '0';
+	}
+	String phrase;
+	readPhrase(s, phrase);
+	if (phrase.getLength() == 0)
+		throw Exception("Invalid query!", 266, "QueryEngine.cpp", "Text expected after TITLE or AUTHOR");
+	selectText(field, phrase, distance, result);
+}
\ No newline at end of file
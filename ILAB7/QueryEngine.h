@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+
+#include "Book.h"
+#include "ResizableArray.h"
+#include "RowSet.h"
+#include "SphereIndex.h"
+#include "String.h"
+#include "TextIndex.h"
+#include "YearIndex.h"
+
+#define QUERY_MAX_DEPTH 16
+
+/* Evaluation state of a single query: operands of every nesting level, reused between
+   queries, and the current position in the query being parsed. Threads evaluating
+   queries on the same engine at once need a scratch each */
+struct QueryScratch {
+	RowSet operands[QUERY_MAX_DEPTH * 2];
+	const char* cursor = nullptr;
+};
+
+/* Query Engine class - answers boolean queries over spheres and publication years of
+   an array of Books. Query syntax (keywords are upper case, operators are applied
+   left to right, parentheses group):
+     Programming AND Computer Science
+     Math OR Physics NOT Fiction          - same as (Math OR Physics) NOT Fiction
+     History AND YEAR 1990-2005           - YEAR accepts N, N-M, N- and -M
+     NOT (Fiction OR Romance)
+     TITLE the complete ref               - any word of the title starts with the text
+     AUTHOR~2 herbert shildt              - whole author within 2 edits (up to 3)
+   Sphere names are normalized before lookup. Indexes are built once and shared by all queries,
+   title and author index is built on the first TITLE or AUTHOR query. Once built, the engine
+   may be queried from several threads at once, each passing its own QueryScratch */
+class QueryEngine {
+
+	SphereIndex index;
+	YearIndex years;
+	int rowCount;
+	const ResizableArray<Book>* books;	// Books the engine was built over, used to build @text lazily
+	mutable TextIndex text;
+	mutable std::atomic<bool> isTextBuilt;
+	mutable std::mutex textLock;		// Guards lazy build of @text
+
+	QueryScratch scratch;				// Used by single threaded evaluate()
+
+	QueryEngine(const QueryEngine&); // Copy constructor disabled
+
+	/* Skips spaces and returns true if the next token is keyword @keyword */
+	bool peekKeyword(QueryScratch& s, const char* keyword) const;
+	/* Returns true if the cursor is at a keyword, parenthesis or the end of the query */
+	bool atTokenBoundary(QueryScratch& s) const;
+	/* Reads the next whitespace separated word into @word */
+	void readWord(QueryScratch& s, String& word) const;
+	/* Reads words up to the next keyword or parenthesis into @phrase */
+	void readPhrase(QueryScratch& s, String& phrase) const;
+
+	/* Parses operands joined by operators until closing parenthesis or end of query */
+	void parseExpression(QueryScratch& s, const int depth, RowSet& result) const;
+	/* Parses a single operand: sphere name, YEAR range, NOT operand or parenthesized expression */
+	void parseOperand(QueryScratch& s, const int depth, RowSet& result) const;
+	/* Parses year range after YEAR keyword and selects matching rows */
+	void parseYearRange(QueryScratch& s, RowSet& result) const;
+	/* Parses optional ~distance and text after TITLE or AUTHOR keyword and selects matching rows */
+	void parseTextSearch(QueryScratch& s, const TextField field, RowSet& result) const;
+
+public:
+
+	/* Instantiates an engine over no Books */
+	QueryEngine();
+
+	/* Rebuilds the index over the array of Books @books. Row ids in results refer to this array,
+	   it must stay unchanged while the engine is used */
+	void build(const ResizableArray<Book>& books);
+
+	/* Indexes Books added at the end of the array the engine was built over since the last
+	   build or extend. Old rows keep their ids. Must not run while queries are evaluated */
+	void extend(const ResizableArray<Book>& books);
+
+	/* Returns the amount of rows the engine was built over */
+	int getRowCount() const;
+
+	/* Returns the sphere index of the engine */
+	const SphereIndex& getIndex() const;
+
+	/* Returns the year index of the engine */
+	const YearIndex& getYearIndex() const;
+
+	/* Evaluates @query and stores matching rows in @result.
+	   Throws Exception if the query is malformed */
+	void evaluate(const String& query, RowSet& result);
+
+	/* Evaluates @query using caller's @s and stores matching rows in @result, so several
+	   threads may evaluate queries at once, each with its own scratch.
+	   Throws Exception if the query is malformed */
+	void evaluate(const String& query, RowSet& result, QueryScratch& s) const;
+
+	/* Returns true if @query is a single sphere name without keywords or parentheses,
+	   storing it normalized into @sphere, so its result may be looked up by the name */
+	bool isSphereQuery(const String& query, String& sphere, QueryScratch& s) const;
+
+	/* Selects rows of Books covering sphere @sphere (already normalized) into @result */
+	void selectSphere(const String& sphere, RowSet& result) const;
+
+	/* Selects rows of Books published from @from to @to inclusively into @result */
+	void selectYears(const int from, const int to, RowSet& result) const;
+
+	/* Selects rows of Books whose @field has a word starting with @text (@maxDistance of 0) or
+	   whose whole @field is within @maxDistance edits from @text into @result */
+	void selectText(const TextField field, const String& text, const int maxDistance, RowSet& result) const;
+
+	/* Returns the title and author index, building it on first use */
+	const TextIndex& getTextIndex() const;
+
+};
\ No newline at end of file
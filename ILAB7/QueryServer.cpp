@@ -0,0 +1,528 @@
+#include "QueryServer.h"
+#include "Exception.h"
+#include "GroupBy.h"
+#include "Loader.h"
+#include "Pair.h"
+#include "RadixSort.h"
+#include "RowSet.h"
+#include "ShardCoordinator.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#define TOKEN_LISTENER 0
+#define TOKEN_WAKE 1
+#define TOKEN_FIRST_CONNECTION 2
+
+/* Instantiates a server over @books indexed by @engine, heavy requests run on @pool.
+   Both must stay unchanged while the server runs, except by the reloader */
+QueryServer::QueryServer(const ResizableArray<Book>& books, const QueryEngine& engine, ThreadPool& pool)
+	: books(books), engine(engine), pool(pool), tasks(pool) {
+	listener = wake[0] = wake[1] = NET_INVALID_SOCKET;
+	isStopping = false;
+	served = 0;
+	followInterval = -1;
+	byAvailability = nullptr;
+	rankedRows = 0;
+	rowIds = nullptr;
+	coordinator = nullptr;
+	rankRows(0);
+}
+
+/* Orders rows from @from on into @byAvailability, merging them with the rows ordered before */
+void QueryServer::rankRows(const int from) {
+	// Complemented copies radix sorted stably put most available first, ties by row
+	int count = books.getSize() - from;
+	int* order = new int[count > 0 ? count : 1];
+	radixOrder(books.data() + from, count, [](const Book& book) {
+		return (unsigned long long)~(unsigned int)book.getCurrentAmount();
+	}, order, pool);
+
+	// New rows follow old ones with as many copies, their row ids are greater
+	int* merged = new int[books.getSize() > 0 ? books.getSize() : 1];
+	int oldIndex = 0, newIndex = 0, write = 0;
+	while (oldIndex < from && newIndex < count)
+		if (books[byAvailability[oldIndex]].getCurrentAmount() >= books[from + order[newIndex]].getCurrentAmount())
+			merged[write++] = byAvailability[oldIndex++];
+		else merged[write++] = from + order[newIndex++];
+	while (oldIndex < from)
+		merged[write++] = byAvailability[oldIndex++];
+	while (newIndex < count)
+		merged[write++] = from + order[newIndex++];
+	delete[] order;
+	delete[] byAvailability;
+	byAvailability = merged;
+	rankedRows = books.getSize();
+}
+
+/* Lets the server reload the catalog: @reloader appends new books to the array the server
+   was created over, indexes them in the engine and returns their amount (setting its argument
+   if the array was rebuilt instead). It runs on the loop thread while no request is being
+   evaluated, every @interval milliseconds (0 means only on RELOAD requests) */
+void QueryServer::setReloader(const std::function<int(bool& isRebuilt)>& reloader, const int interval) {
+	this->reloader = reloader;
+	followInterval = interval;
+	nextReload = std::chrono::steady_clock::now() + std::chrono::milliseconds(interval);
+}
+
+/* Makes book lines carry row @rowIds[row] instead of the row of the array, e.g. rows of the
+   whole catalog when the array is its shard. The rows must ascend and stay unchanged */
+void QueryServer::setRowIds(const ResizableArray<int>& rowIds) {
+	this->rowIds = &rowIds;
+}
+
+/* Forwards requests to shards through @coordinator instead of answering them from the books */
+void QueryServer::setCoordinator(ShardCoordinator& coordinator) {
+	this->coordinator = &coordinator;
+}
+
+/* Waits for running requests, reads appended books and answers pending RELOAD requests */
+void QueryServer::reload() {
+	// Workers read the books and the engine, both change below
+	tasks.wait();
+	processCompletions();
+	bool isRebuilt = false;
+	int before = rankedRows;
+	int added = reloader(isRebuilt);
+	if (isRebuilt)
+		cache.clear();
+	else for (int row = before; row < books.getSize(); ++row)
+		cache.invalidate(books[row]);
+	rankRows(isRebuilt ? 0 : rankedRows);
+	nextReload = std::chrono::steady_clock::now() + std::chrono::milliseconds(followInterval);
+
+	ResizableArray<Completion> finished = reloadRequests;
+	reloadRequests.clear();
+	for (int i = 0; i < finished.getSize(); ++i) {
+		finished[i].response->text = "=" + std::to_string(added) + "\n";
+		connections[finished[i].token - TOKEN_FIRST_CONNECTION]->isReloading = false;
+	}
+	completeResponses(finished);
+	for (int i = 0; i < finished.getSize(); ++i) {
+		Connection* connection = connections[finished[i].token - TOKEN_FIRST_CONNECTION];
+		if (connection != nullptr && !connection->isClosed) {
+			parseRequests(finished[i].token);
+			flush(finished[i].token);
+		}
+	}
+}
+
+/* Destructor closes all connections */
+QueryServer::~QueryServer() {
+	tasks.wait();
+	processCompletions();
+	for (int i = 0; i < connections.getSize(); ++i)
+		if (connections[i] != nullptr) {
+			if (!connections[i]->isClosed)
+				Net::close(connections[i]->socket);
+			for (size_t r = 0; r < connections[i]->responses.size(); ++r)
+				delete connections[i]->responses[r];
+			delete connections[i];
+		}
+	if (listener != NET_INVALID_SOCKET)
+		Net::close(listener);
+	if (wake[0] != NET_INVALID_SOCKET) {
+		Net::close(wake[0]);
+		Net::close(wake[1]);
+	}
+	delete[] byAvailability;
+}
+
+/* Starts listening on 127.0.0.1:@port (0 picks a free port). Returns false on failure */
+bool QueryServer::listen(const int port) {
+	if (!Net::startup() || !Net::makePair(wake))
+		return false;
+	listener = Net::listenLocal(port);
+	if (listener == NET_INVALID_SOCKET)
+		return false;
+	Net::setNonBlocking(listener);
+	Net::setNonBlocking(wake[0]);
+	Net::setNonBlocking(wake[1]);
+	poller.add(listener, TOKEN_LISTENER, false);
+	poller.add(wake[1], TOKEN_WAKE, false);
+	return true;
+}
+
+/* Returns the port the server listens on */
+int QueryServer::getPort() const {
+	return Net::getPort(listener);
+}
+
+/* Returns the amount of answered requests */
+long long QueryServer::getServed() const {
+	return served;
+}
+
+/* Returns counters of the SPHERE response cache */
+QueryCacheStats QueryServer::getCacheStats() const {
+	return cache.getStats();
+}
+
+/* Runs the event loop until a SHUTDOWN request */
+void QueryServer::run() {
+	ResizableArray<Net::PollEvent> events;
+	while (!isStopping) {
+		int timeout = -1;
+		if (followInterval > 0) {
+			std::chrono::steady_clock::duration left = nextReload - std::chrono::steady_clock::now();
+			timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(left).count();
+			timeout = timeout < 0 ? 0 : timeout + 1;
+		}
+		if (!reloadRequests.isEmpty())
+			timeout = 0;
+		poller.wait(timeout, events);
+		for (int i = 0; i < events.getSize(); ++i) {
+			const Net::PollEvent& event = events[i];
+			if (event.token == TOKEN_LISTENER)
+				acceptConnections();
+			else if (event.token == TOKEN_WAKE)
+				processCompletions();
+			else {
+				if (event.isReadable || event.isClosed)
+					readRequests(event.token);
+				if (event.isWritable)
+					flush(event.token);
+			}
+		}
+		if (reloader && (!reloadRequests.isEmpty()
+			|| (followInterval > 0 && std::chrono::steady_clock::now() >= nextReload)))
+			reload();
+	}
+	// Answer requests still being evaluated before stopping
+	tasks.wait();
+	processCompletions();
+}
+
+/* Accepts every pending connection */
+void QueryServer::acceptConnections() {
+	socket_t socket;
+	while ((socket = Net::accept(listener)) != NET_INVALID_SOCKET) {
+		Net::setNonBlocking(socket);
+		int index = 0;
+		while (index < connections.getSize() && connections[index] != nullptr)
+			++index;
+		if (index == connections.getSize())
+			connections.add(nullptr);
+		Connection* connection = new Connection();
+		connection->socket = socket;
+		connections[index] = connection;
+		poller.add(socket, index + TOKEN_FIRST_CONNECTION, false);
+	}
+}
+
+/* Reads available requests of connection @token and answers them */
+void QueryServer::readRequests(const int token) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	if (connection == nullptr || connection->isClosed)
+		return;
+	char buffer[65536];
+	bool isEnd = false;
+	while (true) {
+		int received = Net::receive(connection->socket, buffer, sizeof(buffer));
+		if (received <= 0) {
+			isEnd = received < 0;
+			break;
+		}
+		connection->input.append(buffer, received);
+	}
+	parseRequests(token);
+	// A client closing its side still gets the answers computed so far
+	flush(token);
+	if (isEnd)
+		closeConnection(token);
+}
+
+/* Answers complete request lines received by connection @token */
+void QueryServer::parseRequests(const int token) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	size_t start = 0, end;
+	while (!connection->isReloading && (end = connection->input.find('\n', start)) != std::string::npos) {
+		size_t length = end > start && connection->input[end - 1] == '\r' ? end - start - 1 : end - start;
+		handleRequest(token, connection->input.substr(start, length));
+		start = end + 1;
+	}
+	connection->input.erase(0, start);
+	if (!connection->isReloading && connection->input.size() > QUERY_SERVER_MAX_LINE) {
+		handleRequest(token, "");	// Answers with an error
+		connection->input.clear();
+	}
+}
+
+/* Answers a single request @line of connection @token */
+void QueryServer::handleRequest(const int token, const std::string& line) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	Response* response = new Response();
+	connection->responses.push_back(response);
+	++served;
+
+	size_t space = line.find(' ');
+	std::string command = line.substr(0, space);
+	if (command == "PING") {
+		response->text = "=1\n";
+		response->isReady = true;
+	}
+	else if (coordinator != nullptr && command == "SHUTDOWN") {
+		// Shards stop once requests still waiting for them are answered
+		tasks.wait();
+		coordinator->evaluate(line, response->text);
+		response->isReady = true;
+		isStopping = true;
+	}
+	else if (command == "BEST" && coordinator == nullptr) {
+		if (books.isEmpty())
+			response->text = "+0\n";
+		else {
+			response->text = "+1\n";
+			appendBook(response->text, byAvailability[0]);
+		}
+		response->isReady = true;
+	}
+	else if (command == "RELOAD" && coordinator == nullptr) {
+		if (!reloader) {
+			response->text = "-Reload is not enabled\n";
+			response->isReady = true;
+		}
+		else {
+			// Answered after the current events, once running requests are done.
+			// Requests after it wait, so they see the reloaded catalog
+			++connection->inFlight;
+			connection->isReloading = true;
+			Completion completion = { token, response };
+			reloadRequests.add(completion);
+		}
+	}
+	else if (command == "SHUTDOWN") {
+		response->text = "=0\n";
+		response->isReady = true;
+		isStopping = true;
+	}
+	else if (command == "SPHERE" || command == "QUERY" || command == "COUNT" || command == "TOP"
+		|| command == "SPHERES" || command == "BEST" || command == "RELOAD") {
+		++connection->inFlight;
+		tasks.run([this, token, response, line]() {
+			evaluate(line, response->text);
+			bool isFirst;
+			{
+				std::lock_guard<std::mutex> guard(completedLock);
+				isFirst = completed.isEmpty();
+				Completion completion = { token, response };
+				completed.add(completion);
+			}
+			if (isFirst)
+				Net::send(wake[0], "!", 1);
+		});
+	}
+	else {
+		response->text = line.size() > QUERY_SERVER_MAX_LINE || line.empty() ? "-Request line is empty or too long\n" : "-Unknown command\n";
+		response->isReady = true;
+	}
+}
+
+/* Evaluates heavy request @line into @text, runs on a worker */
+void QueryServer::evaluate(const std::string& line, std::string& text) const {
+	static thread_local QueryScratch scratch;
+	static thread_local RowSet result;
+
+	if (coordinator != nullptr) {
+		coordinator->evaluate(line, text);
+		return;
+	}
+	size_t space = line.find(' ');
+	std::string command = line.substr(0, space);
+	std::string argument = space == std::string::npos ? "" : line.substr(space + 1);
+	if (command == "SPHERES") {
+		const SphereIndex& index = engine.getIndex();
+		ResizableArray<int> ids(index.getSphereCount() > 0 ? index.getSphereCount() : 1);
+		for (int id = 0; id < index.getSphereCount(); ++id)
+			if (index.getRowCount(id) > 0)
+				ids.add(id);
+		std::sort(ids.begin(), ids.end(), [&index](int a, int b) {
+			return std::strcmp(index.getSphereName(a).get(), index.getSphereName(b).get()) < 0;
+		});
+		text = "+" + std::to_string(ids.getSize()) + "\n";
+		for (int i = 0; i < ids.getSize(); ++i) {
+			text += index.getSphereName(ids[i]).get();
+			text += '\t';
+			text += std::to_string(index.getRowCount(ids[i]));
+			text += '\n';
+		}
+		return;
+	}
+	try {
+		if (command == "SPHERE") {
+			String sphere = argument.c_str();
+			Util::normalizeString(sphere);
+			if (cache.find(sphere, text))
+				return;
+			engine.selectSphere(sphere, result);
+			static thread_local ResizableArray<int> rows;
+			rows.clear();
+			text = "+" + std::to_string(result.count()) + "\n";
+			for (int row = result.next(0); row != -1; row = result.next(row + 1)) {
+				appendBook(text, row);
+				rows.add(row);
+			}
+			cache.insert(sphere, rows.data(), rows.getSize(), text);
+			return;
+		}
+		else if (command == "TOP") {
+			char* rest;
+			long k = std::strtol(argument.c_str(), &rest, 10);
+			if (rest == argument.c_str() || k < 0 || k > QUERY_SERVER_MAX_TOP) {
+				text = "-TOP requires a number from 0 to 1000\n";
+				return;
+			}
+			while (*rest == ' ')
+				++rest;
+			bool isFiltered = *rest != '\0';
+			if (isFiltered)
+				engine.evaluate(rest, result, scratch);
+			std::string rows;
+			int found = 0;
+			for (int i = 0; i < books.getSize() && found < k; ++i)
+				if (!isFiltered || result.contains(byAvailability[i])) {
+					appendBook(rows, byAvailability[i]);
+					++found;
+				}
+			text = "+" + std::to_string(found) + "\n" + rows;
+			return;
+		}
+		else engine.evaluate(argument.c_str(), result, scratch);
+	}
+	catch (Exception& e) {
+		text = "-";
+		text += describeException(e).get();
+		text += '\n';
+		return;
+	}
+
+	int count = result.count();
+	if (command == "COUNT") {
+		text = "=" + std::to_string(count) + "\n";
+		return;
+	}
+	text = "+" + std::to_string(count) + "\n";
+	for (int row = result.next(0); row != -1; row = result.next(row + 1))
+		appendBook(text, row);
+}
+
+/* Appends book line of row @row into @text */
+void QueryServer::appendBook(std::string& text, const int row) const {
+	const Book& book = books[row];
+	text += std::to_string(rowIds != nullptr ? (*rowIds)[row] : row);
+	text += '\t';
+	text += book.getAuthor().get();
+	text += '\t';
+	text += book.getTitle().get();
+	text += '\t';
+	text += std::to_string(book.getPublicationYear());
+	text += '\t';
+	text += std::to_string(book.getCurrentAmount());
+	text += '\n';
+}
+
+/* Moves ready responses of @connection into its output and sends as much as possible */
+void QueryServer::flush(const int token) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	if (connection == nullptr || connection->isClosed)
+		return;
+	while (!connection->responses.empty() && connection->responses.front()->isReady) {
+		connection->output += connection->responses.front()->text;
+		delete connection->responses.front();
+		connection->responses.pop_front();
+	}
+	while (connection->written < connection->output.size()) {
+		int sent = Net::send(connection->socket, connection->output.data() + connection->written,
+			(int)(connection->output.size() - connection->written));
+		if (sent < 0) {
+			closeConnection(token);
+			return;
+		}
+		if (sent == 0)
+			break;
+		connection->written += sent;
+	}
+	if (connection->written == connection->output.size()) {
+		connection->output.clear();
+		connection->written = 0;
+	}
+	bool isWriting = !connection->output.empty();
+	if (isWriting != connection->isWriting) {
+		poller.modify(connection->socket, token, isWriting);
+		connection->isWriting = isWriting;
+	}
+}
+
+/* Closes connection @token, frees it once no worker uses it */
+void QueryServer::closeConnection(const int token) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	if (connection->isClosed)
+		return;
+	poller.remove(connection->socket);
+	Net::close(connection->socket);
+	connection->isClosed = true;
+	releaseConnection(token);
+}
+
+/* Frees connection @token if it is closed and no worker uses it */
+void QueryServer::releaseConnection(const int token) {
+	Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+	if (!connection->isClosed || connection->inFlight > 0)
+		return;
+	for (size_t r = 0; r < connection->responses.size(); ++r)
+		delete connection->responses[r];
+	delete connection;
+	connections[token - TOKEN_FIRST_CONNECTION] = nullptr;
+}
+
+/* Marks responses finished by workers ready and flushes their connections */
+void QueryServer::processCompletions() {
+	char buffer[256];
+	while (Net::receive(wake[1], buffer, sizeof(buffer)) > 0);
+
+	ResizableArray<Completion> finished;
+	{
+		std::lock_guard<std::mutex> guard(completedLock);
+		finished = completed;
+		completed.clear();
+	}
+	completeResponses(finished);
+}
+
+/* Marks @finished responses ready, releases closed connections and flushes the rest */
+void QueryServer::completeResponses(const ResizableArray<Completion>& finished) {
+	for (int i = 0; i < finished.getSize(); ++i) {
+		int token = finished[i].token;
+		Connection* connection = connections[token - TOKEN_FIRST_CONNECTION];
+		finished[i].response->isReady = true;
+		--connection->inFlight;
+		if (connection->isClosed)
+			releaseConnection(token);
+	}
+	for (int i = 0; i < finished.getSize(); ++i)
+		flush(finished[i].token);
+}
+
+/* Reads a whole response of a Query Server (the header and the lines it announces) from @reader
+   into @response, line breaks included. Returns false if the connection closed */
+bool readResponse(Net::LineReader& reader, std::string& response) {
+	static thread_local std::string line;
+	response.clear();
+	if (!reader.readLine(line))
+		return false;
+	response += line;
+	response += '\n';
+	if (line.empty() || line[0] != '+')
+		return true;
+	int rows = atoi(line.c_str() + 1);
+	for (int i = 0; i < rows; ++i) {
+		if (!reader.readLine(line))
+			return false;
+		response += line;
+		response += '\n';
+	}
+	return true;
+}
\ No newline at end of file
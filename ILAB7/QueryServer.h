@@ -0,0 +1,161 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "Book.h"
+#include "QueryCache.h"
+#include "QueryEngine.h"
+#include "ResizableArray.h"
+#include "Socket.h"
+#include "ThreadPool.h"
+
+#define QUERY_SERVER_MAX_LINE 4096		// Longest request line accepted
+#define QUERY_SERVER_MAX_TOP 1000		// Largest K of a TOP request
+
+class ShardCoordinator;
+
+/* Reads a whole response of a Query Server (the header and the lines it announces) from @reader
+   into @response, line breaks included. Returns false if the connection closed */
+bool readResponse(Net::LineReader& reader, std::string& response);
+
+/* Query Server class - answers queries over a catalog loaded once, on localhost TCP.
+   A single thread runs the event loop (epoll on Linux, poll elsewhere) accepting connections,
+   reading requests and writing responses. Requests that touch many rows are evaluated on
+   the ThreadPool, so a heavy query doesn't stall other connections.
+
+   Protocol: every request is a single line, every response starts with a header line:
+     SPHERE <name>         books covering the sphere (cached until a reload adds books of it)
+     QUERY <query>         books matching a QueryEngine query
+     COUNT <query>         amount of books matching the query
+     TOP <k> [query]       k books with most available copies (of the matching ones)
+     BEST                  book with most available copies
+     SPHERES               amount of books of every sphere, "+<n>" followed by n lines
+                           "sphere<TAB>count" in bytewise order of spheres
+     PING                  liveness check
+     RELOAD                reads books appended to the catalog files ("=<books added>")
+     SHUTDOWN              stops the server after answering (and its shards)
+   Headers: "+<n>" followed by n book lines "row<TAB>author<TAB>title<TAB>year<TAB>count",
+   "=<number>" for COUNT and PING, "-<message>" for errors.
+   Requests may be pipelined: a client may send many requests without waiting,
+   responses come back in the order of requests.
+   A server may serve a shard of a catalog, answering with rows of the whole catalog, or
+   coordinate shards served by other servers, forwarding every request to them */
+class QueryServer {
+
+	/* Response to a single request, filled by the loop or by a worker */
+	struct Response {
+		std::string text;
+		bool isReady = false;		// Only changed by the loop thread
+	};
+
+	/* State of a single client connection, only touched by the loop thread */
+	struct Connection {
+		socket_t socket;
+		std::string input;			// Received bytes not parsed yet
+		std::string output;			// Responses not sent yet
+		size_t written = 0;			// Bytes of @output already sent
+		std::deque<Response*> responses;	// In the order of requests
+		int inFlight = 0;			// Requests being evaluated by workers
+		bool isClosed = false;
+		bool isWriting = false;		// Watched for writability
+		bool isReloading = false;	// Waits for its RELOAD, requests after it aren't parsed yet
+	};
+
+	/* Notification of a worker which finished a response */
+	struct Completion {
+		int token;
+		Response* response;
+	};
+
+	const ResizableArray<Book>& books;
+	const QueryEngine& engine;
+	ThreadPool& pool;
+	int* byAvailability;			// Rows ordered by available copies, most first, ties by row
+	int rankedRows;					// Rows ordered in @byAvailability
+	const ResizableArray<int>* rowIds;	// Row of every Book in the whole catalog, nullptr if it is the row
+	ShardCoordinator* coordinator;	// Answers the requests instead of the books, nullptr if there are none
+	mutable QueryCache cache;		// Rendered SPHERE responses
+	std::function<int(bool&)> reloader;
+	int followInterval;				// Milliseconds between reloads, 0 only on RELOAD, -1 never
+	std::chrono::steady_clock::time_point nextReload;
+	ResizableArray<Completion> reloadRequests;	// RELOAD requests waiting for the next reload
+	socket_t listener;
+	socket_t wake[2];				// Workers write into [0] to wake the loop reading [1]
+	Net::Poller poller;
+	ResizableArray<Connection*> connections;	// Indexed by token - 2, nullptr if free
+	std::mutex completedLock;
+	ResizableArray<Completion> completed;
+	TaskGroup tasks;
+	bool isStopping;
+	long long served;
+
+	QueryServer(const QueryServer&); // Copy constructor disabled
+
+	/* Accepts every pending connection */
+	void acceptConnections();
+	/* Reads available requests of connection @token and answers them */
+	void readRequests(const int token);
+	/* Answers complete request lines received by connection @token */
+	void parseRequests(const int token);
+	/* Answers a single request @line of connection @token */
+	void handleRequest(const int token, const std::string& line);
+	/* Moves ready responses of @connection into its output and sends as much as possible */
+	void flush(const int token);
+	/* Closes connection @token, frees it once no worker uses it */
+	void closeConnection(const int token);
+	/* Frees connection @token if it is closed and no worker uses it */
+	void releaseConnection(const int token);
+	/* Marks responses finished by workers ready and flushes their connections */
+	void processCompletions();
+	/* Marks @finished responses ready, releases closed connections and flushes the rest */
+	void completeResponses(const ResizableArray<Completion>& finished);
+	/* Waits for running requests, reads appended books and answers pending RELOAD requests */
+	void reload();
+	/* Orders rows from @from on into @byAvailability, merging them with the rows ordered before */
+	void rankRows(const int from);
+
+	/* Evaluates heavy request @line into @text, runs on a worker */
+	void evaluate(const std::string& line, std::string& text) const;
+	/* Appends book line of row @row into @text */
+	void appendBook(std::string& text, const int row) const;
+
+public:
+
+	/* Instantiates a server over @books indexed by @engine, heavy requests run on @pool.
+	   Both must stay unchanged while the server runs, except by the reloader */
+	QueryServer(const ResizableArray<Book>& books, const QueryEngine& engine, ThreadPool& pool = ThreadPool::shared());
+	/* Destructor closes all connections */
+	~QueryServer();
+
+	/* Starts listening on 127.0.0.1:@port (0 picks a free port). Returns false on failure */
+	bool listen(const int port);
+
+	/* Returns the port the server listens on */
+	int getPort() const;
+
+	/* Lets the server reload the catalog: @reloader appends new books to the array the server
+	   was created over, indexes them in the engine and returns their amount (setting its argument
+	   if the array was rebuilt instead). It runs on the loop thread while no request is being
+	   evaluated, every @interval milliseconds (0 means only on RELOAD requests) */
+	void setReloader(const std::function<int(bool& isRebuilt)>& reloader, const int interval);
+
+	/* Makes book lines carry row @rowIds[row] instead of the row of the array, e.g. rows of the
+	   whole catalog when the array is its shard. The rows must ascend and stay unchanged */
+	void setRowIds(const ResizableArray<int>& rowIds);
+
+	/* Forwards requests to shards through @coordinator instead of answering them from the books */
+	void setCoordinator(ShardCoordinator& coordinator);
+
+	/* Runs the event loop until a SHUTDOWN request */
+	void run();
+
+	/* Returns the amount of answered requests */
+	long long getServed() const;
+
+	/* Returns counters of the SPHERE response cache */
+	QueryCacheStats getCacheStats() const;
+
+};
\ No newline at end of file
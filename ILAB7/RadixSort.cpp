@@ -0,0 +1,45 @@
+#include "RadixSort.h"
+
+/* Sorts @n rows by their keys in non-descending order keeping the order of equal keys,
+   @scratch is space for as many rows. Digit counts of all passes are taken in one read of the
+   rows, passes over bits no key uses or where every key has the same digit are skipped, so keys
+   of a few bits take a few passes. Returns the sorted rows, which are either @rows or @scratch */
+RadixRow* radixSort(RadixRow* rows, RadixRow* scratch, const int n) {
+	if (n < 2)
+		return rows;
+	unsigned long long used = 0;
+	for (int i = 0; i < n; ++i)
+		used |= rows[i].key;
+	int passes = 0;
+	for (; passes * RADIX_SORT_BITS < 64 && (used >> (passes * RADIX_SORT_BITS)) != 0; ++passes);
+
+	int* counts = new int[(passes > 0 ? passes : 1) * RADIX_SORT_BUCKETS]();
+	for (int i = 0; i < n; ++i) {
+		unsigned long long key = rows[i].key;
+		for (int p = 0; p < passes; ++p, key >>= RADIX_SORT_BITS)
+			++counts[p * RADIX_SORT_BUCKETS + (key & (RADIX_SORT_BUCKETS - 1))];
+	}
+
+	RadixRow* source = rows;
+	RadixRow* target = scratch;
+	for (int p = 0; p < passes; ++p) {
+		int* count = counts + p * RADIX_SORT_BUCKETS;
+		int shift = p * RADIX_SORT_BITS;
+		// Every key has the same digit, the pass wouldn't change the order
+		if (count[(source[0].key >> shift) & (RADIX_SORT_BUCKETS - 1)] == n)
+			continue;
+		int offset = 0;
+		for (int b = 0; b < RADIX_SORT_BUCKETS; ++b) {
+			int c = count[b];
+			count[b] = offset;
+			offset += c;
+		}
+		for (int i = 0; i < n; ++i)
+			target[count[(source[i].key >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = source[i];
+		RadixRow* swap = source;
+		source = target;
+		target = swap;
+	}
+	delete[] counts;
+	return source;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "ResizableArray.h"
+#include "ThreadPool.h"
+
+#define RADIX_SORT_BITS 8							// Bits of the key ordered by a single pass
+#define RADIX_SORT_BUCKETS (1 << RADIX_SORT_BITS)
+#define RADIX_SORT_GRAIN 16384						// Elements whose keys a single task extracts
+
+/* Indirect LSD radix sort on integer keys.
+   Instead of comparing elements, an integer key is extracted from every element into a packed
+   array together with the element's 32-bit index, the array is sorted by the key bits and only
+   then the elements are rearranged once (or visited in the sorted order of the indices).
+   Sorting takes linear time and no element is copied while it runs. Passes are stable, so
+   elements with equal keys keep their order like with parallelSort */
+
+/* Integer key of an element and the element's index */
+struct RadixRow {
+	unsigned long long key;
+	unsigned int row;
+};
+
+/* Sorts @n rows by their keys in non-descending order keeping the order of equal keys,
+   @scratch is space for as many rows. Digit counts of all passes are taken in one read of the
+   rows, passes over bits no key uses or where every key has the same digit are skipped, so keys
+   of a few bits take a few passes. Returns the sorted rows, which are either @rows or @scratch */
+RadixRow* radixSort(RadixRow* rows, RadixRow* scratch, const int n);
+
+/* Fills @order with indices of @n elements of @arr in non-descending order of their keys
+   @keyOf(element) (an unsigned integer), equal keys in order of the indices.
+   Keys are extracted in parallel on @pool */
+template<class T, class KeyOf>
+void radixOrder(const T* arr, const int n, const KeyOf& keyOf, int* order, ThreadPool& pool = ThreadPool::shared()) {
+	if (n <= 0)
+		return;
+	RadixRow* rows = new RadixRow[n];
+	RadixRow* scratch = new RadixRow[n];
+	parallelFor(pool, 0, n, RADIX_SORT_GRAIN, [arr, rows, &keyOf](int from, int to) {
+		for (int i = from; i < to; ++i) {
+			rows[i].key = keyOf(arr[i]);
+			rows[i].row = (unsigned int)i;
+		}
+	});
+	const RadixRow* sorted = radixSort(rows, scratch, n);
+	for (int i = 0; i < n; ++i)
+		order[i] = (int)sorted[i].row;
+	delete[] rows;
+	delete[] scratch;
+}
+
+/* Sorts @arr in non-descending order of keys @keyOf(element), keeping the order of elements
+   with equal keys. Elements are relocated once, after their keys are sorted */
+template<class T, class KeyOf>
+void radixSort(ResizableArray<T>& arr, const KeyOf& keyOf, ThreadPool& pool = ThreadPool::shared()) {
+	if (arr.getSize() < 2)
+		return;
+	int* order = new int[arr.getSize()];
+	radixOrder(arr.data(), arr.getSize(), keyOf, order, pool);
+	arr.permute(order);
+	delete[] order;
+}
\ No newline at end of file
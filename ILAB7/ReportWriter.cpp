@@ -0,0 +1,69 @@
+#include "ReportWriter.h"
+
+#include <fstream>
+#include <iostream>
+
+/* Instantiates a writer and starts its background thread */
+ReportWriter::ReportWriter() {
+	isClosed = false;
+	failed = 0;
+	writer = std::thread(&ReportWriter::writeLoop, this);
+}
+
+/* Destructor writes the remaining reports */
+ReportWriter::~ReportWriter() {
+	finish();
+}
+
+/* Queues @contents to be written into file @path, takes over the contents buffer */
+void ReportWriter::write(const String& path, std::string& contents) {
+	Job* job = new Job();
+	job->path = path;
+	job->contents.swap(contents);
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		jobs.push_back(job);
+	}
+	ready.notify_one();
+}
+
+/* Waits until every queued report is written and stops the background thread.
+   Returns the amount of reports that couldn't be written */
+int ReportWriter::finish() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		isClosed = true;
+	}
+	ready.notify_one();
+	if (writer.joinable())
+		writer.join();
+	return failed;
+}
+
+/* Writes queued reports until the writer is closed and the queue is empty */
+void ReportWriter::writeLoop() {
+	while (true) {
+		Job* job;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			ready.wait(guard, [this]() { return !jobs.empty() || isClosed; });
+			if (jobs.empty())
+				return;
+			job = jobs.front();
+			jobs.pop_front();
+		}
+		std::ofstream fout(job->path.get());
+		if (!fout.is_open()) {
+			std::cerr << "Can't create output file " << job->path << std::endl;
+			++failed;
+		}
+		else {
+			fout.write(job->contents.data(), job->contents.size());
+			if (!fout.good()) {
+				std::cerr << "Can't write output file " << job->path << std::endl;
+				++failed;
+			}
+		}
+		delete job;
+	}
+}
\ No newline at end of file
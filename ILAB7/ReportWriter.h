@@ -0,0 +1,47 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "String.h"
+
+/* Report Writer class - writes rendered reports to files on a background thread, so
+   rendering of the next report overlaps with writing of the previous one. Reports are
+   written in the order they were queued, each with a single write call */
+class ReportWriter {
+
+	/* Rendered report waiting to be written */
+	struct Job {
+		String path;
+		std::string contents;
+	};
+
+	std::deque<Job*> jobs;
+	std::mutex lock;
+	std::condition_variable ready;
+	bool isClosed;
+	int failed;				// Reports whose file couldn't be written
+	std::thread writer;
+
+	ReportWriter(const ReportWriter&); // Copy constructor disabled
+
+	/* Writes queued reports until the writer is closed and the queue is empty */
+	void writeLoop();
+
+public:
+
+	/* Instantiates a writer and starts its background thread */
+	ReportWriter();
+	/* Destructor writes the remaining reports */
+	~ReportWriter();
+
+	/* Queues @contents to be written into file @path, takes over the contents buffer */
+	void write(const String& path, std::string& contents);
+
+	/* Waits until every queued report is written and stops the background thread.
+	   Returns the amount of reports that couldn't be written */
+	int finish();
+
+};
\ No newline at end of file
@@ -1,22 +1,55 @@
 #pragma once
 #include "Exception.h"
+#include "TypeTraits.h"
+#include "Util.h"
 
+/* Template Resizable Array class - holds elements of type T in a single heap block growing
+   twice when full. Elements are constructed only when the array grows into their slot and are
+   kept after shrinking, so their own resources (e.g. String buffers) are reused by later
+   additions. Growing relocates elements: trivially relocatable types are moved as one block
+   of bytes, trivially copyable ones are copied the same way.
+   operator[] and the iterators don't check bounds outside debug builds (_DEBUG), so loops over
+   the array compile to plain pointer loops; elementAt always checks */
 template<class T>
 class ResizableArray {
 
 	T* arrptr;
 	size_t filled;
+	size_t constructed;		// Slots holding a live T, always >= filled
 	size_t size;
 	static const size_t resizeStep = 8;
 
-	/* Resizes the inner array to fit another @resizeStep(8) elements of type T */
-	void resize() {
-		T* newarrptr = new T[size + resizeStep];
-		for (int i = 0; i < filled; ++i)
-			newarrptr[i] = arrptr[i];
-		size += resizeStep;
-		delete[] arrptr;
+	/* Returns uninitialized memory for @count elements of type T */
+	static T* allocate(const size_t count) {
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+
+	/* Destroys every constructed element and returns the inner array */
+	void release() {
+		Util::destroy(arrptr, constructed);
+		::operator delete(arrptr);
+	}
+
+	/* Moves the stored elements into @newarrptr able to hold @newSize elements and returns the
+	   old inner array to the heap. Slots kept only for reuse are destroyed rather than moved */
+	void replace(T* newarrptr, const size_t newSize) {
+		Util::destroy(arrptr + filled, constructed - filled);
+		Util::relocate(newarrptr, arrptr, filled);
+		::operator delete(arrptr);
 		arrptr = newarrptr;
+		constructed = filled;
+		size = newSize;
+	}
+
+	/* Reallocates the inner array to hold @newSize elements of type T */
+	void resize(const size_t newSize) {
+		replace(allocate(newSize), newSize);
+	}
+
+	/* Returns the size the inner array grows to: double (by at least @resizeStep(8) elements),
+	   so adding n elements one by one takes linear time */
+	size_t grownSize() const {
+		return size < resizeStep ? size + resizeStep : size * 2;
 	}
 
 public:
@@ -25,44 +58,59 @@ public:
 
 	/* Instantiates a Resizable Array of size @resizeStep(8) */
 	ResizableArray() {
-		size = filled = 0;
-		resize();
+		arrptr = nullptr;
+		size = filled = constructed = 0;
+		resize(grownSize());
 	}
 
 	/* Instantiates a Resizable Array able to hold @size elements of type T */
 	ResizableArray(const size_t size) {
-		this->size = size / resizeStep;
-		filled = 0;
-		resize();
+		arrptr = nullptr;
+		this->size = filled = constructed = 0;
+		resize(size > resizeStep ? size : resizeStep);
 	}
 
 	/* Instantiates a Resizable Array able to hold @size elements of type T
 	   filled with @size elements from *arr */
 	ResizableArray(const T* arr, const size_t size) {
-		this->size = size / resizeStep + 1;
-		filled = size;
-		resize();
-		for (int i = 0; i < size; ++i)
-			arrptr[i] = arr[i];
+		this->size = size > resizeStep ? size : resizeStep;
+		arrptr = allocate(this->size);
+		Util::copyConstruct(arrptr, arr, size);
+		filled = constructed = size;
 	}
 
 	/* Copy  constructor */
 	ResizableArray(const ResizableArray& arr) {
-		if (this == &arr)
-			return;
 		size = arr.size;
-		delete[] arrptr;
-		arrptr = new T[size];
-		filled = arr.filled;
-		for (int i = 0; i < filled; ++i)
-			arrptr[i] = arr.arrptr[i];
+		arrptr = allocate(size);
+		Util::copyConstruct(arrptr, arr.arrptr, arr.filled);
+		filled = constructed = arr.filled;
 	}
 
 #pragma endregion
 
+	/* Copies contents of @arr into this Resizable Array */
+	ResizableArray& operator=(const ResizableArray& arr) {
+		if (this == &arr)
+			return *this;
+		if (arr.filled > size) {
+			release();
+			arrptr = allocate(arr.size);
+			size = arr.size;
+			constructed = 0;
+		}
+		size_t assigned = arr.filled < constructed ? arr.filled : constructed;
+		Util::memcpy(arrptr, arr.arrptr, (unsigned int)assigned);
+		Util::copyConstruct(arrptr + assigned, arr.arrptr + assigned, arr.filled - assigned);
+		if (constructed < arr.filled)
+			constructed = arr.filled;
+		filled = arr.filled;
+		return *this;
+	}
+
 	/* Destructor returns allocated memory */
 	~ResizableArray() {
-		delete[] arrptr;
+		release();
 	}
 
 	/* Returns the amount of currently stored elements */
@@ -86,9 +134,38 @@ public:
 	/* Adds another element of type T at the end of the array,
 	   extends ResizableArray if necessary */
 	void add(const T& elem) {
-		if (filled >= size)
-			resize();
-		arrptr[filled++] = elem;
+		if (filled >= size) {
+			// @elem may be stored in this array, so it is copied before the old array is released
+			size_t newSize = grownSize();
+			T* newarrptr = allocate(newSize);
+			new (newarrptr + filled) T(elem);
+			replace(newarrptr, newSize);
+			constructed = ++filled;
+			return;
+		}
+		if (filled < constructed)
+			arrptr[filled] = elem;
+		else new (arrptr + constructed++) T(elem);
+		++filled;
+	}
+
+	/* Makes sure the array is able to hold @capacity elements without reallocating */
+	void reserve(const size_t capacity) {
+		if (capacity > size)
+			resize(capacity);
+	}
+
+	/* Rearranges the elements so the element at @i becomes the one previously at @order[i],
+	   @order holding every index once. Elements are relocated into a new inner array, so
+	   trivially relocatable ones are moved as bytes instead of being copied */
+	void permute(const int* order) {
+		T* newarrptr = allocate(size);
+		Util::destroy(arrptr + filled, constructed - filled);
+		for (size_t i = 0; i < filled; ++i)
+			Util::relocate(newarrptr + i, arrptr + order[i], 1);
+		::operator delete(arrptr);
+		arrptr = newarrptr;
+		constructed = filled;
 	}
 
 	/* Removes last added element if any */
@@ -99,19 +176,75 @@ public:
 
 	/* Return element at @index by reference (mutable) */
 	T& elementAt(const int index) {
-		if (index < 0 || index >= filled)
+		if (index < 0 || (size_t)index >= filled)
 			throw Exception("Index out of range in ResizableArray!", 90, "ResizableArray.h");
 		return arrptr[index];
 	}
 
-	/* Return element at @index by reference (mutable) */
+	/* Immutable version */
+	const T& elementAt(const int index) const {
+		if (index < 0 || (size_t)index >= filled)
+			throw Exception("Index out of range in ResizableArray!", 90, "ResizableArray.h");
+		return arrptr[index];
+	}
+
+	/* Removes all elements, keeps allocated memory */
+	void clear() {
+		filled = 0;
+	}
+
+	/* Shrinks the inner array to the stored elements, slots kept only for reuse are destroyed */
+	void shrink() {
+		if (size > filled)
+			resize(filled);
+	}
+
+	/* Return element at @index by reference (mutable), checked only in debug builds */
 	T& operator[](const int index) {
+#ifdef _DEBUG
 		return elementAt(index);
+#else
+		return arrptr[index];
+#endif
 	}
 
 	/* Immutable version */
 	const T& operator[](const int index) const {
+#ifdef _DEBUG
 		return elementAt(index);
+#else
+		return arrptr[index];
+#endif
+	}
+
+	/* Returns pointer to the first element, the elements are stored contiguously */
+	T* data() {
+		return arrptr;
+	}
+
+	/* Immutable version */
+	const T* data() const {
+		return arrptr;
+	}
+
+	/* Returns random access iterator to the first element */
+	T* begin() {
+		return arrptr;
+	}
+
+	/* Immutable version */
+	const T* begin() const {
+		return arrptr;
+	}
+
+	/* Returns iterator past the last element */
+	T* end() {
+		return arrptr + filled;
+	}
+
+	/* Immutable version */
+	const T* end() const {
+		return arrptr + filled;
 	}
 
 	friend bool operator==(const ResizableArray&, const ResizableArray&);
@@ -0,0 +1,211 @@
+#include "RowSet.h"
+#include "Exception.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Returns the amount of set bits in @word */
+static inline int popCount(unsigned long long word) {
+#if defined(_MSC_VER)
+	return __popcnt((unsigned int)word) + __popcnt((unsigned int)(word >> 32));
+#else
+	return __builtin_popcountll(word);
+#endif
+}
+
+/* Returns index of the lowest set bit in non-zero @word */
+static inline int trailingZeros(unsigned long long word) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)word))
+		return index;
+	_BitScanForward(&index, (unsigned long)(word >> 32));
+	return index + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+/* Instantiates an empty Row Set over zero rows */
+RowSet::RowSet() {
+	words = nullptr;
+	rowCount = wordCount = 0;
+}
+
+/* Instantiates an empty Row Set over @rowCount rows */
+RowSet::RowSet(const int rowCount) {
+	words = nullptr;
+	this->rowCount = wordCount = 0;
+	reset(rowCount);
+}
+
+/* Copy constructor */
+RowSet::RowSet(const RowSet& set) {
+	rowCount = set.rowCount;
+	wordCount = set.wordCount;
+	words = wordCount ? new unsigned long long[wordCount] : nullptr;
+	for (int i = 0; i < wordCount; ++i)
+		words[i] = set.words[i];
+}
+
+/* Destructor returns allocated memory */
+RowSet::~RowSet() {
+	delete[] words;
+}
+
+/* Copies rows of another Row Set */
+RowSet& RowSet::operator=(const RowSet& set) {
+	if (this == &set)
+		return *this;
+	if (wordCount != set.wordCount) {
+		delete[] words;
+		wordCount = set.wordCount;
+		words = wordCount ? new unsigned long long[wordCount] : nullptr;
+	}
+	rowCount = set.rowCount;
+	for (int i = 0; i < wordCount; ++i)
+		words[i] = set.words[i];
+	return *this;
+}
+
+/* Makes this Row Set an empty set over @rowCount rows */
+void RowSet::reset(const int rowCount) {
+	if (rowCount < 0)
+		throw Exception("Invalid argument exception!", 72, "RowSet.cpp", "Row count must not be negative");
+	int newWordCount = (rowCount + 63) / 64;
+	if (newWordCount != wordCount) {
+		delete[] words;
+		wordCount = newWordCount;
+		words = wordCount ? new unsigned long long[wordCount] : nullptr;
+	}
+	this->rowCount = rowCount;
+	clear();
+}
+
+/* Returns the amount of rows this set is defined over */
+int RowSet::getRowCount() const {
+	return rowCount;
+}
+
+/* Clears bits past @rowCount in the last word */
+void RowSet::trimTail() {
+	if (rowCount % 64)
+		words[wordCount - 1] &= (1ULL << (rowCount % 64)) - 1;
+}
+
+/* Removes every row */
+void RowSet::clear() {
+	for (int i = 0; i < wordCount; ++i)
+		words[i] = 0;
+}
+
+/* Adds every row */
+void RowSet::fill() {
+	for (int i = 0; i < wordCount; ++i)
+		words[i] = ~0ULL;
+	trimTail();
+}
+
+/* Adds row @row */
+void RowSet::add(const int row) {
+	words[row >> 6] |= 1ULL << (row & 63);
+}
+
+/* Adds @count rows from array @rows */
+void RowSet::addRows(const int* rows, const int count) {
+	for (int i = 0; i < count; ++i)
+		words[rows[i] >> 6] |= 1ULL << (rows[i] & 63);
+}
+
+/* Returns true if row @row is in the set */
+bool RowSet::contains(const int row) const {
+	if (row < 0 || row >= rowCount)
+		return false;
+	return (words[row >> 6] >> (row & 63)) & 1;
+}
+
+/* Leaves only rows present in both sets */
+void RowSet::intersect(const RowSet& set) {
+	if (set.rowCount != rowCount)
+		throw Exception("Invalid argument exception!", 128, "RowSet.cpp", "Row sets are defined over different rows");
+	unsigned long long* __restrict dest = words;
+	const unsigned long long* __restrict source = set.words;
+	for (int i = 0; i < wordCount; ++i)
+		dest[i] &= source[i];
+}
+
+/* Adds rows of another set */
+void RowSet::unite(const RowSet& set) {
+	if (set.rowCount != rowCount)
+		throw Exception("Invalid argument exception!", 138, "RowSet.cpp", "Row sets are defined over different rows");
+	unsigned long long* __restrict dest = words;
+	const unsigned long long* __restrict source = set.words;
+	for (int i = 0; i < wordCount; ++i)
+		dest[i] |= source[i];
+}
+
+/* Removes rows of another set */
+void RowSet::subtract(const RowSet& set) {
+	if (set.rowCount != rowCount)
+		throw Exception("Invalid argument exception!", 148, "RowSet.cpp", "Row sets are defined over different rows");
+	unsigned long long* __restrict dest = words;
+	const unsigned long long* __restrict source = set.words;
+	for (int i = 0; i < wordCount; ++i)
+		dest[i] &= ~source[i];
+}
+
+/* Replaces the set by its complement */
+void RowSet::complement() {
+	for (int i = 0; i < wordCount; ++i)
+		words[i] = ~words[i];
+	trimTail();
+}
+
+/* Returns the amount of rows in the set */
+int RowSet::count() const {
+	int c = 0;
+	for (int i = 0; i < wordCount; ++i)
+		c += popCount(words[i]);
+	return c;
+}
+
+/* Returns the first row in the set not less than @from or -1 if there is none */
+int RowSet::next(const int from) const {
+	if (from < 0 || from >= rowCount)
+		return -1;
+	int w = from >> 6;
+	unsigned long long word = words[w] & (~0ULL << (from & 63));
+	while (word == 0) {
+		if (++w >= wordCount)
+			return -1;
+		word = words[w];
+	}
+	return (w << 6) + trailingZeros(word);
+}
+
+/* Appends rows of the set into @rows in ascending order */
+void RowSet::toRows(ResizableArray<int>& rows) const {
+	for (int w = 0; w < wordCount; ++w) {
+		unsigned long long word = words[w];
+		while (word) {
+			rows.add((w << 6) + trailingZeros(word));
+			word &= word - 1;
+		}
+	}
+}
+
+/* Returns immutable pointer to the underlying words, 64 rows per word */
+const unsigned long long* RowSet::getWords() const {
+	return words;
+}
+
+/* Mutable version */
+unsigned long long* RowSet::getWords() {
+	return words;
+}
+
+/* Returns the amount of underlying words */
+int RowSet::getWordCount() const {
+	return wordCount;
+}
\ No newline at end of file
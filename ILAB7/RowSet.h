@@ -0,0 +1,74 @@
+#pragma once
+#include "ResizableArray.h"
+
+/* Row Set class - a bitmap over rows 0..rowCount-1 of a Book array. Used as posting list
+   and query result representation. Set operations work on whole 64 bit words so
+   compilers are able to vectorize them */
+class RowSet {
+
+	unsigned long long* words;
+	int rowCount;
+	int wordCount;
+
+	/* Clears bits past @rowCount in the last word */
+	void trimTail();
+
+public:
+
+	/* Instantiates an empty Row Set over zero rows */
+	RowSet();
+	/* Instantiates an empty Row Set over @rowCount rows */
+	RowSet(const int rowCount);
+	/* Copy constructor */
+	RowSet(const RowSet&);
+	/* Destructor returns allocated memory */
+	~RowSet();
+
+	/* Copies rows of another Row Set */
+	RowSet& operator=(const RowSet&);
+
+	/* Makes this Row Set an empty set over @rowCount rows */
+	void reset(const int rowCount);
+
+	/* Returns the amount of rows this set is defined over */
+	int getRowCount() const;
+
+	/* Removes every row */
+	void clear();
+	/* Adds every row */
+	void fill();
+
+	/* Adds row @row */
+	void add(const int row);
+	/* Adds @count rows from array @rows */
+	void addRows(const int* rows, const int count);
+	/* Returns true if row @row is in the set */
+	bool contains(const int row) const;
+
+	/* Leaves only rows present in both sets */
+	void intersect(const RowSet&);
+	/* Adds rows of another set */
+	void unite(const RowSet&);
+	/* Removes rows of another set */
+	void subtract(const RowSet&);
+	/* Replaces the set by its complement */
+	void complement();
+
+	/* Returns the amount of rows in the set */
+	int count() const;
+
+	/* Returns the first row in the set not less than @from or -1 if there is none */
+	int next(const int from) const;
+
+	/* Appends rows of the set into @rows in ascending order */
+	void toRows(ResizableArray<int>& rows) const;
+
+	/* Returns immutable pointer to the underlying words, 64 rows per word */
+	const unsigned long long* getWords() const;
+	/* Mutable version */
+	unsigned long long* getWords();
+
+	/* Returns the amount of underlying words */
+	int getWordCount() const;
+
+};
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "ShardCoordinator.h"
+#include "HashMap.h"
+#include "QueryServer.h"
+#include "String.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/* Cursor over the book lines of a single "+<n>" response */
+struct BookLines {
+	const char* line;		// Start of the current line
+	const char* end;
+	long row;
+	long count;				// Available copies of the current line
+
+	/* Starts at the first book line of @response */
+	void start(const std::string& response) {
+		line = response.c_str();
+		end = line + response.size();
+		const char* header = (const char*)memchr(line, '\n', end - line);
+		line = header != nullptr ? header + 1 : end;
+		parse();
+	}
+
+	/* Returns true if there are no more lines */
+	bool isDone() const {
+		return line >= end;
+	}
+
+	/* Returns length of the current line with its line break */
+	size_t getLength() const {
+		const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+		return (lineEnd != nullptr ? lineEnd + 1 : end) - line;
+	}
+
+	/* Reads row and available copies (the first and the last fields) of the current line */
+	void parse() {
+		if (isDone())
+			return;
+		row = std::strtol(line, nullptr, 10);
+		const char* last = line + getLength() - 1;
+		while (last > line && *last != '\t')
+			--last;
+		count = std::strtol(last + 1, nullptr, 10);
+	}
+
+	/* Moves to the next line */
+	void advance() {
+		line += getLength();
+		parse();
+	}
+};
+
+/* Returns shard (0 to @shards - 1) of @book picked by hash of its identity: author, title and year */
+int getShardOf(const Book& book, const int shards) {
+	unsigned int h = Util::hash(book.getAuthor());
+	h = h * 31 ^ Util::hash(book.getTitle());
+	h = Util::hash((int)(h ^ Util::hash(book.getPublicationYear())));
+	return (int)(h % (unsigned int)shards);
+}
+
+/* Keeps the Books of @books from @from on which belong to shard @shard of @shards, moving them
+   down in order, and adds their rows in the whole catalog to @rowIds. @nextRow is the row of the
+   whole catalog Book @from has, it is moved past the examined Books */
+void keepShard(ResizableArray<Book>& books, const int from, const int shard, const int shards,
+	ResizableArray<int>& rowIds, int& nextRow) {
+	int write = from;
+	for (int read = from; read < books.getSize(); ++read, ++nextRow)
+		if (getShardOf(books[read], shards) == shard) {
+			if (write != read)
+				books[write] = books[read];
+			rowIds.add(nextRow);
+			++write;
+		}
+	while (books.getSize() > write)
+		books.removeLast();
+}
+
+/* Instantiates a coordinator of shards served on localhost @ports, shard i on port i */
+ShardCoordinator::ShardCoordinator(const ResizableArray<int>& ports) : ports(ports) {
+}
+
+/* Destructor closes the connections */
+ShardCoordinator::~ShardCoordinator() {
+	for (int i = 0; i < idle.getSize(); ++i)
+		closeLink(idle[i]);
+}
+
+/* Checks every shard answers. Returns false if a shard can't be reached */
+bool ShardCoordinator::connect() {
+	if (!Net::startup())
+		return false;
+	Link link;
+	if (!takeLink(link))
+		return false;
+	std::string* responses = new std::string[ports.getSize()];
+	bool isOk = scatter(link, "PING", responses);
+	delete[] responses;
+	if (isOk)
+		returnLink(link);
+	else closeLink(link);
+	return isOk;
+}
+
+/* Returns the amount of shards */
+int ShardCoordinator::getShardCount() const {
+	return ports.getSize();
+}
+
+/* Returns a link to every shard, connecting a new one if none is idle. Returns false on failure */
+bool ShardCoordinator::takeLink(Link& link) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!idle.isEmpty()) {
+			link = idle[idle.getSize() - 1];
+			idle.removeLast();
+			return true;
+		}
+	}
+	link.sockets = new socket_t[ports.getSize()];
+	link.readers = new Net::LineReader*[ports.getSize()];
+	for (int i = 0; i < ports.getSize(); ++i) {
+		link.sockets[i] = Net::connectLocal(ports[i]);
+		link.readers[i] = link.sockets[i] != NET_INVALID_SOCKET ? new Net::LineReader(link.sockets[i]) : nullptr;
+	}
+	for (int i = 0; i < ports.getSize(); ++i)
+		if (link.sockets[i] == NET_INVALID_SOCKET) {
+			closeLink(link);
+			return false;
+		}
+	return true;
+}
+
+/* Returns @link to the idle ones */
+void ShardCoordinator::returnLink(const Link& link) {
+	std::lock_guard<std::mutex> guard(lock);
+	idle.add(link);
+}
+
+/* Closes the connections of @link */
+void ShardCoordinator::closeLink(const Link& link) {
+	for (int i = 0; i < ports.getSize(); ++i)
+		if (link.sockets[i] != NET_INVALID_SOCKET) {
+			Net::close(link.sockets[i]);
+			delete link.readers[i];
+		}
+	delete[] link.sockets;
+	delete[] link.readers;
+}
+
+/* Sends request @line to every shard over @link and reads their responses into @responses.
+   Returns false if a shard can't be reached */
+bool ShardCoordinator::scatter(const Link& link, const std::string& line, std::string* responses) {
+	// Every shard gets the request before any response is read, so the shards work at once
+	std::string request = line + "\n";
+	for (int i = 0; i < ports.getSize(); ++i)
+		if (!Net::sendAll(link.sockets[i], request.data(), (int)request.size()))
+			return false;
+	for (int i = 0; i < ports.getSize(); ++i)
+		if (!readResponse(*link.readers[i], responses[i]))
+			return false;
+	return true;
+}
+
+/* Evaluates request @line on the shards and merges their responses into @text */
+void ShardCoordinator::evaluate(const std::string& line, std::string& text) {
+	Link link;
+	if (!takeLink(link)) {
+		text = "-Shards can't be reached\n";
+		return;
+	}
+	std::string* responses = new std::string[ports.getSize()];
+	if (!scatter(link, line, responses)) {
+		closeLink(link);
+		delete[] responses;
+		text = "-Shards can't be reached\n";
+		return;
+	}
+	returnLink(link);
+
+	size_t space = line.find(' ');
+	std::string command = line.substr(0, space);
+	int failed = -1;
+	for (int i = 0; i < ports.getSize() && failed == -1; ++i)
+		if (responses[i].empty() || responses[i][0] == '-')
+			failed = i;
+	if (failed != -1)
+		text = responses[failed];
+	else if (command == "SPHERE" || command == "QUERY")
+		mergeRows(responses, text);
+	else if (command == "TOP")
+		mergeTop(responses, std::strtol(line.c_str() + space + 1, nullptr, 10), text);
+	else if (command == "BEST")
+		mergeTop(responses, 1, text);
+	else if (command == "SPHERES")
+		mergeSpheres(responses, text);
+	else mergeCounts(responses, text);
+	delete[] responses;
+}
+
+/* Merges book lines of @responses into @text in ascending rows */
+void ShardCoordinator::mergeRows(std::string* responses, std::string& text) const {
+	BookLines* cursors = new BookLines[ports.getSize()];
+	long total = 0;
+	for (int i = 0; i < ports.getSize(); ++i) {
+		cursors[i].start(responses[i]);
+		total += std::strtol(responses[i].c_str() + 1, nullptr, 10);
+	}
+	std::string rows;
+	while (true) {
+		int first = -1;
+		for (int i = 0; i < ports.getSize(); ++i)
+			if (!cursors[i].isDone() && (first == -1 || cursors[i].row < cursors[first].row))
+				first = i;
+		if (first == -1)
+			break;
+		rows.append(cursors[first].line, cursors[first].getLength());
+		cursors[first].advance();
+	}
+	delete[] cursors;
+	text = "+" + std::to_string(total) + "\n" + rows;
+}
+
+/* Merges book lines of @responses into @text by available copies, most first, up to @limit */
+void ShardCoordinator::mergeTop(std::string* responses, const long limit, std::string& text) const {
+	// Every shard ordered its lines the same way, ties by row
+	BookLines* cursors = new BookLines[ports.getSize()];
+	for (int i = 0; i < ports.getSize(); ++i)
+		cursors[i].start(responses[i]);
+	std::string rows;
+	long found = 0;
+	while (found < limit) {
+		int first = -1;
+		for (int i = 0; i < ports.getSize(); ++i)
+			if (!cursors[i].isDone() && (first == -1 || cursors[i].count > cursors[first].count
+				|| (cursors[i].count == cursors[first].count && cursors[i].row < cursors[first].row)))
+				first = i;
+		if (first == -1)
+			break;
+		rows.append(cursors[first].line, cursors[first].getLength());
+		cursors[first].advance();
+		++found;
+	}
+	delete[] cursors;
+	text = "+" + std::to_string(found) + "\n" + rows;
+}
+
+/* Sums numbers of responses "=<number>" of @responses into @text */
+void ShardCoordinator::mergeCounts(std::string* responses, std::string& text) const {
+	long long total = 0;
+	for (int i = 0; i < ports.getSize(); ++i)
+		total += std::strtoll(responses[i].c_str() + 1, nullptr, 10);
+	text = "=" + std::to_string(total) + "\n";
+}
+
+/* Sums sphere counts of @responses into @text */
+void ShardCoordinator::mergeSpheres(std::string* responses, std::string& text) const {
+	HashMap<String, int> counts;
+	ResizableArray<String> names;
+	String name;
+	for (int i = 0; i < ports.getSize(); ++i) {
+		const char* line = responses[i].c_str();
+		const char* end = line + responses[i].size();
+		line = (const char*)memchr(line, '\n', end - line) + 1;
+		while (line < end) {
+			const char* tab = (const char*)memchr(line, '\t', end - line);
+			const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+			if (tab == nullptr || lineEnd == nullptr || tab > lineEnd)
+				break;
+			name.set(line, (int)(tab - line));
+			if (!counts.contains(name))
+				names.add(name);
+			counts[name] += std::atoi(tab + 1);
+			line = lineEnd + 1;
+		}
+	}
+	std::sort(names.begin(), names.end(), [](const String& a, const String& b) {
+		return std::strcmp(a.get(), b.get()) < 0;
+	});
+	text = "+" + std::to_string(names.getSize()) + "\n";
+	for (int i = 0; i < names.getSize(); ++i) {
+		text += names[i].get();
+		text += '\t';
+		text += std::to_string(counts[names[i]]);
+		text += '\n';
+	}
+}
\ No newline at end of file
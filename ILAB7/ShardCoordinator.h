@@ -0,0 +1,77 @@
+#pragma once
+#include <mutex>
+#include <string>
+
+#include "Book.h"
+#include "ResizableArray.h"
+#include "Socket.h"
+
+#define SHARD_MAX_COUNT 64		// Most shards a catalog is split into
+
+/* Returns shard (0 to @shards - 1) of @book picked by hash of its identity: author, title and year */
+int getShardOf(const Book& book, const int shards);
+
+/* Keeps the Books of @books from @from on which belong to shard @shard of @shards, moving them
+   down in order, and adds their rows in the whole catalog to @rowIds. @nextRow is the row of the
+   whole catalog Book @from has, it is moved past the examined Books */
+void keepShard(ResizableArray<Book>& books, const int from, const int shard, const int shards,
+	ResizableArray<int>& rowIds, int& nextRow);
+
+/* Shard Coordinator class - answers Query Server requests over a catalog split into shards,
+   every shard served by its own Query Server (usually a separate process) on localhost.
+   A request is scattered to every shard at once and the partial results are gathered:
+   rows of SPHERE and QUERY are merged in the order of rows, TOP and BEST are merged by
+   available copies (ties by row), counts of COUNT, RELOAD and SPHERES are summed.
+   Shards answer with rows of the whole catalog, so the merged responses are the ones
+   a single server over the whole catalog gives.
+   Many threads may evaluate requests at once, every one takes its own set of connections */
+class ShardCoordinator {
+
+	/* Connections to every shard, used by one request at a time */
+	struct Link {
+		socket_t* sockets;
+		Net::LineReader** readers;
+	};
+
+	ResizableArray<int> ports;
+	std::mutex lock;
+	ResizableArray<Link> idle;		// Links not used by any request
+
+	ShardCoordinator(const ShardCoordinator&); // Copy constructor disabled
+
+	/* Returns a link to every shard, connecting a new one if none is idle. Returns false on failure */
+	bool takeLink(Link& link);
+	/* Returns @link to the idle ones */
+	void returnLink(const Link& link);
+	/* Closes the connections of @link */
+	void closeLink(const Link& link);
+	/* Sends request @line to every shard over @link and reads their responses into @responses.
+	   Returns false if a shard can't be reached */
+	bool scatter(const Link& link, const std::string& line, std::string* responses);
+
+	/* Merges book lines of @responses into @text in ascending rows */
+	void mergeRows(std::string* responses, std::string& text) const;
+	/* Merges book lines of @responses into @text by available copies, most first, up to @limit */
+	void mergeTop(std::string* responses, const long limit, std::string& text) const;
+	/* Sums numbers of responses "=<number>" of @responses into @text */
+	void mergeCounts(std::string* responses, std::string& text) const;
+	/* Sums sphere counts of @responses into @text */
+	void mergeSpheres(std::string* responses, std::string& text) const;
+
+public:
+
+	/* Instantiates a coordinator of shards served on localhost @ports, shard i on port i */
+	ShardCoordinator(const ResizableArray<int>& ports);
+	/* Destructor closes the connections */
+	~ShardCoordinator();
+
+	/* Checks every shard answers. Returns false if a shard can't be reached */
+	bool connect();
+
+	/* Returns the amount of shards */
+	int getShardCount() const;
+
+	/* Evaluates request @line on the shards and merges their responses into @text */
+	void evaluate(const std::string& line, std::string& text);
+
+};
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "Sketches.h"
+#include "Util.h"
+
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Returns the amount of zero bits above the highest set bit of non-zero @word */
+static inline int leadingZeros(unsigned long long word) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(word >> 32)))
+		return 31 - index;
+	_BitScanReverse(&index, (unsigned long)word);
+	return 63 - index;
+#else
+	return __builtin_clzll(word);
+#endif
+}
+
+/* Instantiates a sketch of an empty stream */
+HyperLogLog::HyperLogLog() {
+	for (int i = 0; i < (1 << SKETCH_HLL_PRECISION); ++i)
+		registers[i] = 0;
+}
+
+/* Adds key with 64 bit hash @hash */
+void HyperLogLog::add(const unsigned long long hash) {
+	int index = (int)(hash >> (64 - SKETCH_HLL_PRECISION));
+	unsigned long long rest = hash << SKETCH_HLL_PRECISION;
+	unsigned char run = rest == 0 ? 64 - SKETCH_HLL_PRECISION + 1 : (unsigned char)(leadingZeros(rest) + 1);
+	if (run > registers[index])
+		registers[index] = run;
+}
+
+/* Adds keys of @sketch */
+void HyperLogLog::merge(const HyperLogLog& sketch) {
+	for (int i = 0; i < (1 << SKETCH_HLL_PRECISION); ++i)
+		if (sketch.registers[i] > registers[i])
+			registers[i] = sketch.registers[i];
+}
+
+/* Returns estimated amount of distinct keys */
+double HyperLogLog::estimate() const {
+	const double m = 1 << SKETCH_HLL_PRECISION;
+	double sum = 0;
+	int zeros = 0;
+	for (int i = 0; i < (1 << SKETCH_HLL_PRECISION); ++i) {
+		sum += std::ldexp(1.0, -registers[i]);
+		if (registers[i] == 0)
+			++zeros;
+	}
+	double raw = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	// Few keys leave registers empty, counting them is more precise then
+	if (raw <= 2.5 * m && zeros > 0)
+		return m * std::log(m / zeros);
+	return raw;
+}
+
+/* Returns relative standard error of the estimates */
+double HyperLogLog::getStandardError() {
+	return 1.04 / std::sqrt((double)(1 << SKETCH_HLL_PRECISION));
+}
+
+/* Instantiates a sketch of an empty stream */
+CountMinSketch::CountMinSketch() {
+	for (int row = 0; row < SKETCH_CM_DEPTH; ++row)
+		for (int i = 0; i < SKETCH_CM_WIDTH; ++i)
+			counters[row][i] = 0;
+	total = 0;
+}
+
+/* Returns counter of row @row the key with hash @hash adds to */
+int CountMinSketch::slotOf(const unsigned long long hash, const int row) {
+	// Rows pick counters by independent enough combinations of both halves of the hash
+	unsigned int low = (unsigned int)hash, high = (unsigned int)(hash >> 32) | 1;
+	return (int)((low + (unsigned int)row * high) % SKETCH_CM_WIDTH);
+}
+
+/* Adds @count occurrences of key with hash @hash, returns its new estimate */
+unsigned long long CountMinSketch::add(const unsigned long long hash, const unsigned long long count) {
+	unsigned long long estimate = 0;
+	for (int row = 0; row < SKETCH_CM_DEPTH; ++row) {
+		unsigned long long& counter = counters[row][slotOf(hash, row)];
+		counter += count;
+		if (row == 0 || counter < estimate)
+			estimate = counter;
+	}
+	total += count;
+	return estimate;
+}
+
+/* Returns estimated occurrences of key with hash @hash */
+unsigned long long CountMinSketch::estimate(const unsigned long long hash) const {
+	unsigned long long estimate = counters[0][slotOf(hash, 0)];
+	for (int row = 1; row < SKETCH_CM_DEPTH; ++row)
+		if (counters[row][slotOf(hash, row)] < estimate)
+			estimate = counters[row][slotOf(hash, row)];
+	return estimate;
+}
+
+/* Adds occurrences counted by @sketch */
+void CountMinSketch::merge(const CountMinSketch& sketch) {
+	for (int row = 0; row < SKETCH_CM_DEPTH; ++row)
+		for (int i = 0; i < SKETCH_CM_WIDTH; ++i)
+			counters[row][i] += sketch.counters[row][i];
+	total += sketch.total;
+}
+
+/* Returns the amount of all occurrences */
+unsigned long long CountMinSketch::getTotal() const {
+	return total;
+}
+
+/* Returns how much an estimate may exceed the true count (with probability 1 - e^-depth) */
+double CountMinSketch::getErrorBound() const {
+	return std::exp(1.0) / SKETCH_CM_WIDTH * total;
+}
+
+/* Instantiates an empty summary */
+HeavyHitters::HeavyHitters() : keys(SKETCH_HEAVY_HITTERS), estimates(SKETCH_HEAVY_HITTERS), slots(SKETCH_HEAVY_HITTERS) {
+	smallest = -1;
+}
+
+/* Finds the smallest kept estimate */
+void HeavyHitters::findSmallest() {
+	smallest = 0;
+	for (int i = 1; i < estimates.getSize(); ++i)
+		if (estimates[i] < estimates[smallest])
+			smallest = i;
+}
+
+/* Keeps @key with estimate @estimate if it is among the largest ones */
+void HeavyHitters::track(const String& key, const unsigned long long estimate) {
+	int* slot = slots.find(key);
+	if (slot != nullptr) {
+		estimates[*slot] = estimate;
+		if (*slot == smallest)
+			findSmallest();
+		return;
+	}
+	if (keys.getSize() < SKETCH_HEAVY_HITTERS) {
+		slots[key] = keys.getSize();
+		keys.add(key);
+		estimates.add(estimate);
+		if (keys.getSize() == SKETCH_HEAVY_HITTERS)
+			findSmallest();
+		return;
+	}
+	if (estimate <= estimates[smallest])
+		return;
+	slots.remove(keys[smallest]);
+	slots[key] = smallest;
+	keys[smallest] = key;
+	estimates[smallest] = estimate;
+	findSmallest();
+}
+
+/* Counts an occurrence of @key */
+void HeavyHitters::add(const String& key) {
+	track(key, counts.add(Util::hash64(key)));
+}
+
+/* Adds occurrences counted by @hitters */
+void HeavyHitters::merge(const HeavyHitters& hitters) {
+	counts.merge(hitters.counts);
+	// Kept keys of both are estimated again over the merged counts
+	for (int i = 0; i < estimates.getSize(); ++i)
+		estimates[i] = counts.estimate(Util::hash64(keys[i]));
+	if (keys.getSize() == SKETCH_HEAVY_HITTERS)
+		findSmallest();
+	for (int i = 0; i < hitters.keys.getSize(); ++i)
+		track(hitters.keys[i], counts.estimate(Util::hash64(hitters.keys[i])));
+}
+
+/* Returns the amount of kept keys */
+int HeavyHitters::getSize() const {
+	return keys.getSize();
+}
+
+/* Returns kept key @index */
+const String& HeavyHitters::getKey(const int index) const {
+	return keys[index];
+}
+
+/* Returns estimated occurrences of kept key @index */
+unsigned long long HeavyHitters::getEstimate(const int index) const {
+	return counts.estimate(Util::hash64(keys[index]));
+}
+
+/* Returns the sketch counting every key */
+const CountMinSketch& HeavyHitters::getCounts() const {
+	return counts;
+}
+
+/* Ratio of the bounds of neighbouring buckets */
+static const double quantileGamma = (1 + SKETCH_QUANTILE_ACCURACY) / (1 - SKETCH_QUANTILE_ACCURACY);
+static const double quantileLogGamma = std::log(quantileGamma);
+
+/* Instantiates a sketch of an empty stream */
+QuantileSketch::QuantileSketch() {
+	for (int i = 0; i < SKETCH_QUANTILE_BUCKETS; ++i)
+		buckets[i] = 0;
+	count = 0;
+	minimum = maximum = 0;
+}
+
+/* Returns bucket of @value */
+int QuantileSketch::bucketOf(const unsigned int value) {
+	if (value == 0)
+		return 0;
+	int bucket = (int)std::ceil(std::log((double)value) / quantileLogGamma) + 1;
+	return bucket < SKETCH_QUANTILE_BUCKETS ? bucket : SKETCH_QUANTILE_BUCKETS - 1;
+}
+
+/* Adds @value */
+void QuantileSketch::add(const unsigned int value) {
+	++buckets[bucketOf(value)];
+	if (count == 0 || value < minimum)
+		minimum = value;
+	if (count == 0 || value > maximum)
+		maximum = value;
+	++count;
+}
+
+/* Adds values of @sketch */
+void QuantileSketch::merge(const QuantileSketch& sketch) {
+	if (sketch.count == 0)
+		return;
+	for (int i = 0; i < SKETCH_QUANTILE_BUCKETS; ++i)
+		buckets[i] += sketch.buckets[i];
+	if (count == 0 || sketch.minimum < minimum)
+		minimum = sketch.minimum;
+	if (count == 0 || sketch.maximum > maximum)
+		maximum = sketch.maximum;
+	count += sketch.count;
+}
+
+/* Returns the amount of values */
+unsigned long long QuantileSketch::getCount() const {
+	return count;
+}
+
+/* Returns estimated @q quantile (0 is the smallest value, 1 the largest), 0 if there are no values */
+unsigned int QuantileSketch::getQuantile(const double q) const {
+	if (count == 0)
+		return 0;
+	if (q <= 0)
+		return minimum;
+	if (q >= 1)
+		return maximum;
+	unsigned long long rank = (unsigned long long)(q * (count - 1));
+	unsigned long long seen = 0;
+	int bucket = 0;
+	while ((seen += buckets[bucket]) <= rank)
+		++bucket;
+	if (bucket == 0)
+		return 0;
+	// The middle of the bucket is within the accuracy of both its bounds
+	double value = 2 * std::pow(quantileGamma, bucket - 1) / (quantileGamma + 1);
+	unsigned int rounded = value >= maximum ? maximum : (unsigned int)(value + 0.5);
+	return rounded < minimum ? minimum : rounded;
+}
+
+/* Instantiates a sketch of no Books */
+CatalogSketch::CatalogSketch() {
+	books = 0;
+}
+
+/* Adds @book */
+void CatalogSketch::add(const Book& book) {
+	++books;
+	authors.add(Util::hash64(book.getAuthor()));
+	titles.add(Util::hash64(book.getTitle()));
+	const String* names = book.getSpheres();
+	for (int i = 0; i < book.getSpheresCount(); ++i) {
+		spheres.add(Util::hash64(names[i]));
+		sphereCounts.add(names[i]);
+	}
+	amounts.add((unsigned int)book.getCurrentAmount());
+}
+
+/* Adds Books summarized by @sketch */
+void CatalogSketch::merge(const CatalogSketch& sketch) {
+	books += sketch.books;
+	authors.merge(sketch.authors);
+	titles.merge(sketch.titles);
+	spheres.merge(sketch.spheres);
+	sphereCounts.merge(sketch.sphereCounts);
+	amounts.merge(sketch.amounts);
+}
+
+/* Returns the amount of added Books */
+long long CatalogSketch::getBookCount() const {
+	return books;
+}
+
+/* Returns estimated amount of distinct authors */
+double CatalogSketch::getAuthorCount() const {
+	return authors.estimate();
+}
+
+/* Returns estimated amount of distinct titles */
+double CatalogSketch::getTitleCount() const {
+	return titles.estimate();
+}
+
+/* Returns estimated amount of distinct spheres */
+double CatalogSketch::getSphereCount() const {
+	return spheres.estimate();
+}
+
+/* Returns the most covered spheres with their estimated amounts of Books */
+const HeavyHitters& CatalogSketch::getTopSpheres() const {
+	return sphereCounts;
+}
+
+/* Returns quantiles of available copies */
+const QuantileSketch& CatalogSketch::getAmounts() const {
+	return amounts;
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+#include "Book.h"
+#include "HashMap.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+#define SKETCH_HLL_PRECISION 14			// HyperLogLog has 2^14 one byte registers, 0.81% standard error
+#define SKETCH_CM_WIDTH 2048			// Count-Min counters per row, estimates exceed counts by up to e / 2048 of the total
+#define SKETCH_CM_DEPTH 4				// Count-Min rows, the bound holds with probability 1 - e^-4 (98%)
+#define SKETCH_HEAVY_HITTERS 64			// Most frequent keys tracked by Heavy Hitters
+#define SKETCH_QUANTILE_ACCURACY 0.01	// Relative error of quantiles
+#define SKETCH_QUANTILE_BUCKETS 1120	// Enough buckets of the accuracy for every unsigned int
+
+/* Hyper Log Log class - estimates the amount of distinct keys of a stream in fixed memory.
+   Every register keeps the longest run of leading zero bits among hashes falling into it.
+   Merging registers of two streams gives exactly the registers of both streams together */
+class HyperLogLog {
+
+	unsigned char registers[1 << SKETCH_HLL_PRECISION];
+
+public:
+
+	/* Instantiates a sketch of an empty stream */
+	HyperLogLog();
+
+	/* Adds key with 64 bit hash @hash */
+	void add(const unsigned long long hash);
+
+	/* Adds keys of @sketch */
+	void merge(const HyperLogLog& sketch);
+
+	/* Returns estimated amount of distinct keys */
+	double estimate() const;
+
+	/* Returns relative standard error of the estimates */
+	static double getStandardError();
+
+};
+
+/* Count-Min Sketch class - estimates how many times every key occurred in a stream in fixed
+   memory. Every key adds to one counter of every row, its estimate is the smallest of them:
+   never less than the true count and, with high probability, more by at most getErrorBound() */
+class CountMinSketch {
+
+	unsigned long long counters[SKETCH_CM_DEPTH][SKETCH_CM_WIDTH];
+	unsigned long long total;
+
+	/* Returns counter of row @row the key with hash @hash adds to */
+	static int slotOf(const unsigned long long hash, const int row);
+
+public:
+
+	/* Instantiates a sketch of an empty stream */
+	CountMinSketch();
+
+	/* Adds @count occurrences of key with hash @hash, returns its new estimate */
+	unsigned long long add(const unsigned long long hash, const unsigned long long count = 1);
+
+	/* Returns estimated occurrences of key with hash @hash */
+	unsigned long long estimate(const unsigned long long hash) const;
+
+	/* Adds occurrences counted by @sketch */
+	void merge(const CountMinSketch& sketch);
+
+	/* Returns the amount of all occurrences */
+	unsigned long long getTotal() const;
+
+	/* Returns how much an estimate may exceed the true count (with probability 1 - e^-depth) */
+	double getErrorBound() const;
+
+};
+
+/* Heavy Hitters class - the most frequent keys of a stream in fixed memory. A Count-Min sketch
+   counts every key, the SKETCH_HEAVY_HITTERS keys with the largest estimates are kept.
+   A key counted more than getErrorBound() plus the smallest kept estimate is always kept */
+class HeavyHitters {
+
+	CountMinSketch counts;
+	ResizableArray<String> keys;
+	ResizableArray<unsigned long long> estimates;	// Estimate of every kept key when it was last counted
+	HashMap<String, int> slots;						// Kept key to its index
+	int smallest;					// Index of the smallest estimate once every slot is taken
+
+	/* Keeps @key with estimate @estimate if it is among the largest ones */
+	void track(const String& key, const unsigned long long estimate);
+	/* Finds the smallest kept estimate */
+	void findSmallest();
+
+public:
+
+	/* Instantiates an empty summary */
+	HeavyHitters();
+
+	/* Counts an occurrence of @key */
+	void add(const String& key);
+
+	/* Adds occurrences counted by @hitters */
+	void merge(const HeavyHitters& hitters);
+
+	/* Returns the amount of kept keys */
+	int getSize() const;
+
+	/* Returns kept key @index */
+	const String& getKey(const int index) const;
+
+	/* Returns estimated occurrences of kept key @index */
+	unsigned long long getEstimate(const int index) const;
+
+	/* Returns the sketch counting every key */
+	const CountMinSketch& getCounts() const;
+
+};
+
+/* Quantile Sketch class - estimates quantiles of a stream of unsigned values in fixed memory.
+   Values are counted in buckets growing geometrically, so every estimate is within
+   SKETCH_QUANTILE_ACCURACY of a value of the requested rank relative to it. Merging adds
+   the buckets, which gives exactly the sketch of both streams together */
+class QuantileSketch {
+
+	unsigned long long buckets[SKETCH_QUANTILE_BUCKETS];	// 0 counts zeros, i > 0 values up to gamma^(i - 1)
+	unsigned long long count;
+	unsigned int minimum;
+	unsigned int maximum;
+
+	/* Returns bucket of @value */
+	static int bucketOf(const unsigned int value);
+
+public:
+
+	/* Instantiates a sketch of an empty stream */
+	QuantileSketch();
+
+	/* Adds @value */
+	void add(const unsigned int value);
+
+	/* Adds values of @sketch */
+	void merge(const QuantileSketch& sketch);
+
+	/* Returns the amount of values */
+	unsigned long long getCount() const;
+
+	/* Returns estimated @q quantile (0 is the smallest value, 1 the largest), 0 if there are no values */
+	unsigned int getQuantile(const double q) const;
+
+};
+
+/* Catalog Sketch class - fixed memory summary of a stream of Books, filled while parsing, so
+   an endless feed can be summarized without keeping the Books: distinct authors, titles and
+   spheres, the most covered spheres and quantiles of available copies. Sketches of parts of
+   a stream parsed apart (e.g. in parallel) merge into the sketch of the whole stream */
+class CatalogSketch {
+
+	long long books;
+	HyperLogLog authors;
+	HyperLogLog titles;
+	HyperLogLog spheres;
+	HeavyHitters sphereCounts;
+	QuantileSketch amounts;
+
+public:
+
+	/* Instantiates a sketch of no Books */
+	CatalogSketch();
+
+	/* Adds @book */
+	void add(const Book& book);
+
+	/* Adds Books summarized by @sketch */
+	void merge(const CatalogSketch& sketch);
+
+	/* Returns the amount of added Books */
+	long long getBookCount() const;
+
+	/* Returns estimated amount of distinct authors */
+	double getAuthorCount() const;
+
+	/* Returns estimated amount of distinct titles */
+	double getTitleCount() const;
+
+	/* Returns estimated amount of distinct spheres */
+	double getSphereCount() const;
+
+	/* Returns the most covered spheres with their estimated amounts of Books */
+	const HeavyHitters& getTopSpheres() const;
+
+	/* Returns quantiles of available copies */
+	const QuantileSketch& getAmounts() const;
+
+};
\ No newline at end of file
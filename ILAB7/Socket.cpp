@@ -0,0 +1,328 @@
+#include "Socket.h"
+
+#ifdef _WIN32
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include <cstring>
+
+/* Returns true if the last socket call failed only because it would block */
+static bool wouldBlock() {
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/* Fills @address with 127.0.0.1:@port */
+static void makeLocalAddress(sockaddr_in& address, const int port) {
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons((unsigned short)port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+}
+
+/* Disables Nagle's algorithm on @socket, small pipelined responses go out at once */
+static void setNoDelay(const socket_t socket) {
+	int flag = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag));
+}
+
+/* Initializes the socket library (WSAStartup on Windows). Returns false on failure */
+bool Net::startup() {
+#ifdef _WIN32
+	WSADATA data;
+	return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+	signal(SIGPIPE, SIG_IGN); // Writing to a closed connection must not kill the server
+	return true;
+#endif
+}
+
+/* Closes @socket */
+void Net::close(const socket_t socket) {
+#ifdef _WIN32
+	closesocket(socket);
+#else
+	::close(socket);
+#endif
+}
+
+/* Switches @socket into non-blocking mode. Returns false on failure */
+bool Net::setNonBlocking(const socket_t socket) {
+#ifdef _WIN32
+	u_long mode = 1;
+	return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+/* Returns a socket listening on 127.0.0.1:@port (0 picks a free port) or NET_INVALID_SOCKET */
+socket_t Net::listenLocal(const int port) {
+	socket_t listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener == NET_INVALID_SOCKET)
+		return NET_INVALID_SOCKET;
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+	sockaddr_in address;
+	makeLocalAddress(address, port);
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+		close(listener);
+		return NET_INVALID_SOCKET;
+	}
+	return listener;
+}
+
+/* Returns the port @socket is bound to, or -1 */
+int Net::getPort(const socket_t socket) {
+	sockaddr_in address;
+	socklen_t length = sizeof(address);
+	if (getsockname(socket, (sockaddr*)&address, &length) != 0)
+		return -1;
+	return ntohs(address.sin_port);
+}
+
+/* Returns a blocking socket connected to 127.0.0.1:@port or NET_INVALID_SOCKET */
+socket_t Net::connectLocal(const int port) {
+	socket_t connection = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (connection == NET_INVALID_SOCKET)
+		return NET_INVALID_SOCKET;
+	sockaddr_in address;
+	makeLocalAddress(address, port);
+	if (connect(connection, (sockaddr*)&address, sizeof(address)) != 0) {
+		close(connection);
+		return NET_INVALID_SOCKET;
+	}
+	setNoDelay(connection);
+	return connection;
+}
+
+/* Accepts a pending connection of @listener, returns NET_INVALID_SOCKET if there is none */
+socket_t Net::accept(const socket_t listener) {
+	socket_t connection = ::accept(listener, nullptr, nullptr);
+	if (connection != NET_INVALID_SOCKET)
+		setNoDelay(connection);
+	return connection;
+}
+
+/* Creates two connected sockets in @pair (over loopback, so it works everywhere).
+   Returns false on failure */
+bool Net::makePair(socket_t pair[2]) {
+	socket_t listener = listenLocal(0);
+	if (listener == NET_INVALID_SOCKET)
+		return false;
+	pair[0] = connectLocal(getPort(listener));
+	pair[1] = pair[0] != NET_INVALID_SOCKET ? accept(listener) : NET_INVALID_SOCKET;
+	close(listener);
+	if (pair[1] == NET_INVALID_SOCKET) {
+		if (pair[0] != NET_INVALID_SOCKET)
+			close(pair[0]);
+		return false;
+	}
+	return true;
+}
+
+/* Sends up to @length bytes of @data. Returns the amount sent, 0 if the socket would
+   block and -1 on error */
+int Net::send(const socket_t socket, const char* data, const int length) {
+#ifdef MSG_NOSIGNAL
+	int sent = ::send(socket, data, length, MSG_NOSIGNAL);
+#else
+	int sent = ::send(socket, data, length, 0);
+#endif
+	if (sent < 0)
+		return wouldBlock() ? 0 : -1;
+	return sent;
+}
+
+/* Receives up to @length bytes into @buffer. Returns the amount received, 0 if the socket
+   would block and -1 on error or when the peer closed the connection */
+int Net::receive(const socket_t socket, char* buffer, const int length) {
+	int received = ::recv(socket, buffer, length, 0);
+	if (received < 0)
+		return wouldBlock() ? 0 : -1;
+	return received == 0 ? -1 : received;
+}
+
+/* Sends all @length bytes of @data over a blocking socket. Returns false on error */
+bool Net::sendAll(const socket_t socket, const char* data, const int length) {
+	int sent = 0;
+	while (sent < length) {
+		int chunk = send(socket, data + sent, length - sent);
+		if (chunk < 0)
+			return false;
+		sent += chunk;
+	}
+	return true;
+}
+
+/* Instantiates a reader of @socket */
+Net::LineReader::LineReader(const socket_t socket) {
+	this->socket = socket;
+	start = end = 0;
+}
+
+/* Reads the next line into @line without the line break. Returns false if the connection closed */
+bool Net::LineReader::readLine(std::string& line) {
+	line.clear();
+	while (true) {
+		for (int i = start; i < end; ++i)
+			if (buffer[i] == '\n') {
+				line.append(buffer + start, i - start);
+				start = i + 1;
+				return true;
+			}
+		line.append(buffer + start, end - start);
+		start = end = 0;
+		int received = receive(socket, buffer, sizeof(buffer));
+		if (received <= 0)
+			return false;
+		end = received;
+	}
+}
+
+#pragma region Poller
+
+#ifdef __linux__
+
+/* Instantiates a poller with no sockets */
+Net::Poller::Poller() {
+	epoll = epoll_create1(0);
+}
+
+/* Destructor releases the poller */
+Net::Poller::~Poller() {
+	::close(epoll);
+}
+
+/* Starts watching @socket for reading (and writing if @isWriting), events carry @token */
+void Net::Poller::add(const socket_t socket, const int token, const bool isWriting) {
+	epoll_event event;
+	event.events = EPOLLIN | (isWriting ? EPOLLOUT : 0);
+	event.data.u64 = 0;
+	event.data.u32 = (unsigned int)token;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, socket, &event);
+}
+
+/* Changes whether @socket is watched for writing */
+void Net::Poller::modify(const socket_t socket, const int token, const bool isWriting) {
+	epoll_event event;
+	event.events = EPOLLIN | (isWriting ? EPOLLOUT : 0);
+	event.data.u64 = 0;
+	event.data.u32 = (unsigned int)token;
+	epoll_ctl(epoll, EPOLL_CTL_MOD, socket, &event);
+}
+
+/* Stops watching @socket */
+void Net::Poller::remove(const socket_t socket) {
+	epoll_event event;
+	epoll_ctl(epoll, EPOLL_CTL_DEL, socket, &event);
+}
+
+/* Waits up to @timeout milliseconds (-1 is forever) and fills @events.
+   Returns the amount of events */
+int Net::Poller::wait(const int timeout, ResizableArray<PollEvent>& events) {
+	epoll_event ready[64];
+	events.clear();
+	int count = epoll_wait(epoll, ready, 64, timeout);
+	for (int i = 0; i < count; ++i) {
+		PollEvent event;
+		event.token = (int)ready[i].data.u32;
+		event.isReadable = (ready[i].events & EPOLLIN) != 0;
+		event.isWritable = (ready[i].events & EPOLLOUT) != 0;
+		event.isClosed = (ready[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+		events.add(event);
+	}
+	return events.getSize();
+}
+
+#else
+
+/* Instantiates a poller with no sockets */
+Net::Poller::Poller() {
+}
+
+/* Destructor releases the poller */
+Net::Poller::~Poller() {
+}
+
+/* Starts watching @socket for reading (and writing if @isWriting), events carry @token */
+void Net::Poller::add(const socket_t socket, const int token, const bool isWriting) {
+	sockets.add(socket);
+	tokens.add(token);
+	interests.add((short)(POLLIN | (isWriting ? POLLOUT : 0)));
+}
+
+/* Changes whether @socket is watched for writing */
+void Net::Poller::modify(const socket_t socket, const int token, const bool isWriting) {
+	for (int i = 0; i < sockets.getSize(); ++i)
+		if (sockets[i] == socket) {
+			tokens[i] = token;
+			interests[i] = (short)(POLLIN | (isWriting ? POLLOUT : 0));
+		}
+}
+
+/* Stops watching @socket */
+void Net::Poller::remove(const socket_t socket) {
+	for (int i = 0; i < sockets.getSize(); ++i)
+		if (sockets[i] == socket) {
+			int last = sockets.getSize() - 1;
+			sockets[i] = sockets[last];
+			tokens[i] = tokens[last];
+			interests[i] = interests[last];
+			sockets.removeLast();
+			tokens.removeLast();
+			interests.removeLast();
+			return;
+		}
+}
+
+/* Waits up to @timeout milliseconds (-1 is forever) and fills @events.
+   Returns the amount of events */
+int Net::Poller::wait(const int timeout, ResizableArray<PollEvent>& events) {
+	events.clear();
+	int count = sockets.getSize();
+	pollfd* fds = new pollfd[count > 0 ? count : 1];
+	for (int i = 0; i < count; ++i) {
+		fds[i].fd = sockets[i];
+		fds[i].events = interests[i];
+		fds[i].revents = 0;
+	}
+#ifdef _WIN32
+	int ready = WSAPoll(fds, count, timeout);
+#else
+	int ready = poll(fds, count, timeout);
+#endif
+	for (int i = 0; i < count && ready > 0; ++i) {
+		if (fds[i].revents == 0)
+			continue;
+		PollEvent event;
+		event.token = tokens[i];
+		event.isReadable = (fds[i].revents & POLLIN) != 0;
+		event.isWritable = (fds[i].revents & POLLOUT) != 0;
+		event.isClosed = (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+		events.add(event);
+	}
+	delete[] fds;
+	return events.getSize();
+}
+
+#endif
+
+#pragma endregion
\ No newline at end of file
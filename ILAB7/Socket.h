@@ -0,0 +1,119 @@
+#pragma once
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define NET_INVALID_SOCKET INVALID_SOCKET
+#else
+typedef int socket_t;
+#define NET_INVALID_SOCKET (-1)
+#endif
+
+#include <string>
+
+#include "ResizableArray.h"
+
+/* Thin portable layer over Winsock and POSIX sockets, only localhost TCP is used */
+namespace Net {
+
+	/* Initializes the socket library (WSAStartup on Windows). Returns false on failure */
+	bool startup();
+
+	/* Closes @socket */
+	void close(const socket_t socket);
+
+	/* Switches @socket into non-blocking mode. Returns false on failure */
+	bool setNonBlocking(const socket_t socket);
+
+	/* Returns a socket listening on 127.0.0.1:@port (0 picks a free port) or NET_INVALID_SOCKET */
+	socket_t listenLocal(const int port);
+
+	/* Returns the port @socket is bound to, or -1 */
+	int getPort(const socket_t socket);
+
+	/* Returns a blocking socket connected to 127.0.0.1:@port or NET_INVALID_SOCKET */
+	socket_t connectLocal(const int port);
+
+	/* Accepts a pending connection of @listener, returns NET_INVALID_SOCKET if there is none */
+	socket_t accept(const socket_t listener);
+
+	/* Creates two connected sockets in @pair (over loopback, so it works everywhere).
+	   Returns false on failure */
+	bool makePair(socket_t pair[2]);
+
+	/* Sends up to @length bytes of @data. Returns the amount sent, 0 if the socket would
+	   block and -1 on error */
+	int send(const socket_t socket, const char* data, const int length);
+
+	/* Receives up to @length bytes into @buffer. Returns the amount received, 0 if the socket
+	   would block and -1 on error or when the peer closed the connection */
+	int receive(const socket_t socket, char* buffer, const int length);
+
+	/* Sends all @length bytes of @data over a blocking socket. Returns false on error */
+	bool sendAll(const socket_t socket, const char* data, const int length);
+
+	/* Line Reader class - reads lines from a blocking socket through a buffer */
+	class LineReader {
+
+		socket_t socket;
+		char buffer[65536];
+		int start;
+		int end;
+
+		LineReader(const LineReader&); // Copy constructor disabled
+
+	public:
+
+		/* Instantiates a reader of @socket */
+		LineReader(const socket_t socket);
+
+		/* Reads the next line into @line without the line break. Returns false if the connection closed */
+		bool readLine(std::string& line);
+
+	};
+
+	/* Event reported by Poller for a registered socket */
+	struct PollEvent {
+		int token;			// Token the socket was registered with
+		bool isReadable;
+		bool isWritable;
+		bool isClosed;		// Error or hang up
+	};
+
+	/* Poller class - waits for readiness of many sockets at once.
+	   Uses epoll on Linux and poll (WSAPoll on Windows) elsewhere */
+	class Poller {
+
+#ifdef __linux__
+		int epoll;
+#else
+		ResizableArray<socket_t> sockets;
+		ResizableArray<int> tokens;
+		ResizableArray<short> interests;
+#endif
+
+		Poller(const Poller&); // Copy constructor disabled
+
+	public:
+
+		/* Instantiates a poller with no sockets */
+		Poller();
+		/* Destructor releases the poller */
+		~Poller();
+
+		/* Starts watching @socket for reading (and writing if @isWriting), events carry @token */
+		void add(const socket_t socket, const int token, const bool isWriting);
+
+		/* Changes whether @socket is watched for writing */
+		void modify(const socket_t socket, const int token, const bool isWriting);
+
+		/* Stops watching @socket */
+		void remove(const socket_t socket);
+
+		/* Waits up to @timeout milliseconds (-1 is forever) and fills @events.
+		   Returns the amount of events */
+		int wait(const int timeout, ResizableArray<PollEvent>& events);
+
+	};
+
+}
\ No newline at end of file
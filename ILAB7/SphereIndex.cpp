@@ -0,0 +1,158 @@
+#include "SphereIndex.h"
+#include "Exception.h"
+
+/* Instantiates an empty Sphere Index */
+SphereIndex::SphereIndex() {
+	offsets.add(0);
+}
+
+/* Rebuilds this index from the array of Books @books */
+void SphereIndex::build(const ResizableArray<Book>& books) {
+	ids.clear();
+	names.clear();
+	offsets.clear();
+	rows.clear();
+
+	// First pass assigns ids and counts rows of every sphere
+	ResizableArray<int> counts;
+	int c = books.getSize();
+	for (int i = 0; i < c; ++i) {
+		const String* spheres = books[i].getSpheres();
+		int sc = books[i].getSpheresCount();
+		for (int g = 0; g < sc; ++g) {
+			int* id = ids.find(spheres[g]);
+			if (id == nullptr) {
+				ids[spheres[g]] = names.getSize();
+				names.add(spheres[g]);
+				counts.add(1);
+			}
+			else counts[*id]++;
+		}
+	}
+
+	int total = 0;
+	for (int i = 0; i < counts.getSize(); ++i) {
+		offsets.add(total);
+		total += counts[i];
+		counts[i] = offsets[i];
+	}
+	offsets.add(total);
+	for (int i = 0; i < total; ++i)
+		rows.add(-1);
+
+	// Second pass places rows, books listing the same sphere twice are placed once
+	for (int i = 0; i < c; ++i) {
+		const String* spheres = books[i].getSpheres();
+		int sc = books[i].getSpheresCount();
+		for (int g = 0; g < sc; ++g) {
+			int id = *ids.find(spheres[g]);
+			if (counts[id] > offsets[id] && rows[counts[id] - 1] == i)
+				continue;
+			rows[counts[id]++] = i;
+		}
+	}
+
+	// Close gaps left by duplicate spheres
+	int write = 0;
+	for (int id = 0; id < names.getSize(); ++id) {
+		int begin = offsets[id];
+		offsets[id] = write;
+		for (int i = begin; i < counts[id]; ++i)
+			rows[write++] = rows[i];
+	}
+	offsets[names.getSize()] = write;
+	while (rows.getSize() > write)
+		rows.removeLast();
+}
+
+/* Adds rows from @from up to the end of the array of Books @books, which has only grown
+   since the index was built. Row lists stay ascending, old rows are moved but not re-read */
+void SphereIndex::append(const ResizableArray<Book>& books, const int from) {
+	int oldSphereCount = names.getSize();
+	ResizableArray<int> added;		// New rows of every sphere
+	ResizableArray<int> lastRow;	// Last new row counted for every sphere, books listing a sphere twice count once
+	for (int id = 0; id < oldSphereCount; ++id) {
+		added.add(0);
+		lastRow.add(-1);
+	}
+
+	int c = books.getSize();
+	for (int i = from; i < c; ++i) {
+		const String* spheres = books[i].getSpheres();
+		int sc = books[i].getSpheresCount();
+		for (int g = 0; g < sc; ++g) {
+			int* id = ids.find(spheres[g]);
+			if (id == nullptr) {
+				ids[spheres[g]] = names.getSize();
+				names.add(spheres[g]);
+				added.add(0);
+				lastRow.add(-1);
+				id = ids.find(spheres[g]);
+			}
+			if (lastRow[*id] == i)
+				continue;
+			lastRow[*id] = i;
+			added[*id]++;
+		}
+	}
+
+	// Every old list is copied to its new place followed by room for its new rows
+	ResizableArray<int> newOffsets(names.getSize() + 1);
+	ResizableArray<int> newRows(rows.getSize() + c - from);
+	ResizableArray<int> cursors(names.getSize());
+	for (int id = 0; id < names.getSize(); ++id) {
+		newOffsets.add(newRows.getSize());
+		if (id < oldSphereCount)
+			for (int r = offsets[id]; r < offsets[id + 1]; ++r)
+				newRows.add(rows[r]);
+		cursors.add(newRows.getSize());
+		for (int r = 0; r < added[id]; ++r)
+			newRows.add(-1);
+		lastRow[id] = -1;
+	}
+	newOffsets.add(newRows.getSize());
+
+	for (int i = from; i < c; ++i) {
+		const String* spheres = books[i].getSpheres();
+		int sc = books[i].getSpheresCount();
+		for (int g = 0; g < sc; ++g) {
+			int id = *ids.find(spheres[g]);
+			if (lastRow[id] == i)
+				continue;
+			lastRow[id] = i;
+			newRows[cursors[id]++] = i;
+		}
+	}
+	offsets = newOffsets;
+	rows = newRows;
+}
+
+/* Returns the amount of distinct spheres */
+int SphereIndex::getSphereCount() const {
+	return names.getSize();
+}
+
+/* Returns id of sphere @sphere or -1 if no Book covers it */
+int SphereIndex::findSphere(const String& sphere) const {
+	const int* id = ids.find(sphere);
+	return id == nullptr ? -1 : *id;
+}
+
+/* Returns name of the sphere with id @id */
+const String& SphereIndex::getSphereName(const int id) const {
+	return names[id];
+}
+
+/* Returns the amount of Books covering the sphere with id @id */
+int SphereIndex::getRowCount(const int id) const {
+	if (id < 0 || id >= names.getSize())
+		throw Exception("Sphere id out of range!", 82, "SphereIndex.cpp");
+	return offsets[id + 1] - offsets[id];
+}
+
+/* Returns immutable pointer to ascending rows of Books covering the sphere with id @id */
+const int* SphereIndex::getRows(const int id) const {
+	if (id < 0 || id >= names.getSize())
+		throw Exception("Sphere id out of range!", 89, "SphereIndex.cpp");
+	return getRowCount(id) ? &rows[offsets[id]] : nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "Book.h"
+#include "HashMap.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+/* Sphere Index class - maps every sphere met in an array of Books to the list of rows
+   (indexes in that array) of Books covering it. Built once and then shared by
+   any amount of sphere queries. Row lists are stored consecutively in ascending order */
+class SphereIndex {
+
+	HashMap<String, int> ids;		// Sphere name to sphere id
+	ResizableArray<String> names;	// Sphere id to sphere name
+	ResizableArray<int> offsets;	// Sphere id to the first position of its rows in @rows
+	ResizableArray<int> rows;		// Row lists of all spheres one after another
+
+public:
+
+	/* Instantiates an empty Sphere Index */
+	SphereIndex();
+
+	/* Rebuilds this index from the array of Books @books */
+	void build(const ResizableArray<Book>& books);
+
+	/* Adds rows from @from up to the end of the array of Books @books, which has only grown
+	   since the index was built. Row lists stay ascending, old rows are moved but not re-read */
+	void append(const ResizableArray<Book>& books, const int from);
+
+	/* Returns the amount of distinct spheres */
+	int getSphereCount() const;
+
+	/* Returns id of sphere @sphere or -1 if no Book covers it */
+	int findSphere(const String& sphere) const;
+
+	/* Returns name of the sphere with id @id */
+	const String& getSphereName(const int id) const;
+
+	/* Returns the amount of Books covering the sphere with id @id */
+	int getRowCount(const int id) const;
+
+	/* Returns immutable pointer to ascending rows of Books covering the sphere with id @id */
+	const int* getRows(const int id) const;
+
+};
\ No newline at end of file
@@ -3,36 +3,136 @@
 #include "Exception.h"
 
 #include <iostream>
+#include <new>
+
+/* Buffer of every empty String made without characters, it is never returned */
+static struct {
+	StringBuffer header;
+	char chars[sizeof(StringBuffer)];
+} emptyBuffer = { { { -1 }, 0 }, { '\0' } };
+
+bool String::isSharing = true;
+
+/* Returns ASCII lower case of @c as unsigned, other bytes unchanged (like tolower in "C" locale) */
+static inline unsigned char foldChar(const char c) {
+	unsigned char u = (unsigned char)c;
+	return u >= 'A' && u <= 'Z' ? u + ('a' - 'A') : u;
+}
 
 /* Unparameterized constructor instantiates empty C-string */
 String::String() {
 	length = 0;
-	str = new char[length + 1];
-	str[length] = '\0';
+	str = emptyBuffer.chars;
+	sortKey = 0;
+	isKeyValid = true;
 }
 
 /* Parameterized constructor copies argumenent C-string */
 String::String(const char* newstr) {
-	if (newstr == str)
-		return;
 	length = newstr == nullptr ? 0 : Util::strlen(newstr);
-	str = new char[length + 1];
-	Util::strcpy(str, newstr);
+	str = emptyBuffer.chars;
+	if (length != 0) {
+		str = allocate(length);
+		Util::strcpy(str, newstr);
+	}
+	updateSortKey();
 }
 
-/* Copy constructor copies another String */
+/* Copy constructor shares the characters of another String */
 String::String(const String& string) {
-	if (this == &string)
-		return;
-	length = string.length;
-	str = new char[length + 1];
-	Util::strcpy(str, string.str);
+	str = emptyBuffer.chars;
+	share(string);
 }
 
 /* Destructor return allocated memory */
 String::~String() {
-	if (str != nullptr)
-		delete[] str;
+	release();
+}
+
+/* Returns header of the buffer */
+StringBuffer* String::getBuffer() const {
+	return reinterpret_cast<StringBuffer*>(str) - 1;
+}
+
+/* Returns true if no other String shares the buffer */
+bool String::isUnique() const {
+	// Acquire pairs with the release of other Strings, their reads of the characters are done
+	return getBuffer()->references.load(std::memory_order_acquire) == 1;
+}
+
+/* Returns characters of a new buffer able to hold @capacity characters */
+char* String::allocate(const size_t capacity) {
+	StringBuffer* buffer = static_cast<StringBuffer*>(::operator new(sizeof(StringBuffer) + capacity + 1));
+	new (&buffer->references) std::atomic<int>(1);
+	buffer->capacity = capacity;
+	return reinterpret_cast<char*>(buffer + 1);
+}
+
+/* Drops the reference to the buffer, returns it if no other String shares it */
+void String::release() {
+	StringBuffer* buffer = getBuffer();
+	if (buffer->references.load(std::memory_order_relaxed) < 0)
+		return;
+	if (buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		buffer->references.~atomic();
+		::operator delete(buffer);
+	}
+}
+
+/* Makes the buffer unshared and able to hold @capacity characters, keeping the characters */
+void String::detach(const size_t capacity) {
+	bool isOwned = isUnique();
+	size_t current = getBuffer()->capacity;
+	if (isOwned && capacity <= current)
+		return;
+	// Growing an own buffer doubles it, so Strings appended by characters don't reallocate every time
+	size_t target = isOwned && capacity < current * 2 ? current * 2 : capacity;
+	char* newstr = allocate(target);
+	for (size_t i = 0; i <= length; ++i)
+		newstr[i] = str[i];
+	release();
+	str = newstr;
+}
+
+/* Makes this String hold the characters of @string, sharing them if it may */
+void String::share(const String& string) {
+	char* newstr;
+	if (isSharing && string.isKeyValid) {
+		StringBuffer* buffer = string.getBuffer();
+		if (buffer->references.load(std::memory_order_relaxed) >= 0)
+			buffer->references.fetch_add(1, std::memory_order_relaxed);
+		newstr = string.str;
+	}
+	else {
+		newstr = emptyBuffer.chars;
+		if (string.length != 0) {
+			newstr = allocate(string.length);
+			for (size_t i = 0; i <= string.length; ++i)
+				newstr[i] = string.str[i];
+		}
+	}
+	// The new reference is taken first, so sharing own characters doesn't return them
+	release();
+	str = newstr;
+	length = string.length;
+	sortKey = string.sortKey;
+	isKeyValid = string.isKeyValid;
+}
+
+/* Returns true if other Strings share the characters of this one */
+bool String::isShared() const {
+	return getBuffer()->references.load(std::memory_order_acquire) > 1;
+}
+
+/* Turns sharing of buffers by copies on (the default) or off. Meant to be switched
+   while no String is being copied, e.g. by benchmarks comparing both ways */
+void String::setSharing(const bool isSharing) {
+	String::isSharing = isSharing;
+}
+
+/* Returns true if copies share buffers */
+bool String::getSharing() {
+	return isSharing;
 }
 
 /* Returns String length without terminator */
@@ -49,11 +149,36 @@ const char* String::get() const {
 void String::set(const char* newstr) {
 	if (str == newstr)
 		return;
-	length = newstr == nullptr ? 0 : Util::strlen(newstr);
-	if (str != nullptr)
-		delete[] str;
-	str = new char[length + 1];
-	Util::strcpy(str, newstr);
+	set(newstr, newstr == nullptr ? 0 : Util::strlen(newstr));
+}
+
+/* Copies @length characters from @chars (not necessarily null-terminated).
+   Reuses the buffer if it is large enough, so repeated sets don't allocate */
+void String::set(const char* chars, const int length) {
+	if (!isUnique() || (size_t)length > getBuffer()->capacity) {
+		// Shared characters stay with the other Strings, @chars may be among them
+		char* newstr = allocate(length);
+		for (int i = 0; i < length; ++i)
+			newstr[i] = chars[i];
+		release();
+		str = newstr;
+	}
+	else {
+		for (int i = 0; i < length; ++i)
+			str[i] = chars[i];
+	}
+	str[length] = '\0';
+	this->length = length;
+	updateSortKey();
+}
+
+/* Recomputes @sortKey from the characters */
+void String::updateSortKey() {
+	unsigned long long key = 0;
+	for (size_t i = 0; i < sizeof(key); ++i)
+		key = key << 8 | (i < length ? foldChar(str[i]) : 0);
+	sortKey = key;
+	isKeyValid = true;
 }
 
 /* Copies C-style string recieved as a parameter */
@@ -62,9 +187,10 @@ String& String::operator=(const char* newstr) {
 	return *this;
 }
 
-/* Copies String recieved as a parameter */
+/* Shares the characters of String recieved as a parameter */
 String& String::operator=(const String& string) {
-	set(string.str);
+	if (this != &string)
+		share(string);
 	return *this;
 }
 
@@ -73,7 +199,9 @@ String operator+(const String& str1, const String& str2) {
 	char* newstr = new char[str1.length + str2.length + 1];
 	Util::strcpy(newstr, str1.str);
 	Util::strcat(newstr, str2.str);
-	return String(newstr);
+	String ret = newstr;
+	delete[] newstr;
+	return ret;
 }
 
 /* Appends String with a single character */
@@ -82,31 +210,32 @@ String operator+(const String& string, const char ch) {
 	Util::strcpy(newstr, string.str);
 	newstr[string.length] = ch;
 	newstr[string.length + 1] = '\0';
-	return String(newstr);
+	String ret = newstr;
+	delete[] newstr;
+	return ret;
 }
 
 /* Appends this String with another String */
 String& String::operator+=(const String& string) {
-	char* newstr = new char[length + string.length + 1];
-	Util::strcpy(newstr, str);
-	Util::strcat(newstr, string.str);
-	if (str != nullptr)
-		delete[] str;
-	length += string.length;
-	str = newstr;
+	size_t added = string.length;
+	// Appending a String to itself keeps its characters alive through the copy
+	String kept = this == &string ? string : String();
+	const char* chars = this == &string ? kept.str : string.str;
+	detach(length + added);
+	for (size_t i = 0; i <= added; ++i)
+		str[length + i] = chars[i];
+	length += added;
+	updateSortKey();
 	return *this;
 }
 
 /* Appends this String with a single character */
 String& String::operator+=(const char ch) {
-	char* newstr = new char[length + 2];
-	Util::strcpy(newstr, str);
-	newstr[length] = ch;
-	newstr[length + 1] = '\0';
-	if (str != nullptr)
-		delete[] str;
+	detach(length + 1);
+	str[length] = ch;
+	str[length + 1] = '\0';
 	length++;
-	str = newstr;
+	updateSortKey();
 	return *this;
 }
 
@@ -130,6 +259,8 @@ bool operator!=(const String& str1, const String& str2) {
 char& String::operator[](const int index) {
 	if (index < 0 || index > length)
 		throw Exception("Index out of range in string!", 126, "String.cpp");
+	detach(length);
+	isKeyValid = false;
 	return str[index];
 }
 
@@ -146,32 +277,44 @@ std::ostream& operator<<(std::ostream& out, const String& string) {
 	return out;
 }
 
+/* Compares Strings case insensitively up to the end of the shorter one: returns negative
+   value, zero or positive value if @str1 goes before, together with or after @str2.
+   A String goes together with its prefixes (the order reports are sorted in), except the
+   empty String which goes before any other. Most comparisons are decided by the sort keys */
+int String::compare(const String& str1, const String& str2) {
+	if (str1.length == 0 || str2.length == 0)
+		return (str1.length != 0) - (str2.length != 0);
+	size_t i = 0;
+	if (str1.isKeyValid && str2.isKeyValid) {
+		unsigned long long difference = str1.sortKey ^ str2.sortKey;
+		if (difference != 0) {
+			int shift = 56;
+			while ((difference >> shift & 0xff) == 0)
+				shift -= 8;
+			unsigned int c1 = str1.sortKey >> shift & 0xff, c2 = str2.sortKey >> shift & 0xff;
+			if (c1 == 0 || c2 == 0)
+				return 0; // Zero padding: the shorter String ended, it is a prefix of the other
+			return c1 < c2 ? -1 : 1;
+		}
+		i = sizeof(str1.sortKey);
+	}
+	size_t lim = str1.length < str2.length ? str1.length : str2.length;
+	for (; i < lim; ++i) {
+		unsigned char c1 = foldChar(str1.str[i]), c2 = foldChar(str2.str[i]);
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
+	}
+	return 0;
+}
+
 /* Returns true if @str1 is lexicographically less than @str2 */
 bool operator<(const String& str1, const String& str2) {
-	if (str1.length == 0)
-		return true;
-	int lim = str1.length < str2.length ? str1.length : str2.length;
-	for (int i = 0; i < lim; ++i) {
-		if (tolower(str1.str[i]) < tolower(str2.str[i]))
-			return true;
-		else if (tolower(str1.str[i]) > tolower(str2.str[i]))
-			return false;
-	}
-	return false;
+	return String::compare(str1, str2) < 0;
 }
 
 /* Returns true if @str1 is lexicographically more than @str2 */
 bool operator>(const String& str1, const String& str2) {
-	if (str2.length == 0)
-		return true;
-	int lim = str1.length < str2.length ? str1.length : str2.length;
-	for (int i = 0; i < lim; ++i) {
-		if (tolower(str1.str[i]) > tolower(str2.str[i]))
-			return true;
-		else if (tolower(str1.str[i]) < tolower(str2.str[i]))
-			return false;
-	}
-	return false;
+	return String::compare(str1, str2) > 0;
 }
 
 /* Reads a String until a delimiting character is met */
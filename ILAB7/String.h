@@ -1,13 +1,46 @@
 #pragma once
+#include <atomic>
 #include <iostream>
 
+#include "TypeTraits.h"
+
+/* Header of a String buffer, the characters follow it */
+struct StringBuffer {
+	std::atomic<int> references;	// Strings sharing the buffer, negative for the shared empty buffer
+	size_t capacity;				// Amount of characters the buffer can hold without reallocating
+};
+
 /* String class - holds a C-style string. Designed to make string interaction
    easy. Has most overloaded operators. Is mutable, but changing String size
-   frequently may lead to perfomance drops */
+   frequently may lead to perfomance drops.
+   Copies share the buffer (copy on write): the copy only counts a reference and the
+   characters are duplicated when one of the Strings sharing them is changed. References
+   are counted atomically, so copies of a String may be used and dropped by other threads */
 class String {
 
-	char* str;
+	char* str;			// Characters of a buffer, its StringBuffer header is right before them
 	size_t length;
+	unsigned long long sortKey;	// First 8 case folded characters packed big endian, zero padded
+	bool isKeyValid;	// Cleared by mutable operator[], characters may have changed behind the key,
+						// so such a String is not shared until it is set again
+
+	static bool isSharing;	// Copies share buffers, otherwise every copy duplicates the characters
+
+	/* Recomputes @sortKey from the characters */
+	void updateSortKey();
+
+	/* Returns header of the buffer */
+	StringBuffer* getBuffer() const;
+	/* Returns true if no other String shares the buffer */
+	bool isUnique() const;
+	/* Returns characters of a new buffer able to hold @capacity characters */
+	static char* allocate(const size_t capacity);
+	/* Drops the reference to the buffer, returns it if no other String shares it */
+	void release();
+	/* Makes the buffer unshared and able to hold @capacity characters, keeping the characters */
+	void detach(const size_t capacity);
+	/* Makes this String hold the characters of @string, sharing them if it may */
+	void share(const String& string);
 
 public:
 
@@ -15,7 +48,7 @@ public:
 	String();
 	/* Parameterized constructor copies argumenent C-string */
 	String(const char*);
-	/* Copy constructor copies another String */
+	/* Copy constructor shares the characters of another String */
 	String(const String&);
 	/* Destructor return allocated memory */
 	~String();
@@ -27,10 +60,13 @@ public:
 	const char* get() const;
 	/* Copies C-style string recieved as a parameter */
 	void set(const char*);
+	/* Copies @length characters from @chars (not necessarily null-terminated).
+	   Reuses the buffer if it is large enough, so repeated sets don't allocate */
+	void set(const char* chars, const int length);
 
 	/* Copies C-style string recieved as a parameter */
 	String& operator=(const char*);
-	/* Copies String recieved as a parameter */
+	/* Shares the characters of String recieved as a parameter */
 	String& operator=(const String&);
 
 	/* Concats two Strings */
@@ -49,7 +85,7 @@ public:
 	/* Returns true if two Strings are of the different length or consist of different characters */
 	friend bool operator!=(const String&, const String&);
 
-	/* Returns character at index */
+	/* Returns character at index, the characters stop being shared */
 	char& operator[](const int index);
 
 	/* Immutable version */
@@ -58,6 +94,21 @@ public:
 	/* Outputs String into stream &out */
 	friend std::ostream& operator<<(std::ostream&, const String&);
 
+	/* Compares Strings case insensitively up to the end of the shorter one: returns negative
+	   value, zero or positive value if @str1 goes before, together with or after @str2.
+	   A String goes together with its prefixes (the order reports are sorted in), except the
+	   empty String which goes before any other. Most comparisons are decided by the sort keys */
+	static int compare(const String& str1, const String& str2);
+
+	/* Returns true if other Strings share the characters of this one */
+	bool isShared() const;
+
+	/* Turns sharing of buffers by copies on (the default) or off. Meant to be switched
+	   while no String is being copied, e.g. by benchmarks comparing both ways */
+	static void setSharing(const bool isSharing);
+	/* Returns true if copies share buffers */
+	static bool getSharing();
+
 	/* Returns true if @str1 is lexicographically less than @str2 */
 	friend bool operator<(const String&, const String&);
 	/* Returns true if @str1 is lexicographically more than @str2 */
@@ -71,4 +122,9 @@ void getline(
 	String& string,
 	const unsigned int len = 255,
 	const char delim = '\n'
-);
\ No newline at end of file
+);
+
+/* String holds a reference to a heap buffer and never points into itself, so it is moved as a block of bytes */
+template<>
+struct IsTriviallyRelocatable<String> : std::true_type {
+};
\ No newline at end of file
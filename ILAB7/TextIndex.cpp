@@ -0,0 +1,269 @@
+#include "TextIndex.h"
+#include "Exception.h"
+#include "HashMap.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cctype>
+
+#define TEXT_INDEX_GRAM_SLOTS (1 << 16)
+
+/* Returns the trigram slot of three consecutive characters */
+static inline int gramSlot(const unsigned char a, const unsigned char b, const unsigned char c) {
+	return Util::hash((int)(a << 16 | b << 8 | c)) & (TEXT_INDEX_GRAM_SLOTS - 1);
+}
+
+/* Stores distinct trigram slots of @text padded as "\1\1text\1" into @slots */
+static void collectGramSlots(const char* text, const int length, ResizableArray<int>& slots) {
+	slots.clear();
+	for (int i = -2; i < length - 1; ++i) {
+		unsigned char a = i < 0 ? 1 : text[i];
+		unsigned char b = i + 1 < 0 ? 1 : text[i + 1];
+		unsigned char c = i + 2 >= length ? 1 : text[i + 2];
+		slots.add(gramSlot(a, b, c));
+	}
+	int* begin = slots.data();
+	std::sort(begin, begin + slots.getSize());
+	int* end = std::unique(begin, begin + slots.getSize());
+	while (slots.getSize() > end - begin)
+		slots.removeLast();
+}
+
+/* Returns edit distance between @a and @b if it does not exceed @limit, @limit + 1 otherwise */
+static int boundedDistance(const char* a, const int la, const char* b, const int lb, const int limit) {
+	if (la - lb > limit || lb - la > limit)
+		return limit + 1;
+	int buffer[2 * 256];
+	int* previous = lb < 256 ? buffer : new int[2 * (lb + 1)];
+	int* current = previous + lb + 1;
+	for (int j = 0; j <= lb; ++j)
+		previous[j] = j;
+	int distance = limit + 1;
+	for (int i = 1; i <= la; ++i) {
+		current[0] = i;
+		int rowMin = i;
+		for (int j = 1; j <= lb; ++j) {
+			int cost = previous[j - 1] + (a[i - 1] != b[j - 1]);
+			int del = previous[j] + 1;
+			int ins = current[j - 1] + 1;
+			int best = cost < del ? cost : del;
+			current[j] = best < ins ? best : ins;
+			if (current[j] < rowMin)
+				rowMin = current[j];
+		}
+		int* swap = previous;
+		previous = current;
+		current = swap;
+		if (rowMin > limit)
+			break;
+	}
+	if (previous[lb] <= limit)
+		distance = previous[lb];
+	if (previous != buffer && current != buffer)
+		delete[] (previous < current ? previous : current);
+	return distance;
+}
+
+/* Returns case folded copy of @text with single spaces between words, the form fields are indexed in */
+String TextIndex::fold(const String& text) {
+	String folded = text;
+	Util::trim(folded);
+	char* buffer = new char[folded.getLength() + 1];
+	Util::strcpy(buffer, folded.get());
+	Util::lowerBuffer(buffer, folded.getLength());
+	folded.set(buffer, folded.getLength());
+	delete[] buffer;
+	return folded;
+}
+
+/* Builds index over @field of every Book in @books */
+void TextIndex::FieldIndex::build(const ResizableArray<Book>& books, const TextField field) {
+	pool.clear();
+	valueOffsets.clear();
+	rowOffsets.clear();
+	rows.clear();
+	wordStarts.clear();
+	gramOffsets.clear();
+	gramValues.clear();
+
+	// Distinct folded values and their rows
+	int c = books.getSize();
+	HashMap<String, int> ids(c);
+	ResizableArray<int> valueOfRow(c);
+	ResizableArray<int> counts;
+	for (int i = 0; i < c; ++i) {
+		String value = fold(field == TextField::Author ? books[i].getAuthor() : books[i].getTitle());
+		int* id = ids.find(value);
+		if (id == nullptr) {
+			valueOfRow.add(valueOffsets.getSize());
+			ids[value] = valueOffsets.getSize();
+			valueOffsets.add(pool.getSize());
+			for (int g = 0; g <= value.getLength(); ++g)
+				pool.add(value.get()[g]);
+			counts.add(1);
+		}
+		else {
+			valueOfRow.add(*id);
+			counts[*id]++;
+		}
+	}
+	int valueCount = valueOffsets.getSize();
+	valueOffsets.add(pool.getSize());
+
+	int total = 0;
+	for (int v = 0; v < valueCount; ++v) {
+		rowOffsets.add(total);
+		total += counts[v];
+		counts[v] = rowOffsets[v];
+	}
+	rowOffsets.add(total);
+	rows.reserve(total);
+	for (int i = 0; i < total; ++i)
+		rows.add(0);
+	for (int i = 0; i < c; ++i)
+		rows[counts[valueOfRow[i]]++] = i;
+
+	// Every word start, sorted by the text that follows it
+	for (int v = 0; v < valueCount; ++v)
+		for (int p = valueOffsets[v]; pool[p] != '\0'; ++p)
+			if (p == valueOffsets[v] || pool[p - 1] == ' ')
+				wordStarts.add(p);
+	if (!wordStarts.isEmpty()) {
+		const char* text = pool.data();
+		int* begin = wordStarts.data();
+		std::sort(begin, begin + wordStarts.getSize(), [text](const int a, const int b) {
+			return Util::strcmp(text + a, text + b) < 0;
+		});
+	}
+
+	// Trigram slot to value ids, counted first and placed afterwards
+	ResizableArray<int> slots;
+	ResizableArray<int> slotCounts(TEXT_INDEX_GRAM_SLOTS + 1);
+	for (int s = 0; s <= TEXT_INDEX_GRAM_SLOTS; ++s)
+		slotCounts.add(0);
+	for (int v = 0; v < valueCount; ++v) {
+		collectGramSlots(&pool[valueOffsets[v]], valueOffsets[v + 1] - valueOffsets[v] - 1, slots);
+		for (int s = 0; s < slots.getSize(); ++s)
+			slotCounts[slots[s]]++;
+	}
+	total = 0;
+	for (int s = 0; s < TEXT_INDEX_GRAM_SLOTS; ++s) {
+		gramOffsets.add(total);
+		total += slotCounts[s];
+		slotCounts[s] = gramOffsets[s];
+	}
+	gramOffsets.add(total);
+	gramValues.reserve(total);
+	for (int i = 0; i < total; ++i)
+		gramValues.add(0);
+	for (int v = 0; v < valueCount; ++v) {
+		collectGramSlots(&pool[valueOffsets[v]], valueOffsets[v + 1] - valueOffsets[v] - 1, slots);
+		for (int s = 0; s < slots.getSize(); ++s)
+			gramValues[slotCounts[slots[s]]++] = v;
+	}
+}
+
+const TextIndex::FieldIndex& TextIndex::getField(const TextField field) const {
+	return field == TextField::Author ? authors : titles;
+}
+
+/* Rebuilds the index over the array of Books @books */
+void TextIndex::build(const ResizableArray<Book>& books) {
+	authors.build(books, TextField::Author);
+	titles.build(books, TextField::Title);
+}
+
+/* Appends to @rows at most @limit distinct rows of Books whose @field has a word starting
+   with @prefix (case insensitive), in alphabetical order of the matched text.
+   @limit of -1 means no limit. Returns the amount of appended rows */
+int TextIndex::findPrefix(const TextField field, const String& prefix, const int limit, ResizableArray<int>& rows) const {
+	const FieldIndex& index = getField(field);
+	String folded = fold(prefix);
+	int length = folded.getLength();
+	if (index.wordStarts.isEmpty() || length == 0 || limit == 0)
+		return 0;
+
+	const char* text = index.pool.data();
+	const int* begin = index.wordStarts.data();
+	const int* end = begin + index.wordStarts.getSize();
+	const char* key = folded.get();
+	const int* first = std::lower_bound(begin, end, 0, [text, key, length](const int position, const int) {
+		return Util::strncmp(text + position, key, length) < 0;
+	});
+
+	int appended = 0;
+	HashMap<int, int> seen;
+	for (const int* itr = first; itr != end && Util::strncmp(text + *itr, key, length) == 0; ++itr) {
+		// Value owning the word is the last one starting at or before it
+		const int* value = std::upper_bound(index.valueOffsets.data(), index.valueOffsets.end(), *itr) - 1;
+		int v = value - index.valueOffsets.data();
+		if (seen.contains(v))
+			continue;
+		seen[v] = 1;
+		for (int r = index.rowOffsets[v]; r < index.rowOffsets[v + 1]; ++r) {
+			if (limit != -1 && appended >= limit)
+				return appended;
+			rows.add(index.rows[r]);
+			++appended;
+		}
+	}
+	return appended;
+}
+
+/* Appends to @matches at most @limit rows of Books whose @field differs from @text by
+   at most @maxDistance (up to TEXT_INDEX_MAX_DISTANCE) single character edits, closest first.
+   @limit of -1 means no limit. Returns the amount of appended matches */
+int TextIndex::findSimilar(const TextField field, const String& text, const int maxDistance, const int limit, ResizableArray<TextMatch>& matches) const {
+	if (maxDistance < 0 || maxDistance > TEXT_INDEX_MAX_DISTANCE)
+		throw Exception("Invalid argument exception!", 212, "TextIndex.cpp", "Edit distance is out of supported range");
+	const FieldIndex& index = getField(field);
+	String folded = fold(text);
+	const char* query = folded.get();
+	int length = folded.getLength();
+	int valueCount = index.valueOffsets.getSize() - 1;
+	if (valueCount <= 0 || limit == 0)
+		return 0;
+
+	// Every edit destroys at most 3 trigrams, so a match shares at least (query trigrams - 3 * distance) of them
+	ResizableArray<int> slots;
+	collectGramSlots(query, length, slots);
+	int threshold = slots.getSize() - 3 * maxDistance;
+	ResizableArray<int> candidates;
+	if (threshold <= 0) {
+		for (int v = 0; v < valueCount; ++v)
+			candidates.add(v);
+	}
+	else {
+		HashMap<int, int> shared;
+		for (int s = 0; s < slots.getSize(); ++s)
+			for (int i = index.gramOffsets[slots[s]]; i < index.gramOffsets[slots[s] + 1]; ++i)
+				if (++shared[index.gramValues[i]] == threshold)
+					candidates.add(index.gramValues[i]);
+	}
+
+	ResizableArray<TextMatch> found;
+	for (int i = 0; i < candidates.getSize(); ++i) {
+		int v = candidates[i];
+		int valueLength = index.valueOffsets[v + 1] - index.valueOffsets[v] - 1;
+		int distance = boundedDistance(query, length, &index.pool[index.valueOffsets[v]], valueLength, maxDistance);
+		if (distance > maxDistance)
+			continue;
+		for (int r = index.rowOffsets[v]; r < index.rowOffsets[v + 1]; ++r) {
+			TextMatch match;
+			match.row = index.rows[r];
+			match.distance = distance;
+			found.add(match);
+		}
+	}
+	if (found.isEmpty())
+		return 0;
+
+	TextMatch* begin = found.data();
+	std::sort(begin, begin + found.getSize(), [](const TextMatch& a, const TextMatch& b) {
+		return a.distance < b.distance || (a.distance == b.distance && a.row < b.row);
+	});
+	int appended = 0;
+	for (int i = 0; i < found.getSize() && (limit == -1 || appended < limit); ++i, ++appended)
+		matches.add(found[i]);
+	return appended;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "Book.h"
+#include "ResizableArray.h"
+#include "String.h"
+
+#define TEXT_INDEX_MAX_DISTANCE 3
+
+/* Which text field of a Book to search */
+enum class TextField {
+	Author,
+	Title
+};
+
+/* Single fuzzy search result: row of the Book and edit distance of its field to the query */
+struct TextMatch {
+	int row;
+	int distance;
+};
+
+/* Text Index class - answers prefix and bounded edit distance queries over authors and
+   titles of an array of Books. Fields are case folded. Prefix queries match from the start
+   of any word of the field ("complete ref" finds "C++. The Complete Reference"), so every
+   word start is kept in a sorted array and found by binary search. Fuzzy queries compare
+   whole fields and only verify names sharing enough trigrams with the query */
+class TextIndex {
+
+	/* Index over a single field of all Books */
+	struct FieldIndex {
+		ResizableArray<char> pool;			// Folded distinct values, each terminated by '\0'
+		ResizableArray<int> valueOffsets;	// Value id to its position in @pool
+		ResizableArray<int> rowOffsets;		// Value id to the first position of its rows in @rows
+		ResizableArray<int> rows;			// Rows of Books having every value, one list after another
+		ResizableArray<int> wordStarts;		// Positions in @pool of every word start, sorted by the text that follows
+		ResizableArray<int> gramOffsets;	// Trigram slot to the first position of its value ids in @gramValues
+		ResizableArray<int> gramValues;		// Value ids containing every trigram, one list after another
+
+		void build(const ResizableArray<Book>& books, const TextField field);
+	};
+
+	FieldIndex authors;
+	FieldIndex titles;
+
+	const FieldIndex& getField(const TextField field) const;
+
+public:
+
+	/* Rebuilds the index over the array of Books @books */
+	void build(const ResizableArray<Book>& books);
+
+	/* Appends to @rows at most @limit distinct rows of Books whose @field has a word starting
+	   with @prefix (case insensitive), in alphabetical order of the matched text.
+	   @limit of -1 means no limit. Returns the amount of appended rows */
+	int findPrefix(const TextField field, const String& prefix, const int limit, ResizableArray<int>& rows) const;
+
+	/* Appends to @matches at most @limit rows of Books whose @field differs from @text by
+	   at most @maxDistance (up to TEXT_INDEX_MAX_DISTANCE) single character edits, closest first.
+	   @limit of -1 means no limit. Returns the amount of appended matches */
+	int findSimilar(const TextField field, const String& text, const int maxDistance, const int limit, ResizableArray<TextMatch>& matches) const;
+
+	/* Returns case folded copy of @text with single spaces between words, the form fields are indexed in */
+	static String fold(const String& text);
+
+};
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "ThreadPool.h"
+
+static thread_local const ThreadPool* currentPool = nullptr;	// Pool the current thread works for
+static thread_local int currentIndex = -1;						// Its queue in that pool
+
+static std::atomic<int> sharedThreadCount(0);
+
+#pragma region ThreadPool
+
+/* Instantiates a pool of @threadCount threads including the waiting one
+   (0 means one per hardware thread) */
+ThreadPool::ThreadPool(const int threadCount) : queued(0), isStopping(false), nextQueue(0), waiting(0) {
+	this->threadCount = resolveThreadCount(threadCount);
+	int workerCount = this->threadCount - 1;
+	queues = workerCount ? new Queue[workerCount] : nullptr;
+	workers = workerCount ? new std::thread[workerCount] : nullptr;
+	for (int i = 0; i < workerCount; ++i)
+		workers[i] = std::thread(&ThreadPool::workerLoop, this, i);
+}
+
+/* Destructor finishes queued tasks and stops the workers */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		isStopping = true;
+	}
+	wake.notify_all();
+	for (int i = 0; i < threadCount - 1; ++i)
+		workers[i].join();
+	delete[] workers;
+	delete[] queues;
+}
+
+/* Returns the amount of threads executing tasks including the waiting one */
+int ThreadPool::getThreadCount() const {
+	return threadCount;
+}
+
+/* Returns index of the current thread's queue if it is a worker of this pool, -1 otherwise */
+int ThreadPool::currentQueue() const {
+	return currentPool == this ? currentIndex : -1;
+}
+
+/* Queues @task, runs it at once if the pool has no workers */
+void ThreadPool::submit(Task* task) {
+	if (threadCount == 1) {
+		execute(task);
+		return;
+	}
+	int own = currentQueue();
+	Queue& queue = queues[own != -1 ? own : nextQueue++ % (threadCount - 1)];
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks.push_back(task);
+	}
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		++queued;
+	}
+	wake.notify_one();
+	if (waiting > 0)
+		progress.notify_all();
+}
+
+/* Takes a task from the worker's own queue @own (or any queue if @own is -1), stealing
+   from the other queues if it is empty. Returns nullptr if all queues are empty */
+ThreadPool::Task* ThreadPool::take(const int own) {
+	if (queued == 0)
+		return nullptr;
+	int workerCount = threadCount - 1;
+	if (own != -1) {
+		std::lock_guard<std::mutex> guard(queues[own].lock);
+		if (!queues[own].tasks.empty()) {
+			Task* task = queues[own].tasks.back();
+			queues[own].tasks.pop_back();
+			--queued;
+			return task;
+		}
+	}
+	int start = own != -1 ? own + 1 : 0;
+	for (int i = 0; i < workerCount; ++i) {
+		Queue& victim = queues[(start + i) % workerCount];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			Task* task = victim.tasks.front();
+			victim.tasks.pop_front();
+			--queued;
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+/* Runs @task and tells its group it finished */
+void ThreadPool::execute(Task* task) {
+	TaskGroup* group = task->group;
+	ThreadPool& pool = group->pool; // The group may be gone once it has no pending tasks
+	try {
+		task->work();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> guard(group->errorLock);
+		if (!group->error)
+			group->error = std::current_exception();
+	}
+	delete task;
+	if (--group->pending == 0 && pool.waiting > 0)
+		pool.notifyProgress();
+}
+
+/* Wakes threads sleeping in TaskGroup::wait() */
+void ThreadPool::notifyProgress() {
+	// Taking the lock orders this after the sleeper's check of its group
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+	}
+	progress.notify_all();
+}
+
+/* Main loop of worker @index */
+void ThreadPool::workerLoop(const int index) {
+	currentPool = this;
+	currentIndex = index;
+	while (true) {
+		Task* task = take(index);
+		if (task != nullptr) {
+			execute(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> guard(sleepLock);
+		wake.wait(guard, [this]() { return queued > 0 || isStopping; });
+		if (isStopping && queued == 0)
+			return;
+	}
+}
+
+/* Returns the pool shared by the program, created on first use */
+ThreadPool& ThreadPool::shared() {
+	static ThreadPool pool(sharedThreadCount);
+	return pool;
+}
+
+/* Sets the amount of threads of the shared pool (0 means one per hardware thread).
+   Has no effect once the shared pool was used */
+void ThreadPool::setSharedThreadCount(const int threadCount) {
+	sharedThreadCount = threadCount;
+}
+
+/* Returns @threadCount, or the amount of hardware threads if it is 0 */
+int ThreadPool::resolveThreadCount(const int threadCount) {
+	if (threadCount > 0)
+		return threadCount;
+	int hardware = (int)std::thread::hardware_concurrency();
+	return hardware > 0 ? hardware : 1;
+}
+
+#pragma endregion
+
+#pragma region TaskGroup
+
+/* Instantiates an empty group running tasks on @pool */
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool), pending(0) {
+}
+
+/* Destructor waits for unfinished tasks */
+TaskGroup::~TaskGroup() {
+	try {
+		wait();
+	}
+	catch (...) {
+		// Exceptions are only reported by an explicit wait()
+	}
+}
+
+/* Starts @work as a task of this group */
+void TaskGroup::run(const std::function<void()>& work) {
+	++pending;
+	pool.submit(new ThreadPool::Task{ work, this });
+}
+
+/* Waits until every task of this group finished. Rethrows the first exception thrown by a task */
+void TaskGroup::wait() {
+	int own = pool.currentQueue();
+	int tries = 0;
+	while (pending > 0) {
+		ThreadPool::Task* task = pool.take(own);
+		if (task != nullptr) {
+			ThreadPool::execute(task);
+			tries = 0;
+		}
+		else if (++tries < THREAD_POOL_SPIN_COUNT)
+			std::this_thread::yield();
+		else {
+			// The remaining tasks run on other threads, sleep until they finish or new work comes
+			std::unique_lock<std::mutex> guard(pool.sleepLock);
+			++pool.waiting;
+			pool.progress.wait(guard, [this]() { return pending == 0 || pool.queued > 0; });
+			--pool.waiting;
+			tries = 0;
+		}
+	}
+	std::exception_ptr thrown;
+	{
+		std::lock_guard<std::mutex> guard(errorLock);
+		thrown = error;
+		error = nullptr;
+	}
+	if (thrown)
+		std::rethrow_exception(thrown);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "ResizableArray.h"
+
+#define THREAD_POOL_SPIN_COUNT 64	// Tries to find a task a waiting thread makes before it sleeps
+
+class TaskGroup;
+
+/* Thread Pool class - work stealing scheduler shared by all parallel code of the program.
+   Every worker owns a deque of tasks: it pushes and pops its own tasks at the back (newest
+   first, which keeps nested work cache-warm) while idle workers steal from the front of
+   other deques (oldest first, which are the biggest chunks of a recursive split).
+   A pool of N threads starts N - 1 workers, the thread waiting for a TaskGroup is the N-th:
+   it executes queued tasks while it waits, so nested fork/join never blocks a worker */
+class ThreadPool {
+
+	/* Single unit of work belonging to a TaskGroup */
+	struct Task {
+		std::function<void()> work;
+		TaskGroup* group;
+	};
+
+	/* Worker's own deque of tasks */
+	struct Queue {
+		std::mutex lock;
+		std::deque<Task*> tasks;
+	};
+
+	int threadCount;
+	Queue* queues;				// One per worker
+	std::thread* workers;
+	std::atomic<int> queued;	// Tasks waiting in all queues
+	std::atomic<bool> isStopping;
+	std::atomic<unsigned int> nextQueue;	// Round robin queue for tasks submitted by outside threads
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::condition_variable progress;	// Signalled to waiting threads when a group finished or a task was queued
+	std::atomic<int> waiting;			// Threads sleeping in TaskGroup::wait()
+
+	ThreadPool(const ThreadPool&); // Copy constructor disabled
+
+	/* Returns index of the current thread's queue if it is a worker of this pool, -1 otherwise */
+	int currentQueue() const;
+
+	/* Queues @task, runs it at once if the pool has no workers */
+	void submit(Task* task);
+
+	/* Takes a task from the worker's own queue @own (or any queue if @own is -1), stealing
+	   from the other queues if it is empty. Returns nullptr if all queues are empty */
+	Task* take(const int own);
+
+	/* Runs @task and tells its group it finished */
+	static void execute(Task* task);
+
+	/* Wakes threads sleeping in TaskGroup::wait() */
+	void notifyProgress();
+
+	/* Main loop of worker @index */
+	void workerLoop(const int index);
+
+	friend class TaskGroup;
+
+public:
+
+	/* Instantiates a pool of @threadCount threads including the waiting one
+	   (0 means one per hardware thread) */
+	ThreadPool(const int threadCount = 0);
+	/* Destructor finishes queued tasks and stops the workers */
+	~ThreadPool();
+
+	/* Returns the amount of threads executing tasks including the waiting one */
+	int getThreadCount() const;
+
+	/* Returns the pool shared by the program, created on first use */
+	static ThreadPool& shared();
+
+	/* Sets the amount of threads of the shared pool (0 means one per hardware thread).
+	   Has no effect once the shared pool was used */
+	static void setSharedThreadCount(const int threadCount);
+
+	/* Returns @threadCount, or the amount of hardware threads if it is 0 */
+	static int resolveThreadCount(const int threadCount);
+
+};
+
+/* Task Group class - fork/join over a ThreadPool. Tasks started with run() may execute on any
+   thread of the pool, wait() returns when all of them finished, executing queued tasks
+   meanwhile. If a task throws, the first exception is rethrown by wait() */
+class TaskGroup {
+
+	ThreadPool& pool;
+	std::atomic<int> pending;
+	std::mutex errorLock;
+	std::exception_ptr error;
+
+	TaskGroup(const TaskGroup&); // Copy constructor disabled
+
+	friend class ThreadPool;
+
+public:
+
+	/* Instantiates an empty group running tasks on @pool */
+	TaskGroup(ThreadPool& pool = ThreadPool::shared());
+	/* Destructor waits for unfinished tasks */
+	~TaskGroup();
+
+	/* Starts @work as a task of this group */
+	void run(const std::function<void()>& work);
+
+	/* Waits until every task of this group finished. Rethrows the first exception thrown by a task */
+	void wait();
+
+};
+
+/* Calls @body(from, to) for consecutive chunks of at most @grain indices covering [@from, @to)
+   in parallel on @pool. The range is split in halves recursively, so stolen work is always
+   a big contiguous chunk. @grain 0 picks about 8 chunks per thread */
+template<class Body>
+void parallelFor(ThreadPool& pool, const int from, const int to, int grain, const Body& body) {
+	if (from >= to)
+		return;
+	if (grain <= 0) {
+		grain = (to - from) / (pool.getThreadCount() * 8);
+		if (grain < 1)
+			grain = 1;
+	}
+	if (to - from <= grain || pool.getThreadCount() == 1) {
+		body(from, to);
+		return;
+	}
+	int middle = from + (to - from) / 2;
+	TaskGroup group(pool);
+	group.run([&pool, from, middle, grain, &body]() { parallelFor(pool, from, middle, grain, body); });
+	parallelFor(pool, middle, to, grain, body);
+	group.wait();
+}
+
+/* Calls @body(element) for every element of @arr in parallel on @pool */
+template<class T, class Body>
+void parallelFor(ThreadPool& pool, ResizableArray<T>& arr, const int grain, const Body& body) {
+	parallelFor(pool, 0, arr.getSize(), grain, [&arr, &body](int from, int to) {
+		for (int i = from; i < to; ++i)
+			body(arr[i]);
+	});
+}
+
+/* Reduces [@from, @to) in parallel on @pool: @map(from, to) returns the value of a chunk of
+   at most @grain indices, @combine(left, right) joins values of neighbouring chunks. Chunks are
+   always combined in index order, so the result doesn't depend on the amount of threads.
+   @grain 0 picks about 8 chunks per thread. Returns @identity for an empty range */
+template<class V, class Map, class Combine>
+V parallelReduce(ThreadPool& pool, const int from, const int to, int grain, const V& identity, const Map& map, const Combine& combine) {
+	if (from >= to)
+		return identity;
+	if (grain <= 0) {
+		grain = (to - from) / (pool.getThreadCount() * 8);
+		if (grain < 1)
+			grain = 1;
+	}
+	if (to - from <= grain || pool.getThreadCount() == 1)
+		return map(from, to);
+	int middle = from + (to - from) / 2;
+	V left = identity;
+	TaskGroup group(pool);
+	group.run([&pool, from, middle, grain, &identity, &map, &combine, &left]() {
+		left = parallelReduce(pool, from, middle, grain, identity, map, combine);
+	});
+	V right = parallelReduce(pool, middle, to, grain, identity, map, combine);
+	group.wait();
+	return combine(left, right);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* Trivially relocatable trait - true if an object can be moved to another address by copying
+   its bytes and forgetting the original without running its destructor, which holds for every
+   type not pointing into itself and not registered anywhere by its address. Trivially copyable
+   types are relocatable by definition, classes owning heap buffers (String, Book) opt in by
+   specializing the trait next to their definition */
+template<class T>
+struct IsTriviallyRelocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {
+};
+
+/* Bulk operations on arrays of uninitialized or live elements. Each one is dispatched at compile
+   time on the traits of T: types allowing it are handled as a single block of bytes, the others
+   element by element */
+namespace Util {
+
+	/* Copy constructs @count elements of @source into uninitialized memory @dest, byte copy version */
+	template<class T>
+	void copyConstruct(T* dest, const T* source, const size_t count, std::true_type) {
+		if (count > 0)
+			std::memcpy(dest, source, count * sizeof(T));
+	}
+
+	/* Copy constructor version */
+	template<class T>
+	void copyConstruct(T* dest, const T* source, const size_t count, std::false_type) {
+		for (size_t i = 0; i < count; ++i)
+			new (dest + i) T(source[i]);
+	}
+
+	/* Copy constructs @count elements of @source into uninitialized memory @dest */
+	template<class T>
+	void copyConstruct(T* dest, const T* source, const size_t count) {
+		copyConstruct(dest, source, count, std::is_trivially_copyable<T>());
+	}
+
+	/* Moves @count live elements of @source into uninitialized memory @dest, @source is left
+	   uninitialized. Byte copy version */
+	template<class T>
+	void relocate(T* dest, T* source, const size_t count, std::true_type) {
+		// Relocatable types needn't be trivially copyable, their bytes are moved on purpose
+		if (count > 0)
+			std::memcpy((void*)dest, (const void*)source, count * sizeof(T));
+	}
+
+	/* Move constructor and destructor version */
+	template<class T>
+	void relocate(T* dest, T* source, const size_t count, std::false_type) {
+		for (size_t i = 0; i < count; ++i) {
+			new (dest + i) T(std::move(source[i]));
+			source[i].~T();
+		}
+	}
+
+	/* Moves @count live elements of @source into uninitialized memory @dest, @source is left uninitialized */
+	template<class T>
+	void relocate(T* dest, T* source, const size_t count) {
+		relocate(dest, source, count, IsTriviallyRelocatable<T>());
+	}
+
+	/* Destroys @count live elements of @arr */
+	template<class T>
+	void destroy(T* arr, const size_t count) {
+		if (!std::is_trivially_destructible<T>::value)
+			for (size_t i = 0; i < count; ++i)
+				arr[i].~T();
+	}
+
+}
\ No newline at end of file
@@ -1,30 +1,351 @@
 #include "Util.h"
 #include <cstdlib>
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2
+#include <emmintrin.h>
+#define UTIL_SSE2
+#endif
+
+/* Lookup tables of single byte characters, so ASCII text is classified and case mapped
+   without branches or locale dependent calls. Bytes of UTF-8 sequences are of no class */
+static struct CharTables {
+	unsigned char classes[256];		// Util::CharClass of every byte
+	unsigned char cased[2][256];	// Lower [0] and upper [1] case of every byte, ASCII letters only change
+
+	CharTables() {
+		for (int c = 0; c < 256; ++c) {
+			bool isUpper = c >= 'A' && c <= 'Z', isLower = c >= 'a' && c <= 'z';
+			classes[c] = isUpper || isLower ? Util::CharLetter : c == ' ' ? Util::CharSpace
+				: c == '-' || c == '.' ? Util::CharNameMark : c >= '0' && c <= '9' ? Util::CharDigit
+				: c < 0x80 ? Util::CharOther : 0;
+			cased[0][c] = (unsigned char)(isUpper ? c + ('a' - 'A') : c);
+			cased[1][c] = (unsigned char)(isLower ? c - ('a' - 'A') : c);
+		}
+	}
+} charTables;
+
+/* Upper case letters @first to @last (every @step one) whose lower case is @delta further */
+struct CaseRange {
+	unsigned int first;
+	unsigned int last;
+	int delta;
+	unsigned int step;
+};
+
+/* Case pairs of Latin-1, Latin Extended-A, Greek, Cyrillic and Armenian, all two bytes long
+   in UTF-8 (pairs changing the length, like dotless i to I, are left out, so case mapping in place
+   never moves the rest of the text) */
+static const CaseRange caseRanges[] = {
+	{ 0x00C0, 0x00D6, 0x20, 1 }, { 0x00D8, 0x00DE, 0x20, 1 },
+	{ 0x0100, 0x012E, 1, 2 }, { 0x0132, 0x0136, 1, 2 }, { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 },
+	{ 0x0178, 0x0178, -0x79, 1 }, { 0x0179, 0x017D, 1, 2 },
+	{ 0x0386, 0x0386, 0x26, 1 }, { 0x0388, 0x038A, 0x25, 1 }, { 0x038C, 0x038C, 0x40, 1 }, { 0x038E, 0x038F, 0x3F, 1 },
+	{ 0x0391, 0x03A1, 0x20, 1 }, { 0x03A3, 0x03AB, 0x20, 1 },
+	{ 0x0400, 0x040F, 0x50, 1 }, { 0x0410, 0x042F, 0x20, 1 }, { 0x0460, 0x0480, 1, 2 }, { 0x048A, 0x04BE, 1, 2 },
+	{ 0x04C0, 0x04C0, 0x0F, 1 }, { 0x04C1, 0x04CD, 1, 2 }, { 0x04D0, 0x052E, 1, 2 },
+	{ 0x0531, 0x0556, 0x30, 1 }
+};
+
+/* Non-ASCII code points counted as letters: Latin, combining diacritics (of decomposed letters),
+   Greek, Cyrillic, Armenian, Hebrew, Arabic, Georgian, Hiragana, Katakana, CJK and Hangul */
+static const unsigned int letterRanges[][2] = {
+	{ 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x024F }, { 0x0300, 0x036F },
+	{ 0x0370, 0x0374 }, { 0x0376, 0x037D }, { 0x0386, 0x0386 }, { 0x0388, 0x03FF },
+	{ 0x0400, 0x0481 }, { 0x048A, 0x052F }, { 0x0531, 0x0556 }, { 0x0561, 0x0587 },
+	{ 0x05D0, 0x05EA }, { 0x0620, 0x064A }, { 0x0671, 0x06D3 }, { 0x10A0, 0x10FF },
+	{ 0x3041, 0x3096 }, { 0x30A1, 0x30FA }, { 0x4E00, 0x9FFF }, { 0xAC00, 0xD7A3 }
+};
+
+#define UTIL_COUNT(arr) (int)(sizeof(arr) / sizeof(arr[0]))
 
 /* Trims excessive white spaces (double spaces, leading and trailing spaces)*/
 void Util::trim(String& str) {
+	const String& source = str; // Reads don't go through mutable operator[]
 	String newstr = "";
 	int i = 0;
-	while (i < str.getLength() && str[i] == ' ')
+	while (i < source.getLength() && source[i] == ' ')
 		i++;
-	for (; i < str.getLength(); ++i) {
-		if (str[i] == ' ' && str[i + 1] != ' ' && str[i + 1])
-			newstr += str[i];
-		else if (str[i] != ' ')
-			newstr += str[i];
+	for (; i < source.getLength(); ++i) {
+		if (source[i] == ' ' && source[i + 1] != ' ' && source[i + 1])
+			newstr += source[i];
+		else if (source[i] != ' ')
+			newstr += source[i];
 	}
 	str = newstr;
 }
 
 /* Removes excessive spaces, makes first letters uppercase, all others lowercase*/
 void Util::normalizeString(String& str) {
-	Util::trim(str);
-	for (int i = 0; i < str.getLength(); ++i) {
-		if (i == 0 || str[i - 1] == ' ')
-			str[i] = toupper(str[i]);
-		else str[i] = tolower(str[i]);
+	int length = str.getLength();
+	char* buffer = new char[length + 1];
+	Util::strcpy(buffer, str.get());
+	str.set(buffer, normalizeBuffer(buffer, length));
+	delete[] buffer;
+}
+
+/* Same as normalizeString, but works in place on @length characters of @str.
+   Returns the new length, doesn't allocate memory */
+int Util::normalizeBuffer(char* str, const int length) {
+	int read = 0, write = 0;
+	unsigned char previous = ' ';	// Last character read, a space if a word starts
+	if (isAscii(str, length)) {
+		// Every character is written with the case of its place, a space is kept only after a non-space
+		for (; read < length; ++read) {
+			unsigned char c = (unsigned char)str[read];
+			str[write] = charTables.cased[previous == ' '][c];
+			write += !(c == ' ' && previous == ' ');
+			previous = c;
+		}
+	}
+	else while (read < length) {
+		unsigned char c = (unsigned char)str[read];
+		unsigned int codePoint;
+		int size = c < 0x80 ? 0 : decodeUtf8(str + read, length - read, codePoint);
+		if (size == 0) {
+			// ASCII or a byte of broken UTF-8, which is kept as it is
+			str[write] = charTables.cased[previous == ' '][c];
+			write += !(c == ' ' && previous == ' ');
+			previous = c;
+			++read;
+			continue;
+		}
+		write += encodeUtf8(previous == ' ' ? toUpper(codePoint) : toLower(codePoint), str + write);
+		previous = 'a';
+		read += size;
+	}
+	// Only a trailing space is left to drop
+	write -= write > 0 && previous == ' ';
+	return write;
+}
+
+/* Returns true if @length characters of @str are all ASCII (checked 16 bytes at a time) */
+bool Util::isAscii(const char* str, const int length) {
+	int i = 0;
+#if defined(UTIL_SSE2)
+	__m128i high = _mm_setzero_si128();
+	for (; i + 16 <= length; i += 16)
+		high = _mm_or_si128(high, _mm_loadu_si128((const __m128i*)(str + i)));
+	if (_mm_movemask_epi8(high) != 0)
+		return false;
+#else
+	unsigned long long high = 0;
+	for (; i + 16 <= length; i += 16) {
+		unsigned long long words[2];
+		std::memcpy(words, str + i, sizeof(words));
+		high |= words[0] | words[1];
+	}
+	if ((high & 0x8080808080808080ull) != 0)
+		return false;
+#endif
+	unsigned char rest = 0;
+	for (; i < length; ++i)
+		rest |= (unsigned char)str[i];
+	return rest < 0x80;
+}
+
+/* Returns true if every character of @length characters of @str is of a class of @classes.
+   Non-ASCII text must be valid UTF-8 */
+bool Util::isValidField(const char* str, const int length, const int classes) {
+	if (isAscii(str, length)) {
+		int isInvalid = 0;
+		for (int i = 0; i < length; ++i)
+			isInvalid |= (charTables.classes[(unsigned char)str[i]] & classes) == 0;
+		return !isInvalid;
+	}
+	for (int i = 0; i < length;) {
+		unsigned char c = (unsigned char)str[i];
+		if (c < 0x80 || (classes & CharOther) != 0) {
+			if (c < 0x80 && (charTables.classes[c] & classes) == 0)
+				return false;
+			++i;
+			continue;
+		}
+		unsigned int codePoint;
+		int size = decodeUtf8(str + i, length - i, codePoint);
+		if (size == 0 || (classes & CharLetter) == 0 || !isLetter(codePoint))
+			return false;
+		i += size;
+	}
+	return true;
+}
+
+/* Checks @length characters of @str are of classes @classes and normalizes them in place like
+   normalizeBuffer, both in a single pass over ASCII text. Returns the new length, -1 if a character
+   isn't of @classes */
+int Util::normalizeField(char* str, const int length, const int classes) {
+	int write = 0, isInvalid = 0;
+	unsigned char previous = ' ', high = 0;
+	for (int read = 0; read < length; ++read) {
+		unsigned char c = (unsigned char)str[read];
+		isInvalid |= (charTables.classes[c] & classes) == 0;
+		high |= c;
+		str[write] = charTables.cased[previous == ' '][c];
+		write += !(c == ' ' && previous == ' ');
+		previous = c;
+	}
+	write -= write > 0 && previous == ' ';
+	if (high >= 0x80) {
+		// The pass left bytes of UTF-8 as they were, only spaces and ASCII letters changed,
+		// so checking and normalizing its result as UTF-8 gives the same as of the original text
+		if (!isValidField(str, write, classes))
+			return -1;
+		return normalizeBuffer(str, write);
+	}
+	return isInvalid ? -1 : write;
+}
+
+/* Parses an unsigned decimal number of at most @max at the start of @length characters of @str
+   into @value (leading spaces allowed, anything after the digits is ignored like operator>> does).
+   Returns false if there is none or it is greater than @max */
+bool Util::parseUnsigned(const char* str, const int length, const unsigned long long max, unsigned long long& value) {
+	int i = 0;
+	while (i < length && (str[i] == ' ' || str[i] == '\t'))
+		++i;
+	int start = i, isOverflow = 0;
+	unsigned long long number = 0;
+	unsigned int digit;
+	// Numbers past @max (far below 2^64) stay at it, so any amount of digits can't overflow
+	for (; i < length && (digit = (unsigned char)str[i] - '0') < 10; ++i) {
+		number = number * 10 + digit;
+		isOverflow |= number > max;
+		number = number > max ? max : number;
+	}
+	value = number;
+	return i > start && !isOverflow;
+}
+
+/* Decodes UTF-8 character at the start of @length characters of @str into @codePoint.
+   Returns its length in bytes, 0 if it isn't valid UTF-8 */
+int Util::decodeUtf8(const char* str, const int length, unsigned int& codePoint) {
+	if (length <= 0)
+		return 0;
+	const unsigned char* s = (const unsigned char*)str;
+	int size;
+	unsigned int minimum;
+	if (s[0] < 0x80) {
+		codePoint = s[0];
+		return 1;
+	}
+	else if ((s[0] & 0xE0) == 0xC0) {
+		size = 2;
+		minimum = 0x80;
+		codePoint = s[0] & 0x1F;
+	}
+	else if ((s[0] & 0xF0) == 0xE0) {
+		size = 3;
+		minimum = 0x800;
+		codePoint = s[0] & 0x0F;
+	}
+	else if ((s[0] & 0xF8) == 0xF0) {
+		size = 4;
+		minimum = 0x10000;
+		codePoint = s[0] & 0x07;
+	}
+	else return 0;
+	if (length < size)
+		return 0;
+	for (int i = 1; i < size; ++i) {
+		if ((s[i] & 0xC0) != 0x80)
+			return 0;
+		codePoint = codePoint << 6 | (s[i] & 0x3F);
+	}
+	// Overlong forms, surrogates and code points past Unicode are invalid
+	if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+		return 0;
+	return size;
+}
+
+/* Encodes @codePoint as UTF-8 into @str. Returns its length in bytes (1 to 4) */
+int Util::encodeUtf8(const unsigned int codePoint, char* str) {
+	if (codePoint < 0x80) {
+		str[0] = (char)codePoint;
+		return 1;
+	}
+	if (codePoint < 0x800) {
+		str[0] = (char)(0xC0 | codePoint >> 6);
+		str[1] = (char)(0x80 | (codePoint & 0x3F));
+		return 2;
+	}
+	if (codePoint < 0x10000) {
+		str[0] = (char)(0xE0 | codePoint >> 12);
+		str[1] = (char)(0x80 | (codePoint >> 6 & 0x3F));
+		str[2] = (char)(0x80 | (codePoint & 0x3F));
+		return 3;
+	}
+	str[0] = (char)(0xF0 | codePoint >> 18);
+	str[1] = (char)(0x80 | (codePoint >> 12 & 0x3F));
+	str[2] = (char)(0x80 | (codePoint >> 6 & 0x3F));
+	str[3] = (char)(0x80 | (codePoint & 0x3F));
+	return 4;
+}
+
+/* Returns true if @codePoint is a letter */
+bool Util::isLetter(const unsigned int codePoint) {
+	if (codePoint < 0x80)
+		return charTables.classes[codePoint] == CharLetter;
+	for (int i = 0; i < UTIL_COUNT(letterRanges) && letterRanges[i][0] <= codePoint; ++i)
+		if (codePoint <= letterRanges[i][1])
+			return true;
+	return false;
+}
+
+/* Returns upper case of @codePoint, or @codePoint if it has none of the same UTF-8 length */
+unsigned int Util::toUpper(const unsigned int codePoint) {
+	if (codePoint < 0x80)
+		return charTables.cased[1][codePoint];
+	if (codePoint == 0x03C2) // Final sigma
+		return 0x03A3;
+	for (int i = 0; i < UTIL_COUNT(caseRanges); ++i) {
+		const CaseRange& range = caseRanges[i];
+		unsigned int upper = codePoint - range.delta;
+		if (upper >= range.first && upper <= range.last && (upper - range.first) % range.step == 0)
+			return upper;
 	}
-	return;
+	return codePoint;
+}
+
+/* Returns lower case of @codePoint, or @codePoint if it has none of the same UTF-8 length */
+unsigned int Util::toLower(const unsigned int codePoint) {
+	if (codePoint < 0x80)
+		return charTables.cased[0][codePoint];
+	for (int i = 0; i < UTIL_COUNT(caseRanges) && caseRanges[i].first <= codePoint; ++i) {
+		const CaseRange& range = caseRanges[i];
+		if (codePoint <= range.last && (codePoint - range.first) % range.step == 0)
+			return codePoint + range.delta;
+	}
+	return codePoint;
+}
+
+/* Makes @length characters of @str lower case in place, UTF-8 aware */
+void Util::lowerBuffer(char* str, const int length) {
+	if (isAscii(str, length)) {
+		for (int i = 0; i < length; ++i)
+			str[i] = charTables.cased[0][(unsigned char)str[i]];
+		return;
+	}
+	for (int i = 0; i < length;) {
+		unsigned int codePoint;
+		int size = decodeUtf8(str + i, length - i, codePoint);
+		if (size == 0)
+			++i;
+		else i += encodeUtf8(toLower(codePoint), str + i);
+	}
+}
+
+/* Returns the amount of characters of @length bytes of UTF-8 text @str */
+int Util::countCharacters(const char* str, const int length) {
+	int characters = 0;
+	for (int i = 0; i < length; ++i)
+		characters += ((unsigned char)str[i] & 0xC0) != 0x80;
+	return characters;
+}
+
+/* Returns width to output @str with for it to take @width places (setw counts bytes,
+   but a UTF-8 character takes a single place) */
+int Util::getColumnWidth(const String& str, const int width) {
+	return width + str.getLength() - countCharacters(str.get(), str.getLength());
 }
 
 /* Returns the length of a C-style string (excluding null-terminator) */
@@ -45,15 +366,75 @@ void Util::strcpy(char* dest, const char* source) {
 /* Appends C-style string @source at the end of @dest. Is unsafe (doesn't make sure @dest has enough space) */
 void Util::strcat(char* dest, const char* source) {
 	int i, l = strlen(dest);
-	for (i = l; source != nullptr && source[i%l] != '\0'; ++i)
-		dest[i] = source[i%l];
-	dest[i] = '\0';
+	for (i = 0; source != nullptr && source[i] != '\0'; ++i)
+		dest[l + i] = source[i];
+	dest[l + i] = '\0';
 }
 
-/* Copies @size values from array @source to array @dest. Is unsafe (doesn't make sure @dest has enough space) */
-template<class T>
-void Util::memcpy(T* dest, const T* source, const unsigned int size) {
-	for (int i = 0; i < size; ++i)
-		dest[i] = source[i];
+/* Compares C-style strings @a and @b, returns negative, zero or positive value
+   if @a is less, equal or greater than @b */
+int Util::strcmp(const char* a, const char* b) {
+	int i;
+	for (i = 0; a[i] && a[i] == b[i]; ++i);
+	return (unsigned char)a[i] - (unsigned char)b[i];
+}
+
+/* Compares at most @n first characters of C-style strings @a and @b */
+int Util::strncmp(const char* a, const char* b, const int n) {
+	int i;
+	for (i = 0; i < n - 1 && a[i] && a[i] == b[i]; ++i);
+	return n > 0 ? (unsigned char)a[i] - (unsigned char)b[i] : 0;
+}
+
+/* Returns path of file @name inside directory @directory */
+String Util::joinPath(const String& directory, const char* name) {
+	if (directory.getLength() == 0)
+		return String(name);
+	char last = directory[directory.getLength() - 1];
+	if (last == '/' || last == '\\')
+		return directory + String(name);
+	return directory + '/' + String(name);
+}
+
+/* Returns FNV-1a hash of the String contents */
+unsigned int Util::hash(const String& str) {
+	return hash(str.get(), str.getLength());
+}
+
+/* Returns FNV-1a hash of @length bytes at @bytes, zero bytes included */
+unsigned int Util::hash(const char* bytes, const int length) {
+	unsigned int h = 2166136261u;
+	for (int i = 0; i < length; ++i) {
+		h ^= (unsigned char)bytes[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/* Returns 64 bit hash of the String contents: FNV-1a with a final mix, so every bit
+   depends on every character (sketches take bits from both ends) */
+unsigned long long Util::hash64(const String& str) {
+	unsigned long long h = 14695981039346656037ull;
+	const char* s = str.get();
+	for (int i = 0; i < str.getLength(); ++i) {
+		h ^= (unsigned char)s[i];
+		h *= 1099511628211ull;
+	}
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
 }
 
+/* Returns mixed hash of an integer */
+unsigned int Util::hash(const int value) {
+	unsigned int h = (unsigned int)value;
+	h ^= h >> 16;
+	h *= 0x7feb352du;
+	h ^= h >> 15;
+	h *= 0x846ca68bu;
+	h ^= h >> 16;
+	return h;
+}
\ No newline at end of file
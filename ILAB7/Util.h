@@ -1,5 +1,6 @@
 #pragma once
 #include "String.h"
+#include "TypeTraits.h"
 
 namespace Util {
 
@@ -9,6 +10,63 @@ namespace Util {
 	/* Removes excessive spaces, makes first letters uppercase, all others lowercase*/
 	void normalizeString(String&);
 
+	/* Same as normalizeString, but works in place on @length characters of @str.
+	   Returns the new length, doesn't allocate memory */
+	int normalizeBuffer(char* str, const int length);
+
+	/* Classes of characters fields may consist of, combined as bits */
+	enum CharClass {
+		CharLetter = 1,		// ASCII letters and letters of the alphabets listed in Util.cpp (UTF-8)
+		CharSpace = 2,		// ' '
+		CharNameMark = 4,	// '-' and '.' of names
+		CharDigit = 8,
+		CharOther = 16,		// Any other character, broken UTF-8 included
+		CharAny = 31
+	};
+
+	/* Returns true if @length characters of @str are all ASCII (checked 16 bytes at a time) */
+	bool isAscii(const char* str, const int length);
+
+	/* Returns true if every character of @length characters of @str is of a class of @classes.
+	   Non-ASCII text must be valid UTF-8 */
+	bool isValidField(const char* str, const int length, const int classes);
+
+	/* Checks @length characters of @str are of classes @classes and normalizes them in place like
+	   normalizeBuffer, both in a single pass over ASCII text. Returns the new length, -1 if a character
+	   isn't of @classes */
+	int normalizeField(char* str, const int length, const int classes);
+
+	/* Parses an unsigned decimal number of at most @max at the start of @length characters of @str
+	   into @value (leading spaces allowed, anything after the digits is ignored like operator>> does).
+	   Returns false if there is none or it is greater than @max */
+	bool parseUnsigned(const char* str, const int length, const unsigned long long max, unsigned long long& value);
+
+	/* Decodes UTF-8 character at the start of @length characters of @str into @codePoint.
+	   Returns its length in bytes, 0 if it isn't valid UTF-8 */
+	int decodeUtf8(const char* str, const int length, unsigned int& codePoint);
+
+	/* Encodes @codePoint as UTF-8 into @str. Returns its length in bytes (1 to 4) */
+	int encodeUtf8(const unsigned int codePoint, char* str);
+
+	/* Returns true if @codePoint is a letter */
+	bool isLetter(const unsigned int codePoint);
+
+	/* Returns upper case of @codePoint, or @codePoint if it has none of the same UTF-8 length */
+	unsigned int toUpper(const unsigned int codePoint);
+
+	/* Returns lower case of @codePoint, or @codePoint if it has none of the same UTF-8 length */
+	unsigned int toLower(const unsigned int codePoint);
+
+	/* Makes @length characters of @str lower case in place, UTF-8 aware */
+	void lowerBuffer(char* str, const int length);
+
+	/* Returns the amount of characters of @length bytes of UTF-8 text @str */
+	int countCharacters(const char* str, const int length);
+
+	/* Returns width to output @str with for it to take @width places (setw counts bytes,
+	   but a UTF-8 character takes a single place) */
+	int getColumnWidth(const String& str, const int width);
+
 	/* Returns the length of a C-style string (excluding null-terminator) */
 	int strlen(const char*);
 
@@ -18,8 +76,48 @@ namespace Util {
 	/* Appends C-style string @source at the end of @dest. Is unsafe (doesn't make sure @dest has enough space) */
 	void strcat(char*, const char*);
 
-	/* Copies @size values from array @source to array @dest. Is unsafe (doesn't make sure @dest has enough space) */
+	/* Compares C-style strings @a and @b, returns negative, zero or positive value
+	   if @a is less, equal or greater than @b */
+	int strcmp(const char*, const char*);
+
+	/* Compares at most @n first characters of C-style strings @a and @b */
+	int strncmp(const char*, const char*, const int);
+
+	/* Returns path of file @name inside directory @directory */
+	String joinPath(const String&, const char*);
+
+	/* Returns FNV-1a hash of the String contents */
+	unsigned int hash(const String&);
+
+	/* Returns FNV-1a hash of @length bytes at @bytes, zero bytes included */
+	unsigned int hash(const char* bytes, const int length);
+
+	/* Returns mixed hash of an integer */
+	unsigned int hash(const int);
+
+	/* Returns 64 bit hash of the String contents: FNV-1a with a final mix, so every bit
+	   depends on every character (sketches take bits from both ends) */
+	unsigned long long hash64(const String&);
+
+	/* Copies @size values from array @source to array @dest, byte copy version */
+	template<class T>
+	void memcpy(T* dest, const T* source, const unsigned int size, std::true_type) {
+		if (size > 0)
+			std::memmove(dest, source, size * sizeof(T));
+	}
+
+	/* Assignment version */
+	template<class T>
+	void memcpy(T* dest, const T* source, const unsigned int size, std::false_type) {
+		for (unsigned int i = 0; i < size; ++i)
+			dest[i] = source[i];
+	}
+
+	/* Copies @size values from array @source to array @dest. Is unsafe (doesn't make sure @dest has enough space).
+	   Trivially copyable types are copied as a single block of bytes, others are assigned one by one */
 	template<class T>
-	void memcpy(T*, const T*, const unsigned int);
+	void memcpy(T* dest, const T* source, const unsigned int size) {
+		memcpy(dest, source, size, std::is_trivially_copyable<T>());
+	}
 
 }
\ No newline at end of file
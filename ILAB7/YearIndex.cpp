@@ -0,0 +1,101 @@
+#include "YearIndex.h"
+
+/* Instantiates an empty Year Index */
+YearIndex::YearIndex() {
+	offsets.add(0);
+}
+
+/* Rebuilds this index from the array of Books @books */
+void YearIndex::build(const ResizableArray<Book>& books) {
+	offsets.clear();
+	rows.clear();
+	copies.clear();
+	offsets.add(0);
+	append(books, 0);
+}
+
+/* Adds rows from @from up to the end of the array of Books @books, which has only grown
+   since the index was built. Old rows are moved but not re-read */
+void YearIndex::append(const ResizableArray<Book>& books, const int from) {
+	int oldYears = copies.getSize();
+	int lastYear = oldYears - 1;
+	for (int i = from; i < books.getSize(); ++i)
+		if (books[i].getPublicationYear() > lastYear)
+			lastYear = books[i].getPublicationYear();
+
+	// Counting pass: rows and copies of every year among the new Books
+	int years = lastYear + 1;
+	ResizableArray<int> added(years);
+	for (int year = 0; year < years; ++year)
+		added.add(0);
+	for (int year = oldYears; year < years; ++year)
+		copies.add(0);
+	for (int i = from; i < books.getSize(); ++i) {
+		int year = books[i].getPublicationYear();
+		++added[year];
+		copies[year] += books[i].getCurrentAmount();
+	}
+
+	// Every old year is copied to its new place followed by room for its new rows
+	ResizableArray<int> newOffsets(years + 1);
+	ResizableArray<int> newRows(rows.getSize() + books.getSize() - from);
+	for (int year = 0; year < years; ++year) {
+		newOffsets.add(newRows.getSize());
+		if (year < oldYears)
+			for (int r = offsets[year]; r < offsets[year + 1]; ++r)
+				newRows.add(rows[r]);
+		int cursor = newRows.getSize();
+		for (int r = 0; r < added[year]; ++r)
+			newRows.add(-1);
+		added[year] = cursor;
+	}
+	newOffsets.add(newRows.getSize());
+
+	// Placing pass, rows come in ascending order and stay so within a year
+	for (int i = from; i < books.getSize(); ++i)
+		newRows[added[books[i].getPublicationYear()]++] = i;
+	offsets = newOffsets;
+	rows = newRows;
+}
+
+/* Clamps the year range [@from, @to] to years present in the index.
+   Returns false if no year of it is */
+bool YearIndex::clamp(int& from, int& to) const {
+	if (from < 0)
+		from = 0;
+	if (to > getLastYear())
+		to = getLastYear();
+	return from <= to;
+}
+
+/* Returns the latest publication year of indexed Books, -1 if there are none */
+int YearIndex::getLastYear() const {
+	return copies.getSize() - 1;
+}
+
+/* Returns the amount of Books published from @from to @to inclusively */
+int YearIndex::getRowCount(const int from, const int to) const {
+	int first = from, last = to;
+	if (!clamp(first, last))
+		return 0;
+	return offsets[last + 1] - offsets[first];
+}
+
+/* Returns immutable pointer to rows of Books published from @from to @to inclusively,
+   grouped by year and ascending within a year, nullptr if there are none */
+const int* YearIndex::getRows(const int from, const int to) const {
+	int first = from, last = to;
+	if (!clamp(first, last) || offsets[last + 1] == offsets[first])
+		return nullptr;
+	return rows.data() + offsets[first];
+}
+
+/* Returns the sum of available copies of Books published from @from to @to inclusively */
+long long YearIndex::getCopies(const int from, const int to) const {
+	int first = from, last = to;
+	long long total = 0;
+	if (clamp(first, last))
+		for (int year = first; year <= last; ++year)
+			total += copies[year];
+	return total;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include "Book.h"
+#include "ResizableArray.h"
+
+/* Year Index class - rows (indexes in an array of Books) grouped by publication year, laid out
+   like a counting sort: rows of every year from 0 to the latest one are stored one after another,
+   ascending within a year, and @offsets tells where each year starts. Rows of a year range are
+   a single slice found in constant time, so selecting k rows takes O(k). Available copies are
+   summed per year as of the build, so per-year aggregates take O(years) without touching Books */
+class YearIndex {
+
+	ResizableArray<int> offsets;		// Year to the first position of its rows in @rows, one entry more past the last year
+	ResizableArray<int> rows;			// Row lists of all years one after another
+	ResizableArray<long long> copies;	// Year to the sum of available copies of its Books
+
+	/* Clamps the year range [@from, @to] to years present in the index.
+	   Returns false if no year of it is */
+	bool clamp(int& from, int& to) const;
+
+public:
+
+	/* Instantiates an empty Year Index */
+	YearIndex();
+
+	/* Rebuilds this index from the array of Books @books */
+	void build(const ResizableArray<Book>& books);
+
+	/* Adds rows from @from up to the end of the array of Books @books, which has only grown
+	   since the index was built. Old rows are moved but not re-read */
+	void append(const ResizableArray<Book>& books, const int from);
+
+	/* Returns the latest publication year of indexed Books, -1 if there are none */
+	int getLastYear() const;
+
+	/* Returns the amount of Books published from @from to @to inclusively */
+	int getRowCount(const int from, const int to) const;
+
+	/* Returns immutable pointer to rows of Books published from @from to @to inclusively,
+	   grouped by year and ascending within a year, nullptr if there are none */
+	const int* getRows(const int from, const int to) const;
+
+	/* Returns the sum of available copies of Books published from @from to @to inclusively */
+	long long getCopies(const int from, const int to) const;
+
+};
\ No newline at end of file
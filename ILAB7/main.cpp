@@ -1,13 +1,39 @@
 #include <iostream>
 #include <fstream>
 #include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <sstream>
+#include <string>
 
 #include "LinkedList.h"
+#include "AvailabilityLog.h"
 #include "Book.h"
 #include "ResizableArray.h"
 #include "String.h"
 #include "Exception.h"
+#include "GroupBy.h"
 #include "Pair.h"
+#include "Benchmark.h"
+#include "CompactCatalog.h"
+#include "Decompressor.h"
+#include "LoadGenerator.h"
+#include "Loader.h"
+#include "Options.h"
+#include "ParallelSort.h"
+#include "QueryCache.h"
+#include "QueryEngine.h"
+#include "QueryServer.h"
+#include "ShardCoordinator.h"
+#include "Sketches.h"
+#include "RadixSort.h"
+#include "ReportWriter.h"
+#include "RowSet.h"
+#include "ThreadPool.h"
+#include "Util.h"
+#include "YearIndex.h"
 
 
 /* Returns reference to the book with most available copies in a resizable array */
@@ -28,15 +54,104 @@ void sort(LinkedList<T>&);
 template<class T>
 void sort(T*, int);
 
+/* Parallel versions of the two above, parallelSort(ResizableArray<T>&, ThreadPool&, cutoff)
+   and parallelSort(T*, int, ThreadPool&, cutoff), live in ParallelSort.h, so the benchmarks
+   can sort with them too */
+
+/* Sorts books by available copies for the reports the way @mode tells                */
+void sortBooks(ResizableArray<Book>& books, const SortMode mode);
+
 /* Outputs a table to the stream &out from the books in vector &books			 */
 void outputBooksTable(std::ostream& out, ResizableArray<Book>&);
 
 /* Outputs the list of unique spheres to the stream &out from ResizableArray of Book @books */
 void outputSpheresList(std::ostream& out, ResizableArray<Book>& books);
 
+/* Outputs the amount of books of every author to the stream &out */
+void outputAuthorsList(std::ostream& out, ResizableArray<Book>& books);
+
+/* Outputs the amount of books published in every year to the stream &out */
+void outputYearsList(std::ostream& out, ResizableArray<Book>& books);
+
+/* Outputs the amount of books and available copies of every decade to the stream &out */
+void outputDecadesList(std::ostream& out, ResizableArray<Book>& books);
+
+/* Writes bestAvailability.txt, booksTable.txt, spheresList.txt, authorsList.txt, yearsList.txt
+   and decadesList.txt into @directory */
+void writeReports(ResizableArray<Book>& books, const String& directory, const SortMode mode = SortMode::Count);
+
+/* Outputs the header of the books table to the stream &out */
+void outputBooksTableHeader(std::ostream& out);
+
+/* Outputs spheres counted in @spheres (in the order they were first seen) to the stream &out */
+void outputSphereCounts(std::ostream& out, const ResizableArray<Pair<String, int>>& spheres);
+
+/* Sorts authors counted in @authors and outputs them to the stream &out */
+void outputAuthorCounts(std::ostream& out, ResizableArray<Pair<String, int>>& authors);
+
+/* Sorts years counted in @years and outputs them to the stream &out */
+void outputYearCounts(std::ostream& out, ResizableArray<Pair<int, int>>& years);
+
+/* Returns row of the book with most available copies in compact catalog @catalog */
+int findBestAvailability(const CompactCatalog& catalog);
+
+/* Outputs a table of the rows of compact catalog @catalog in @order to the stream &out */
+void outputBooksTable(std::ostream& out, const CompactCatalog& catalog, const int* order);
+
+/* Outputs the list of unique spheres of compact catalog @catalog counted in @order to the stream &out */
+void outputSpheresList(std::ostream& out, const CompactCatalog& catalog, const int* order);
+
+/* Outputs the amount of books of every author of compact catalog @catalog counted in @order to the stream &out */
+void outputAuthorsList(std::ostream& out, const CompactCatalog& catalog, const int* order);
+
+/* Outputs the amount of books of every year of compact catalog @catalog to the stream &out */
+void outputYearsList(std::ostream& out, const CompactCatalog& catalog);
+
+/* Outputs books and available copies of every decade of compact catalog @catalog to the stream &out */
+void outputDecadesList(std::ostream& out, const CompactCatalog& catalog);
+
+/* Writes the reports writeReports writes from compact catalog @catalog into @directory */
+void writeReports(const CompactCatalog& catalog, const String& directory, const SortMode mode);
+
+/* Answers every query (one per line) from stream &queries using @engine built over @books */
+void answerQueries(std::ostream& out, std::istream& queries, const ResizableArray<Book>& books, QueryEngine& engine);
+
+/* Applies availability changes (one per line) from stream &changes through @log.
+   Returns false if they can't be written into the log */
+bool applyChanges(std::istream& changes, AvailabilityLog& log);
+
+/* Reads records appended to the followed inputs into @books and indexes them in @engine */
+int reloadCatalog(std::deque<CatalogTail>& tails, ResizableArray<Book>& books, QueryEngine& engine, LoadReport& report, bool& isRebuilt);
+
+/* Serves queries by coordinating the shard servers of @options */
+int runCoordinator(const Options& options);
+
+/* Outputs the most covered spheres of @sketch like outputSpheresList, with error bounds of the counts */
+void outputSketchSpheresList(std::ostream& out, const CatalogSketch& sketch);
+
+/* Outputs distinct counts and quantiles of available copies of @sketch with their error bounds */
+void outputSketchSummary(std::ostream& out, const CatalogSketch& sketch);
+
+/* Summarizes the inputs of @options in sketches and writes their reports */
+int runSketch(const Options& options);
+
+/* Runs the program interactively, asking for input on the console */
+int runInteractive();
+
+/* Runs the program without any console interaction, driven by command line arguments */
+int runBatch(int argc, char** argv);
+
 int main(int argc, char** argv) {
+	if (isBatchMode(argc, argv))
+		return runBatch(argc, argv);
+	return runInteractive();
+}
+
+/* Runs the program interactively: asks for the input file and delimiter on the console,
+   writes reports into the working directory and answers sphere queries from the console */
+int runInteractive() {
 
-	std::fstream fin;
+	CatalogInput fin;
 	char* fn = new char[255];
 	while (!fin.is_open())
 	{
@@ -67,104 +182,538 @@ int main(int argc, char** argv) {
 	}
 
 	ResizableArray<Book> books = ResizableArray<Book>();
-	while (!fin.eof() && fin.good()) {
+	LoadReport report;
+	loadBooks(fin, books, delim, ErrorPolicy::Ask, report);
+	if (fin.getError().getLength() != 0)
+		std::cerr << "Can't read the whole file: " << fin.getError() << std::endl;
 
-		if (delim != '\n') fin.ignore(INT_MAX, delim);
-		else while (!fin.eof() && !std::isalnum(fin.peek()))
-			fin.ignore();
+	writeReports(books, ".");
 
-		if (fin.eof()) break;
-
-		Book book = Book();
+	std::cin.ignore(INT_MAX, '\n');
+	QueryEngine engine;
+	engine.build(books);
+	// Plain sphere lookups repeat a lot, their rendered output is kept
+	QueryCache cache;
+	QueryScratch scratch;
+	RowSet result;
+	ResizableArray<int> rows;
+	String query, sphere;
+	std::string rendered;
+	do {
+		std::cout << "Enter sphere name or query (e.g. Programming AND YEAR 2000-2010) to output matching books into console (enter 0 to exit): ";
+		std::cin.clear();
+		getline(std::cin, query);
+		if (query == "0" || std::cin.eof())
+			break;
 		try {
-			fin >> book;
-			books.add(book);
+			bool isSphere = engine.isSphereQuery(query, sphere, scratch);
+			if (!isSphere || !cache.find(sphere, rendered)) {
+				engine.evaluate(query, result, scratch);
+				std::ostringstream out;
+				if (result.count() == 0)
+					out << "No books found" << std::endl;
+				rows.clear();
+				for (int row = result.next(0); row != -1; row = result.next(row + 1)) {
+					out << books[row];
+					rows.add(row);
+				}
+				rendered = out.str();
+				if (isSphere)
+					cache.insert(sphere, rows.data(), rows.getSize(), rendered);
+			}
+			std::cout << rendered;
 		}
-
 		catch (Exception& e) {
-			std::cerr << e.getMsg() << ": " << e.getInfo() << std::endl;
-			char yn;
-			do {
-				std::cout << "Continue reading file? (more exceptions may pop up if delimiter is not set) (y\n): ";
-				std::cin.clear();
-				std::cin >> yn;
-			} while (std::cin.fail() || yn != 'y' && yn != 'n');
-			if (yn == 'y') fin.clear();
+			std::cout << describeException(e) << std::endl;
 		}
+	} while (true);
+	std::cerr << "Query cache: " << cache.getStats() << std::endl;
+
+	return 0;
+}
 
+/* Runs the program without any console interaction, driven by command line arguments.
+   Returns process exit code */
+int runBatch(int argc, char** argv) {
+	Options options;
+	try {
+		parseOptions(argc, argv, options);
+	}
+	catch (Exception& e) {
+		std::cerr << describeException(e) << std::endl;
+		printUsage(std::cerr, argv[0]);
+		return 1;
+	}
+	ThreadPool::setSharedThreadCount(options.threads);
+	if (options.showHelp) {
+		printUsage(std::cout, argv[0]);
+		return 0;
 	}
+	if (options.benchmark.getLength() != 0) {
+		if (options.benchmark == "list" || !runBenchmark(options, std::cout)) {
+			listBenchmarks(options.benchmark == "list" ? std::cout : std::cerr);
+			return options.benchmark == "list" ? 0 : 1;
+		}
+		return 0;
+	}
+	if (options.loadPort >= 0)
+		return runLoadGenerator(options, std::cout) ? 0 : 1;
+	if (!options.shardPorts.isEmpty())
+		return runCoordinator(options);
+	if (options.sketch)
+		return runSketch(options);
 
-	std::ofstream fout("bestAvailability.txt");
-	if (!fout.is_open())
-		std::cerr << "Can't create output file bestAvailability.txt" << std::endl;
-	else {
+	ResizableArray<Book> books = ResizableArray<Book>();
+	LoadReport report;
+	// A followed catalog is read through tails, which remember where every input ended
+	bool isFollowing = options.servePort >= 0 && options.followInterval >= 0;
+	std::deque<CatalogTail> tails;
+	ResizableArray<int> rowIds;		// Rows of a shard in the whole catalog
+	int nextRow = 0;
+	for (int i = 0; i < options.inputs.getSize(); ++i) {
+		if (isFollowing) {
+			if (CatalogInput::detect(options.inputs[i].get()) != Compression::None) {
+				std::cerr << "Can't follow compressed file " << options.inputs[i] << std::endl;
+				return 1;
+			}
+			tails.emplace_back(options.inputs[i], options.delimiter, options.errorPolicy);
+			TailStatus status = tails.back().poll(books, report);
+			if (status == TailStatus::Unreadable) {
+				std::cerr << "Can't open file " << options.inputs[i] << std::endl;
+				return 1;
+			}
+			if (status == TailStatus::Aborted)
+				return 2;
+			continue;
+		}
+		// Compressed inputs are decompressed on the fly, without a copy on disk
+		CatalogInput fin(options.inputs[i].get());
+		if (!fin.is_open()) {
+			std::cerr << "Can't open file " << options.inputs[i] << std::endl;
+			return 1;
+		}
+		int before = books.getSize();
+		if (!loadBooks(fin, books, options.delimiter, options.errorPolicy, report, options.inputs[i].get()))
+			return 2;
+		// A shard drops the other Books of every input as soon as it is read
+		if (options.shard >= 0)
+			keepShard(books, before, options.shard, options.shardCount, rowIds, nextRow);
+		if (fin.getError().getLength() != 0) {
+			std::cerr << "Can't read file " << options.inputs[i] << ": " << fin.getError() << std::endl;
+			return 1;
+		}
+	}
+	std::cerr << "Loaded " << report.loaded << " books, skipped " << report.failed << " malformed" << std::endl;
+	if (options.shard >= 0)
+		std::cerr << "Kept " << books.getSize() << " books of shard " << options.shard << '/' << options.shardCount << std::endl;
+
+	if (options.errorPolicy == ErrorPolicy::Collect) {
+		String path = Util::joinPath(options.outputDirectory, "errors.txt");
+		std::ofstream fout(path.get());
+		if (!fout.is_open())
+			std::cerr << "Can't create output file " << path << std::endl;
+		for (int i = 0; i < report.errors.getSize(); ++i)
+			fout << report.errors[i] << '\n';
+	}
+
+	if (options.journalDirectory.getLength() != 0) {
+		AvailabilityLog log(books, options.journalDirectory, options.commitEvery, options.snapshotEvery);
+		int recovered = log.open();
+		if (recovered < 0) {
+			std::cerr << "Can't open availability log in " << options.journalDirectory << std::endl;
+			return 1;
+		}
+		std::cerr << "Recovered " << recovered << " availability changes" << std::endl;
+		if (options.changesFile.getLength() != 0) {
+			std::ifstream changes(options.changesFile.get());
+			if (!changes.is_open()) {
+				std::cerr << "Can't open file " << options.changesFile << std::endl;
+				return 1;
+			}
+			if (!applyChanges(changes, log))
+				return 1;
+		}
+	}
+
+	if (options.servePort >= 0) {
+		QueryEngine engine;
+		engine.build(books);
+		QueryServer server(books, engine);
+		if (options.shard >= 0)
+			server.setRowIds(rowIds);
+		if (isFollowing)
+			server.setReloader([&](bool& isRebuilt) {
+				return reloadCatalog(tails, books, engine, report, isRebuilt);
+			}, options.followInterval);
+		if (!server.listen(options.servePort)) {
+			std::cerr << "Can't listen on port " << options.servePort << std::endl;
+			return 1;
+		}
+		std::cerr << "Serving on port " << server.getPort() << std::endl;
+		server.run();
+		std::cerr << "Served " << server.getServed() << " requests" << std::endl;
+		std::cerr << "Query cache: " << server.getCacheStats() << std::endl;
+		return 0;
+	}
+
+	if (options.compact) {
+		CompactCatalog catalog;
+		catalog.build(books);
+		std::cerr << "Compact catalog: " << catalog.getStats(books) << std::endl;
+		books.clear();
+		books.shrink();
+		writeReports(catalog, options.outputDirectory, options.sortMode);
+		return 0;
+	}
+
+	writeReports(books, options.outputDirectory, options.sortMode);
+
+	if (options.queryFile.getLength() != 0) {
+		std::ifstream queries(options.queryFile.get());
+		if (!queries.is_open()) {
+			std::cerr << "Can't open file " << options.queryFile << std::endl;
+			return 1;
+		}
+		String path = Util::joinPath(options.outputDirectory, "queryResults.txt");
+		std::ofstream fout(path.get());
+		if (!fout.is_open()) {
+			std::cerr << "Can't create output file " << path << std::endl;
+			return 1;
+		}
+		QueryEngine engine;
+		engine.build(books);
+		answerQueries(fout, queries, books, engine);
+	}
+
+	return 0;
+}
+
+/* Writes bestAvailability.txt, booksTable.txt, spheresList.txt, authorsList.txt, yearsList.txt
+   and decadesList.txt into @directory. Sorts @books on the way as @mode tells using the shared ThreadPool. Reports are
+   rendered into memory concurrently and handed to a background ReportWriter as soon as each is ready */
+void writeReports(ResizableArray<Book>& books, const String& directory, const SortMode mode) {
+	ReportWriter writer;
+
+	// Best availability picks the first of equal books in load order, so it goes before sorting
+	std::ostringstream best;
+	try {
+		best << "Book with most available copies is:\n";
+		best << findBestAvailability(books);
+		best << '\n';
+	}
+	catch (Exception& e) {
+		best << describeException(e) << std::endl;
+	}
+	std::string contents = best.str();
+	writer.write(Util::joinPath(directory, "bestAvailability.txt"), contents);
+
+	sortBooks(books, mode);
+
+	TaskGroup reports;
+	reports.run([&books, &directory, &writer]() {
+		std::ostringstream out;
+		outputBooksTable(out, books);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "booksTable.txt"), contents);
+	});
+	reports.run([&books, &directory, &writer]() {
+		std::ostringstream out;
+		outputSpheresList(out, books);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "spheresList.txt"), contents);
+	});
+	reports.run([&books, &directory, &writer]() {
+		std::ostringstream out;
+		outputAuthorsList(out, books);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "authorsList.txt"), contents);
+	});
+	reports.run([&books, &directory, &writer]() {
+		std::ostringstream out;
+		outputYearsList(out, books);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "yearsList.txt"), contents);
+	});
+	reports.run([&books, &directory, &writer]() {
+		std::ostringstream out;
+		outputDecadesList(out, books);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "decadesList.txt"), contents);
+	});
+	reports.wait();
+	writer.finish();
+}
+
+/* Answers every query (one per line) from stream &queries using @engine built over @books,
+   outputs matching books of every query into the stream &out */
+void answerQueries(std::ostream& out, std::istream& queries, const ResizableArray<Book>& books, QueryEngine& engine) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int answered = 0;
+	String query;
+	RowSet result;
+	while (queries.peek() != EOF) {
+		try {
+			getline(queries, query);
+		}
+		catch (Exception&) {
+			break;
+		}
+		Util::trim(query);
+		if (query.getLength() == 0)
+			continue;
+
+		++answered;
 		try {
-			fout << "Book with most available copies is:\n";
-			fout << findBestAvailability(books);
-			fout << '\n';
+			engine.evaluate(query, result);
 		}
 		catch (Exception& e) {
-			fout << e.getMsg() << ": " << e.getInfo() << std::endl;
+			out << "Query: " << query << '\n' << describeException(e) << '\n';
+			continue;
 		}
+		int count = result.count();
+		out << "Query: " << query << " (" << count << " books)\n";
+		if (count == 0)
+			out << "No books found\n";
+		for (int row = result.next(0); row != -1; row = result.next(row + 1))
+			out << books[row];
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cerr << "Answered " << answered << " queries in " << elapsed.count() << " ms" << std::endl;
+}
 
-		fout.close();
+/* Applies availability changes (one per line) from stream &changes through @log.
+   A line is "+n", "-n" or "=n", then author, title, year and optionally the occurrence
+   of the book among books sharing them, separated by tabs. Stops and returns false if
+   they can't be written into the log */
+bool applyChanges(std::istream& changes, AvailabilityLog& log) {
+	int applied = 0, rejected = 0;
+	std::string line;
+	while (std::getline(changes, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+		std::string fields[5];
+		int count = 0;
+		for (size_t start = 0; count < 5; ++count) {
+			size_t end = line.find('\t', start);
+			fields[count] = line.substr(start, end - start);
+			if (end == std::string::npos) {
+				++count;
+				break;
+			}
+			start = end + 1;
+		}
+		char op = fields[0].empty() ? '\0' : fields[0][0];
+		int row = count < 4 ? -1 : log.findRow(fields[1].c_str(), fields[2].c_str(), atoi(fields[3].c_str()), count == 5 ? atoi(fields[4].c_str()) : 0);
+		unsigned int amount = (unsigned int)strtoul(fields[0].c_str() + 1, nullptr, 10);
+		bool isApplied = row != -1;
+		if (isApplied && op == '+')
+			log.increment(row, amount);
+		else if (isApplied && op == '-')
+			isApplied = log.decrement(row, amount);
+		else if (isApplied && op == '=')
+			log.set(row, amount);
+		else isApplied = false;
+		if (isApplied)
+			++applied;
+		else {
+			std::cerr << "Can't apply availability change: " << line << std::endl;
+			++rejected;
+		}
+		// Changes in memory mustn't run ahead of the log
+		if (log.hasFailed())
+			break;
 	}
+	bool isCommitted = log.commit();
+	std::cerr << "Applied " << applied << " availability changes, rejected " << rejected << std::endl;
+	if (!isCommitted)
+		std::cerr << "Stopped, availability changes can't be written into the log" << std::endl;
+	return isCommitted;
+}
 
-	fout.open("booksTable.txt");
-	if (!fout.is_open())
-		std::cerr << "Can't create output file booksTable.txt" << std::endl;
-	else {
-		sort(books);
-		outputBooksTable(fout, books);
-		fout.close();
+/* Reads records appended to the followed inputs into @books and indexes them in @engine.
+   If an input was rewritten the whole catalog is read again and @isRebuilt is set.
+   Returns the amount of added books (of all books when rebuilt) */
+int reloadCatalog(std::deque<CatalogTail>& tails, ResizableArray<Book>& books, QueryEngine& engine, LoadReport& report, bool& isRebuilt) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int before = books.getSize();
+	isRebuilt = false;
+	for (size_t i = 0; i < tails.size() && !isRebuilt; ++i) {
+		TailStatus status = tails[i].poll(books, report);
+		if (status == TailStatus::Rewritten)
+			isRebuilt = true;
+		else if (status == TailStatus::Unreadable)
+			std::cerr << "Can't open file " << tails[i].getPath() << std::endl;
+	}
+	if (isRebuilt) {
+		books.clear();
+		for (size_t i = 0; i < tails.size(); ++i) {
+			tails[i].reset();
+			tails[i].poll(books, report);
+		}
+		engine.build(books);
+	}
+	else if (books.getSize() > before)
+		engine.extend(books);
+	int added = isRebuilt ? books.getSize() : books.getSize() - before;
+	if (added > 0 || isRebuilt) {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cerr << (isRebuilt ? "Reloaded " : "Appended ") << added << " books in " << elapsed.count() << " ms" << std::endl;
 	}
+	return added;
+}
 
-	fout.open("spheresList.txt");
-	if (!fout.is_open())
-		std::cerr << "Can't create output file spheresList.txt" << std::endl;
-	else {
-		outputSpheresList(fout, books);
-		fout.close();
+/* Serves queries by coordinating the shard servers of @options, on the port of @options.
+   Returns process exit code */
+int runCoordinator(const Options& options) {
+	ShardCoordinator coordinator(options.shardPorts);
+	if (!coordinator.connect()) {
+		std::cerr << "Can't reach every shard server" << std::endl;
+		return 1;
 	}
+	// The server keeps no books, every request goes to the shards
+	ResizableArray<Book> books;
+	QueryEngine engine;
+	engine.build(books);
+	QueryServer server(books, engine);
+	server.setCoordinator(coordinator);
+	if (!server.listen(options.servePort)) {
+		std::cerr << "Can't listen on port " << options.servePort << std::endl;
+		return 1;
+	}
+	std::cerr << "Coordinating " << coordinator.getShardCount() << " shards on port " << server.getPort() << std::endl;
+	server.run();
+	std::cerr << "Served " << server.getServed() << " requests" << std::endl;
+	return 0;
+}
 
-	std::cin.ignore(INT_MAX, '\n');
-	String sphere;
-	int c = books.getSize();
-	bool isFound;
-	do {
-		std::cout << "Enter sphere name to output all books with such sphere into console (enter 0 to exit): ";
-		std::cin.clear();
-		getline(std::cin, sphere);
-		isFound = false;
-		for (int i = 0; i < c; ++i)
-			for (int g = 0; g < books[i].getSpheresCount(); ++g)
-				if (books[i].getSpheres()[g] == sphere) {
-					std::cout << books[i];
-					isFound = true;
-				}
-		if (!isFound)
-			std::cout << "No books found" << std::endl;
-	} while (std::cin.fail() || sphere != "0");
+/* Outputs the most covered spheres of @sketch like outputSpheresList, every
+   count with the most it may exceed the true one by (with probability 1 - e^-SKETCH_CM_DEPTH) */
+void outputSketchSpheresList(std::ostream& out, const CatalogSketch& sketch) {
+	const HeavyHitters& spheres = sketch.getTopSpheres();
+	if (spheres.getSize() == 0)
+		return;
+	// Kept in the order they were first seen, sorted the way outputSphereCounts sorts
+	LinkedList<Pair<String, int>> counts;
+	for (int i = 0; i < spheres.getSize(); ++i)
+		counts.add(Pair<String, int>(spheres.getKey(i), (int)spheres.getEstimate(i)));
+	sort(counts);
 
-	return 0;
+	long long error = (long long)spheres.getCounts().getErrorBound();
+	out << std::setw(BOOK_SPHERE_WIDTH) << "Covered spheres" << std::setw(BOOK_COUNT_WIDTH) << "Count"
+		<< std::setw(BOOK_COUNT_WIDTH) << "Error" << '\n';
+	for (LinkedList<Pair<String, int>>::LinkedListIterator itr = counts.begin(); itr != counts.end(); ++itr)
+		out << std::setw(Util::getColumnWidth((*itr).getFirst(), BOOK_SPHERE_WIDTH)) << (*itr).getFirst() << std::setw(BOOK_COUNT_WIDTH) << (*itr).getSecond()
+			<< std::setw(BOOK_COUNT_WIDTH) << error << '\n';
 }
 
-/* Overloaded comparison operator to properly sort spheres list */
-bool operator>(const Pair<String, int>& p1, const Pair<String, int>& p2) {
-	return p1.getFirst() > p2.getFirst();
+/* Outputs distinct counts and quantiles of available copies of @sketch with their error bounds */
+void outputSketchSummary(std::ostream& out, const CatalogSketch& sketch) {
+	double error = HyperLogLog::getStandardError() * 100;
+	const QuantileSketch& amounts = sketch.getAmounts();
+	out << std::fixed << std::setprecision(0)
+		<< "Books:             " << sketch.getBookCount() << '\n'
+		<< "Distinct authors:  " << sketch.getAuthorCount() << '\n'
+		<< "Distinct titles:   " << sketch.getTitleCount() << '\n'
+		<< "Distinct spheres:  " << sketch.getSphereCount() << '\n'
+		<< std::setprecision(2) << "                   (standard error " << error << "%)\n"
+		<< "Sphere counts:     " << sketch.getTopSpheres().getSize() << " most covered spheres kept, counts exceed\n"
+		<< "                   the true ones by at most " << (long long)sketch.getTopSpheres().getCounts().getErrorBound()
+		<< " (probability " << (1 - std::exp(-(double)SKETCH_CM_DEPTH)) * 100 << "%)\n"
+		<< "Available copies:  min " << amounts.getQuantile(0) << ", median " << amounts.getQuantile(0.5)
+		<< ", p90 " << amounts.getQuantile(0.9) << ", p99 " << amounts.getQuantile(0.99) << ", max " << amounts.getQuantile(1) << '\n'
+		<< "                   (relative error " << SKETCH_QUANTILE_ACCURACY * 100 << "%)\n"
+		<< "Sketch memory:     " << sizeof(CatalogSketch) << " bytes, whatever the amount of books\n";
+}
+
+/* Summarizes the inputs of @options in sketches, one per input read in parallel and merged
+   in order, and writes their reports. Returns process exit code */
+int runSketch(const Options& options) {
+	int inputs = options.inputs.getSize();
+	CatalogSketch** sketches = new CatalogSketch*[inputs];
+	LoadReport* reports = new LoadReport[inputs];
+	int* results = new int[inputs];
+	String* failures = new String[inputs];
+	TaskGroup group;
+	for (int i = 0; i < inputs; ++i) {
+		sketches[i] = new CatalogSketch();
+		group.run([&options, sketches, reports, results, failures, i]() {
+			CatalogInput fin(options.inputs[i].get());
+			if (!fin.is_open())
+				results[i] = 1;
+			else if (!sketchBooks(fin, *sketches[i], options.delimiter, options.errorPolicy, reports[i], options.inputs[i].get()))
+				results[i] = 2;
+			else {
+				failures[i] = fin.getError();
+				results[i] = failures[i].getLength() != 0 ? 3 : 0;
+			}
+		});
+	}
+	group.wait();
+
+	int code = 0;
+	LoadReport report;
+	for (int i = 0; i < inputs && code == 0; ++i) {
+		if (results[i] == 1)
+			std::cerr << "Can't open file " << options.inputs[i] << std::endl;
+		else if (results[i] == 3)
+			std::cerr << "Can't read file " << options.inputs[i] << ": " << failures[i] << std::endl;
+		code = results[i] == 3 ? 1 : results[i];
+		report.loaded += reports[i].loaded;
+		report.failed += reports[i].failed;
+		for (int e = 0; e < reports[i].errors.getSize(); ++e)
+			report.errors.add(reports[i].errors[e]);
+		if (i > 0)
+			sketches[0]->merge(*sketches[i]);
+	}
+	if (code == 0) {
+		std::cerr << "Sketched " << report.loaded << " books, skipped " << report.failed << " malformed" << std::endl;
+		if (options.errorPolicy == ErrorPolicy::Collect) {
+			String path = Util::joinPath(options.outputDirectory, "errors.txt");
+			std::ofstream fout(path.get());
+			if (!fout.is_open())
+				std::cerr << "Can't create output file " << path << std::endl;
+			for (int i = 0; i < report.errors.getSize(); ++i)
+				fout << report.errors[i] << '\n';
+		}
+		ReportWriter writer;
+		std::ostringstream spheres, summary;
+		outputSketchSpheresList(spheres, *sketches[0]);
+		outputSketchSummary(summary, *sketches[0]);
+		std::string contents = spheres.str();
+		writer.write(Util::joinPath(options.outputDirectory, "sketchSpheresList.txt"), contents);
+		contents = summary.str();
+		writer.write(Util::joinPath(options.outputDirectory, "sketchSummary.txt"), contents);
+	}
+	for (int i = 0; i < inputs; ++i)
+		delete sketches[i];
+	delete[] sketches;
+	delete[] reports;
+	delete[] results;
+	delete[] failures;
+	return code;
 }
 
 /* Returns reference to the book with most available copies in a resizable array
+   (the first one if there are several). Chunks are searched in parallel on the shared ThreadPool.
    Throws Invalid Argument exception if recieved array is empty */
 Book& findBestAvailability(ResizableArray<Book>& books) {
 	if (books.isEmpty())
 		throw Exception("Invalid argument exception!", 139, "main.cpp", "Books array must not be empty");
-	Book* bestAvailable = &books[0];
-	for (int i = 1; i < books.getSize(); ++i) {
-		if (books[i] > *bestAvailable)
-			bestAvailable = &books[i];
-	}
-	return *bestAvailable;
+	const Book* rows = books.data();
+	int best = parallelReduce(ThreadPool::shared(), 0, books.getSize(), 4096, 0,
+		[rows](int from, int to) {
+			int bestAvailable = from;
+			for (int i = from + 1; i < to; ++i)
+				if (rows[i] > rows[bestAvailable])
+					bestAvailable = i;
+			return bestAvailable;
+		},
+		[rows](int left, int right) {
+			return rows[right] > rows[left] ? right : left;
+		});
+	return books[best];
 }
 
 /* Returns reference to the book with most available copies in an array
@@ -182,12 +731,26 @@ Book& findBestAvailability(Book* books, int n) {
 /* Sorts a resizable array sent by a reference in non-descending order*/
 template<class T>
 void sort(ResizableArray<T>& arr) {
-	for (int i = 1; i < arr.getSize(); i++) {
-		T key = arr[i];
-		int j = i - 1;
-		for (; j >= 0 && arr[j] > key; j--)
-			arr[j + 1] = arr[j];
-		arr[j + 1] = key;
+	sort(arr.data(), arr.getSize());
+}
+
+/* Sorts books by available copies for the reports the way @mode tells. Radix sorts extract
+   the integer keys and move every Book once, after the keys are sorted */
+void sortBooks(ResizableArray<Book>& books, const SortMode mode) {
+	switch (mode) {
+	case SortMode::Count:
+		radixSort(books, [](const Book& book) {
+			return (unsigned long long)(unsigned int)book.getCurrentAmount();
+		});
+		break;
+	case SortMode::CountYear:
+		radixSort(books, [](const Book& book) {
+			return (unsigned long long)(unsigned int)book.getCurrentAmount() << 16 | (date_y)book.getPublicationYear();
+		});
+		break;
+	case SortMode::Merge:
+		parallelSort(books);
+		break;
 	}
 }
 
@@ -222,8 +785,8 @@ void sort(T* arr, int n) {
 	}
 }
 
-/* Outputs a table to the stream &out from the books in vector &books. Only first sphere(discipline) is being output */
-void outputBooksTable(std::ostream& out, ResizableArray<Book>& books) {
+/* Outputs the header of the books table to the stream &out */
+void outputBooksTableHeader(std::ostream& out) {
 	out <<
 		std::setw(BOOK_AUTHOR_WIDTH) << "Author" <<
 		std::setw(BOOK_TITLE_WIDTH) << "Title" <<
@@ -231,38 +794,315 @@ void outputBooksTable(std::ostream& out, ResizableArray<Book>& books) {
 		std::setw(BOOK_SPHERE_WIDTH) << "Sphere" <<
 		std::setw(BOOK_COUNT_WIDTH) << "Count" <<
 		std::endl;
-	for (int i = 0; i < books.getSize(); ++i)
-		out << books[i];
 }
 
-/* Outputs the list of unique spheres to the stream &out from ResizableArray of Book @books */
+/* Outputs a table to the stream &out from the books in vector &books. Only first sphere(discipline) is being output.
+   Rows are rendered in parallel chunks on the shared ThreadPool and output in order */
+void outputBooksTable(std::ostream& out, ResizableArray<Book>& books) {
+	outputBooksTableHeader(out);
+
+	const int chunkSize = 4096;
+	int chunks = (books.getSize() + chunkSize - 1) / chunkSize;
+	std::string* rendered = new std::string[chunks];
+	const Book* rows = books.data();
+	const int count = books.getSize();
+	parallelFor(ThreadPool::shared(), 0, chunks, 1, [rows, count, rendered, chunkSize](int from, int to) {
+		for (int c = from; c < to; ++c) {
+			std::ostringstream chunk;
+			int end = (c + 1) * chunkSize < count ? (c + 1) * chunkSize : count;
+			for (const Book* book = rows + c * chunkSize; book != rows + end; ++book)
+				chunk << *book;
+			rendered[c] = chunk.str();
+		}
+	});
+	for (int c = 0; c < chunks; ++c)
+		out.write(rendered[c].data(), rendered[c].size());
+	delete[] rendered;
+}
+
+/* Outputs the list of unique spheres to the stream &out from ResizableArray of Book @books.
+   Spheres are counted in parallel on the shared ThreadPool */
 void outputSpheresList(std::ostream& out, ResizableArray<Book>& books) {
 	if (books.getSize() == 0)
 		return;
 
-	int c = books.getSize();
-	LinkedList<String> spheres = LinkedList<String>();
-	LinkedList<int> values = LinkedList<int>();
-	for (int i = 0; i < c; ++i) {
-		const String* currentSpheres = books[i].getSpheres();
-		int sc = books[i].getSpheresCount();
-		for (int g = 0; g < sc; ++g) {
-			int ind = spheres.findIndex(currentSpheres[g]);
-			if (ind == spheres.getSize()) {
-				spheres.add(currentSpheres[g]);
-				values.add(1);
-			}
-			else values[ind]++;
-		}
-	}
+	ResizableArray<Pair<String, int>> spheres;
+	countSpheres(books, spheres);
+	outputSphereCounts(out, spheres);
+}
 
+/* Outputs spheres counted in @spheres (in the order they were first seen) to the stream &out */
+void outputSphereCounts(std::ostream& out, const ResizableArray<Pair<String, int>>& spheres) {
+	// Distinct spheres are few, the list keeps the order it always had
 	LinkedList<Pair<String, int>> sortedSpheres;
-	for (int i = 0; i < spheres.getSize(); ++i)
-		sortedSpheres.add(makePair(spheres[i], values[i]));
+	for (const Pair<String, int>& sphere : spheres)
+		sortedSpheres.add(sphere);
 
 	sort(sortedSpheres);
 
 	out << std::setw(BOOK_SPHERE_WIDTH) << "Covered spheres" << std::setw(BOOK_COUNT_WIDTH) << "Count" << '\n';
 	for (LinkedList<Pair<String, int>>::LinkedListIterator itr = sortedSpheres.begin(); itr != sortedSpheres.end(); ++itr)
-		out << std::setw(BOOK_SPHERE_WIDTH) << (*itr).getFirst() << std::setw(BOOK_COUNT_WIDTH) << (*itr).getSecond() << '\n';
+		out << std::setw(Util::getColumnWidth((*itr).getFirst(), BOOK_SPHERE_WIDTH)) << (*itr).getFirst() << std::setw(BOOK_COUNT_WIDTH) << (*itr).getSecond() << '\n';
+}
+
+/* Outputs the amount of books of every author to the stream &out, sorted by author */
+void outputAuthorsList(std::ostream& out, ResizableArray<Book>& books) {
+	if (books.getSize() == 0)
+		return;
+
+	ResizableArray<Pair<String, int>> authors;
+	countAuthors(books, authors);
+	outputAuthorCounts(out, authors);
+}
+
+/* Sorts authors counted in @authors and outputs them to the stream &out */
+void outputAuthorCounts(std::ostream& out, ResizableArray<Pair<String, int>>& authors) {
+	parallelSort(authors);
+
+	out << std::setw(BOOK_AUTHOR_WIDTH) << "Author" << std::setw(BOOK_COUNT_WIDTH) << "Count" << '\n';
+	for (const Pair<String, int>& author : authors)
+		out << std::setw(Util::getColumnWidth(author.getFirst(), BOOK_AUTHOR_WIDTH)) << author.getFirst() << std::setw(BOOK_COUNT_WIDTH) << author.getSecond() << '\n';
+}
+
+/* Outputs the amount of books published in every year to the stream &out, sorted by year */
+void outputYearsList(std::ostream& out, ResizableArray<Book>& books) {
+	if (books.getSize() == 0)
+		return;
+
+	ResizableArray<Pair<int, int>> years;
+	countYears(books, years);
+	outputYearCounts(out, years);
+}
+
+/* Sorts years counted in @years and outputs them to the stream &out */
+void outputYearCounts(std::ostream& out, ResizableArray<Pair<int, int>>& years) {
+	parallelSort(years);
+
+	out << std::setw(BOOK_YEAR_WIDTH) << "Year" << std::setw(BOOK_COUNT_WIDTH) << "Count" << '\n';
+	for (const Pair<int, int>& year : years)
+		out << std::setw(BOOK_YEAR_WIDTH) << year.getFirst() << std::setw(BOOK_COUNT_WIDTH) << year.getSecond() << '\n';
+}
+
+/* Outputs the amount of books and available copies of every decade to the stream &out,
+   decades without books are left out. Sums come from a Year Index built in one pass */
+void outputDecadesList(std::ostream& out, ResizableArray<Book>& books) {
+	if (books.getSize() == 0)
+		return;
+
+	YearIndex years;
+	years.build(books);
+
+	out << std::setw(BOOK_YEAR_WIDTH) << "Decade" << std::setw(BOOK_COUNT_WIDTH) << "Books" << std::setw(BOOK_COUNT_WIDTH + 3) << "Copies" << '\n';
+	for (int decade = 0; decade <= years.getLastYear(); decade += 10) {
+		int count = years.getRowCount(decade, decade + 9);
+		if (count != 0)
+			out << std::setw(BOOK_YEAR_WIDTH) << decade << std::setw(BOOK_COUNT_WIDTH) << count << std::setw(BOOK_COUNT_WIDTH + 3) << years.getCopies(decade, decade + 9) << '\n';
+	}
+}
+
+/* Returns row of the book with most available copies in compact catalog @catalog
+   (the first one if there are several). Throws Invalid Argument exception if it is empty */
+int findBestAvailability(const CompactCatalog& catalog) {
+	if (catalog.getSize() == 0)
+		throw Exception("Invalid argument exception!", 139, "main.cpp", "Books array must not be empty");
+	int best = 0;
+	for (int row = 1; row < catalog.getSize(); ++row)
+		if (catalog.getCurrentAmount(row) > catalog.getCurrentAmount(best))
+			best = row;
+	return best;
+}
+
+/* Outputs a table of the rows of compact catalog @catalog in @order to the stream &out.
+   Chunks of rows are decoded and rendered in parallel on the shared ThreadPool */
+void outputBooksTable(std::ostream& out, const CompactCatalog& catalog, const int* order) {
+	outputBooksTableHeader(out);
+
+	const int chunkSize = 4096;
+	const int count = catalog.getSize();
+	int chunks = (count + chunkSize - 1) / chunkSize;
+	std::string* rendered = new std::string[chunks];
+	parallelFor(ThreadPool::shared(), 0, chunks, 1, [&catalog, order, count, rendered, chunkSize](int from, int to) {
+		Book book;
+		for (int c = from; c < to; ++c) {
+			std::ostringstream chunk;
+			int end = (c + 1) * chunkSize < count ? (c + 1) * chunkSize : count;
+			for (int i = c * chunkSize; i < end; ++i) {
+				catalog.decode(order[i], book);
+				chunk << book;
+			}
+			rendered[c] = chunk.str();
+		}
+	});
+	for (int c = 0; c < chunks; ++c)
+		out.write(rendered[c].data(), rendered[c].size());
+	delete[] rendered;
+}
+
+/* Outputs the list of unique spheres of compact catalog @catalog to the stream &out.
+   Spheres are counted in the order the rows are sorted in, @order, as the Book version
+   counts the sorted Books, so spheres sorting together keep their order */
+void outputSpheresList(std::ostream& out, const CompactCatalog& catalog, const int* order) {
+	if (catalog.getSize() == 0)
+		return;
+
+	ResizableArray<int> slots(catalog.getSphereNameCount());
+	for (int id = 0; id < catalog.getSphereNameCount(); ++id)
+		slots.add(-1);
+	ResizableArray<Pair<String, int>> spheres;
+	for (int i = 0; i < catalog.getSize(); ++i) {
+		const int* ids = catalog.getSphereIds(order[i]);
+		int sphereCount = catalog.getSpheresCount(order[i]);
+		for (int s = 0; s < sphereCount; ++s) {
+			int& slot = slots[ids[s]];
+			if (slot == -1) {
+				slot = spheres.getSize();
+				spheres.add(Pair<String, int>(catalog.getSphereName(ids[s]), 0));
+			}
+			spheres[slot].setSecond(spheres[slot].getSecond() + 1);
+		}
+	}
+	outputSphereCounts(out, spheres);
+}
+
+/* Outputs the amount of books of every author of compact catalog @catalog to the stream &out,
+   sorted by author. Authors are counted in the order the rows are sorted in, @order, like
+   spheres are */
+void outputAuthorsList(std::ostream& out, const CompactCatalog& catalog, const int* order) {
+	if (catalog.getSize() == 0)
+		return;
+
+	ResizableArray<int> slots(catalog.getAuthorCount());
+	for (int id = 0; id < catalog.getAuthorCount(); ++id)
+		slots.add(-1);
+	ResizableArray<int> ids;
+	ResizableArray<int> counts;
+	for (int i = 0; i < catalog.getSize(); ++i) {
+		int id = catalog.getAuthorId(order[i]);
+		if (slots[id] == -1) {
+			slots[id] = ids.getSize();
+			ids.add(id);
+			counts.add(0);
+		}
+		++counts[slots[id]];
+	}
+	ResizableArray<Pair<String, int>> authors(ids.getSize());
+	String author;
+	for (int i = 0; i < ids.getSize(); ++i) {
+		catalog.getAuthor(ids[i], author);
+		authors.add(Pair<String, int>(author, counts[i]));
+	}
+	outputAuthorCounts(out, authors);
+}
+
+/* Outputs the amount of books of every year of compact catalog @catalog to the stream &out,
+   sorted by year */
+void outputYearsList(std::ostream& out, const CompactCatalog& catalog) {
+	if (catalog.getSize() == 0)
+		return;
+
+	ResizableArray<int> counts(BOOK_MAX_YEAR + 1);
+	for (int year = 0; year <= BOOK_MAX_YEAR; ++year)
+		counts.add(0);
+	for (int row = 0; row < catalog.getSize(); ++row)
+		++counts[catalog.getPublicationYear(row)];
+	ResizableArray<Pair<int, int>> years;
+	for (int year = 0; year <= BOOK_MAX_YEAR; ++year)
+		if (counts[year] != 0)
+			years.add(Pair<int, int>(year, counts[year]));
+	outputYearCounts(out, years);
+}
+
+/* Outputs books and available copies of every decade of compact catalog @catalog to the stream &out,
+   decades without books are left out */
+void outputDecadesList(std::ostream& out, const CompactCatalog& catalog) {
+	if (catalog.getSize() == 0)
+		return;
+
+	const int decades = BOOK_MAX_YEAR / 10 + 1;
+	ResizableArray<int> counts(decades);
+	ResizableArray<long long> copies(decades);
+	for (int decade = 0; decade < decades; ++decade) {
+		counts.add(0);
+		copies.add(0);
+	}
+	for (int row = 0; row < catalog.getSize(); ++row) {
+		int decade = catalog.getPublicationYear(row) / 10;
+		++counts[decade];
+		copies[decade] += catalog.getCurrentAmount(row);
+	}
+
+	out << std::setw(BOOK_YEAR_WIDTH) << "Decade" << std::setw(BOOK_COUNT_WIDTH) << "Books" << std::setw(BOOK_COUNT_WIDTH + 3) << "Copies" << '\n';
+	for (int decade = 0; decade < decades; ++decade)
+		if (counts[decade] != 0)
+			out << std::setw(BOOK_YEAR_WIDTH) << decade * 10 << std::setw(BOOK_COUNT_WIDTH) << counts[decade] << std::setw(BOOK_COUNT_WIDTH + 3) << copies[decade] << '\n';
+}
+
+/* Writes the reports writeReports writes from compact catalog @catalog into @directory.
+   Rows are never moved: the books table follows an order of row ids radix sorted on the
+   columns (merge sort of Books keeps equal ones in load order, so it gives the same order) */
+void writeReports(const CompactCatalog& catalog, const String& directory, const SortMode mode) {
+	ReportWriter writer;
+
+	std::ostringstream best;
+	try {
+		Book book;
+		catalog.decode(findBestAvailability(catalog), book);
+		best << "Book with most available copies is:\n";
+		best << book;
+		best << '\n';
+	}
+	catch (Exception& e) {
+		best << describeException(e) << std::endl;
+	}
+	std::string contents = best.str();
+	writer.write(Util::joinPath(directory, "bestAvailability.txt"), contents);
+
+	int count = catalog.getSize();
+	int* rows = new int[count > 0 ? count : 1];
+	int* order = new int[count > 0 ? count : 1];
+	for (int row = 0; row < count; ++row)
+		rows[row] = row;
+	if (mode == SortMode::CountYear)
+		radixOrder(rows, count, [&catalog](const int row) {
+			return (unsigned long long)(unsigned int)catalog.getCurrentAmount(row) << 16 | (date_y)catalog.getPublicationYear(row);
+		}, order, ThreadPool::shared());
+	else radixOrder(rows, count, [&catalog](const int row) {
+			return (unsigned long long)(unsigned int)catalog.getCurrentAmount(row);
+		}, order, ThreadPool::shared());
+	delete[] rows;
+
+	TaskGroup reports;
+	reports.run([&catalog, order, &directory, &writer]() {
+		std::ostringstream out;
+		outputBooksTable(out, catalog, order);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "booksTable.txt"), contents);
+	});
+	reports.run([&catalog, order, &directory, &writer]() {
+		std::ostringstream out;
+		outputSpheresList(out, catalog, order);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "spheresList.txt"), contents);
+	});
+	reports.run([&catalog, order, &directory, &writer]() {
+		std::ostringstream out;
+		outputAuthorsList(out, catalog, order);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "authorsList.txt"), contents);
+	});
+	reports.run([&catalog, &directory, &writer]() {
+		std::ostringstream out;
+		outputYearsList(out, catalog);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "yearsList.txt"), contents);
+	});
+	reports.run([&catalog, &directory, &writer]() {
+		std::ostringstream out;
+		outputDecadesList(out, catalog);
+		std::string contents = out.str();
+		writer.write(Util::joinPath(directory, "decadesList.txt"), contents);
+	});
+	reports.wait();
+	writer.finish();
+	delete[] order;
 }
\ No newline at end of file